@@ -0,0 +1,517 @@
+// AtlasBaker: a command-line tool that rasterizes a font ahead of time and writes the finished 
+// atlases out as files (or as a C++ header) that a program can draw without FreeType (see 
+// FREETYPE_ATLAS_BAKED_ONLY in FreeTypeEncapsulate.h).
+//
+// usage: AtlasBaker <font file> <pixel sizes> <code points> <output name> [options]
+//  - pixel sizes: comma separated (ex: 16,24,48)
+//  - code points: comma separated code points or inclusive ranges, decimal or hex 
+//  (ex: 32-127,0x400-0x4FF)
+//  - output name: path and file name prefix; each size goes to "<output name>_<size>.ftatlas"
+// options:
+//  -header             write "<output name>.h" with every size in it instead of binary files
+//  -packing <method>   shelf, skyline (default), or maxrects
+//  -maxsize <pixels>   largest atlas width/height (default 16384)
+//  -sdf <spread>       bake signed distance fields that reach <spread> pixels from the edge
+//  -supersample <n>    rasterize distance field glyphs n times bigger first (default 4)
+//  -padding <pixels>   empty pixels between glyphs (default 1); 2 or more adds mipmaps
+//
+// Build note: This is its own project (atlas_baker.vcxproj) because it has its own main(...).
+// It only needs FreeType, not OpenGL or freeglut.
+
+#include "GlyphRasterizer.h"
+#include "AtlasBuilder.h"
+#include "AtlasFile.h"
+#include "Bc4Encoder.h"
+#include "MappedFile.h"
+
+#include <stdio.h>
+#include <stdlib.h>     // for strtoul(...)
+#include <string.h>     // for strcmp(...)
+
+#include <algorithm>    // for std::sort, std::unique
+#include <string>
+#include <vector>
+
+// apparently the FreeType lib also needs a companion file, "freetype261d.pdb"
+#pragma comment (lib, "freetype-2.6.1/objs/vc2010/Win32/freetype261d.lib")
+
+// OpenGL 4.1 and later must support textures at least this big, and the renderer asks for 4.4
+static const unsigned int DefaultMaxTextureSize = 16384;
+
+static void PrintUsage()
+{
+    fprintf(stderr, 
+        "usage: AtlasBaker <font file> <pixel sizes> <code points> <output name> [options]\n"
+        "  pixel sizes: comma separated (ex: 16,24,48)\n"
+        "  code points: comma separated code points or ranges (ex: 32-127,0x400-0x4FF)\n"
+        "  output name: each size is written to \"<output name>_<size>.ftatlas\"\n"
+        "options:\n"
+        "  -header             write \"<output name>.h\" instead of binary files\n"
+        "  -packing <method>   shelf, skyline (default), or maxrects\n"
+        "  -maxsize <pixels>   largest atlas width/height (default %u)\n"
+        "  -sdf <spread>       bake signed distance fields that reach <spread> pixels\n"
+        "  -supersample <n>    rasterize distance field glyphs n times bigger (default 4)\n"
+        "  -padding <pixels>   empty pixels between glyphs (default 1); 2 or more adds\n"
+        "                      mipmaps for drawing text small\n",
+        DefaultMaxTextureSize);
+}
+
+// splits "a,b,c" into "a", "b", and "c"
+static std::vector<std::string> SplitList(const std::string &list)
+{
+    std::vector<std::string> items;
+    size_t start = 0;
+    while (start <= list.length())
+    {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos)
+        {
+            end = list.length();
+        }
+        if (end > start)
+        {
+            items.push_back(list.substr(start, end - start));
+        }
+        start = end + 1;
+    }
+    return items;
+}
+
+// takes: a number in decimal or, with a "0x" in front, hex
+// returns: true if the whole string was a number, otherwise false
+static bool ParseNumber(const std::string &str, unsigned int &number)
+{
+    if (str.empty())
+    {
+        return false;
+    }
+
+    char *end = 0;
+    unsigned long parsed = strtoul(str.c_str(), &end, 0);
+    if (*end != 0)
+    {
+        return false;
+    }
+
+    number = (unsigned int)parsed;
+    return true;
+}
+
+static bool ParseCodePoints(const std::string &list, std::vector<unsigned int> &codePoints)
+{
+    std::vector<std::string> items = SplitList(list);
+    for (size_t itemIndex = 0; itemIndex < items.size(); itemIndex++)
+    {
+        const std::string &item = items[itemIndex];
+
+        // Note: Start looking for the dash after the first character so that a range like 
+        // "0x20-0x7F" isn't confused by anything in front of it.
+        size_t dash = item.find('-', 1);
+        unsigned int first = 0;
+        unsigned int last = 0;
+        if (dash == std::string::npos)
+        {
+            if (!ParseNumber(item, first))
+            {
+                return false;
+            }
+            last = first;
+        }
+        else if (!ParseNumber(item.substr(0, dash), first) || 
+            !ParseNumber(item.substr(dash + 1), last) || last < first)
+        {
+            return false;
+        }
+
+        std::vector<unsigned int> range = CodePointRange(first, last);
+        codePoints.insert(codePoints.end(), range.begin(), range.end());
+    }
+
+    // the same order and the same set as the renderer would ask for, so that the key matches
+    std::sort(codePoints.begin(), codePoints.end());
+    codePoints.erase(std::unique(codePoints.begin(), codePoints.end()), codePoints.end());
+    return !codePoints.empty();
+}
+
+// C++ doesn't allow "13f", so make sure that every float has a decimal point
+static std::string FloatLiteral(const float value)
+{
+    char text[32];
+    snprintf(text, sizeof(text), "%.9g", value);
+    std::string literal = text;
+    if (literal.find_first_of(".en") == std::string::npos)
+    {
+        literal += ".0";
+    }
+    return literal + "f";
+}
+
+// turns the output name's file name into something that can be a C++ identifier
+static std::string IdentifierFromPath(const std::string &path)
+{
+    size_t nameStart = path.find_last_of("/\\");
+    std::string name = (nameStart == std::string::npos) ? path : path.substr(nameStart + 1);
+
+    std::string identifier;
+    for (size_t charIndex = 0; charIndex < name.length(); charIndex++)
+    {
+        char c = name[charIndex];
+        bool isLetter = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+        bool isDigit = (c >= '0' && c <= '9');
+        identifier += (isLetter || isDigit) ? c : '_';
+    }
+    if (identifier.empty() || (identifier[0] >= '0' && identifier[0] <= '9'))
+    {
+        identifier = "_" + identifier;
+    }
+    return identifier;
+}
+
+static const char *PackingMethodName(const PackingMethod method)
+{
+    switch (method)
+    {
+    case PackingMethod::Shelf:
+        return "Shelf";
+    case PackingMethod::MaxRects:
+        return "MaxRects";
+    default:
+        return "Skyline";
+    }
+}
+
+// writes one size's glyphs and pixels as constexpr arrays plus a function that points an 
+// AtlasImageView at them
+// Note: Everything is constexpr, so the arrays live in the program's read-only data and the 
+// view points straight at them; nothing is copied or parsed at startup.
+static void WriteHeaderAtlas(FILE *headerFile, const AtlasImage &atlas, const int fontSize)
+{
+    fprintf(headerFile, "\n// %d pixels: %u x %u, %u glyphs\n", fontSize, atlas.width, 
+        atlas.height, (unsigned int)atlas.glyphs.size());
+
+    // Note: A zero-length array isn't allowed, so an atlas without any glyphs still gets one 
+    // (unused) entry.
+    fprintf(headerFile, "constexpr AtlasGlyph Size%dGlyphs[] =\n{\n", fontSize);
+    for (size_t glyphIndex = 0; glyphIndex < atlas.glyphs.size(); glyphIndex++)
+    {
+        const AtlasGlyph &glyph = atlas.glyphs[glyphIndex];
+        fprintf(headerFile, "    { %uu, %s, %s, %s, %s, %uu, %uu, %uu, %uu },\n", 
+            glyph.codePoint, FloatLiteral(glyph.ax).c_str(), FloatLiteral(glyph.ay).c_str(), 
+            FloatLiteral(glyph.bl).c_str(), FloatLiteral(glyph.bt).c_str(), glyph.width, 
+            glyph.rows, glyph.x, glyph.y);
+    }
+    if (atlas.glyphs.empty())
+    {
+        fprintf(headerFile, "    { 0u, 0.0f, 0.0f, 0.0f, 0.0f, 0u, 0u, 0u, 0u },\n");
+    }
+    fprintf(headerFile, "};\n\n");
+
+    const size_t bytesPerLine = 32;
+    fprintf(headerFile, "constexpr unsigned char Size%dPixels[] =\n{", fontSize);
+    for (size_t pixelIndex = 0; pixelIndex < atlas.pixels.size(); pixelIndex++)
+    {
+        if (pixelIndex % bytesPerLine == 0)
+        {
+            fprintf(headerFile, "\n    ");
+        }
+        fprintf(headerFile, "%u,", atlas.pixels[pixelIndex]);
+    }
+    if (atlas.pixels.empty())
+    {
+        fprintf(headerFile, "\n    0,");
+    }
+    fprintf(headerFile, "\n};\n\n");
+
+    // Note: Same as the glyphs, a font without kerning still gets one (unused) entry.
+    fprintf(headerFile, "constexpr AtlasKerningPair Size%dKerning[] =\n{\n", fontSize);
+    for (size_t pairIndex = 0; pairIndex < atlas.kerningPairs.size(); pairIndex++)
+    {
+        const AtlasKerningPair &pair = atlas.kerningPairs[pairIndex];
+        fprintf(headerFile, "    { %uu, %uu, %s },\n", pair.left, pair.right,
+            FloatLiteral(pair.x).c_str());
+    }
+    if (atlas.kerningPairs.empty())
+    {
+        fprintf(headerFile, "    { 0u, 0u, 0.0f },\n");
+    }
+    fprintf(headerFile, "};\n\n");
+
+    const PackReport &report = atlas.packReport;
+    fprintf(headerFile, 
+        "inline AtlasImageView Size%d()\n"
+        "{\n"
+        "    AtlasImageView view = { %uu, %uu, Size%dGlyphs, %uu, Size%dPixels,\n"
+        "        { PackingMethod::%s, %uu, %uu, %lluu, %s, %lluu, %lluu, %lluu },\n"
+        "        %uu, %uu, %uu, Size%dKerning, %uu };\n"
+        "    return view;\n"
+        "}\n",
+        fontSize, atlas.width, atlas.height, fontSize, (unsigned int)atlas.glyphs.size(), 
+        fontSize, PackingMethodName(report.method), report.atlasWidth, report.atlasHeight, 
+        (unsigned long long)report.usedPixels, FloatLiteral(report.occupancy).c_str(), 
+        (unsigned long long)report.wastedBytes, (unsigned long long)report.sharedGlyphs, 
+        (unsigned long long)report.sharedBytes, atlas.cellWidth, atlas.cellHeight, 
+        atlas.mipLevels, fontSize, (unsigned int)atlas.kerningPairs.size());
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 5)
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    std::string fontFilePath = argv[1];
+    std::string outputName = argv[4];
+    bool writeHeader = false;
+    PackingMethod packingMethod = PackingMethod::Skyline;
+    unsigned int maxTextureSize = DefaultMaxTextureSize;
+    DistanceFieldSettings distanceField;
+    distanceField.spread = 0;
+    distanceField.supersample = 4;
+    unsigned int padding = 1;
+    for (int argIndex = 5; argIndex < argc; argIndex++)
+    {
+        std::string option = argv[argIndex];
+        if (option == "-header")
+        {
+            writeHeader = true;
+        }
+        else if (option == "-packing" && argIndex + 1 < argc)
+        {
+            std::string method = argv[++argIndex];
+            if (method == "shelf")
+            {
+                packingMethod = PackingMethod::Shelf;
+            }
+            else if (method == "skyline")
+            {
+                packingMethod = PackingMethod::Skyline;
+            }
+            else if (method == "maxrects")
+            {
+                packingMethod = PackingMethod::MaxRects;
+            }
+            else
+            {
+                fprintf(stderr, "Unknown packing method '%s'\n", method.c_str());
+                return 1;
+            }
+        }
+        else if (option == "-maxsize" && argIndex + 1 < argc)
+        {
+            if (!ParseNumber(argv[++argIndex], maxTextureSize) || maxTextureSize == 0)
+            {
+                fprintf(stderr, "Bad max size '%s'\n", argv[argIndex]);
+                return 1;
+            }
+        }
+        else if (option == "-sdf" && argIndex + 1 < argc)
+        {
+            if (!ParseNumber(argv[++argIndex], distanceField.spread) || 
+                distanceField.spread == 0)
+            {
+                fprintf(stderr, "Bad distance field spread '%s'\n", argv[argIndex]);
+                return 1;
+            }
+        }
+        else if (option == "-supersample" && argIndex + 1 < argc)
+        {
+            if (!ParseNumber(argv[++argIndex], distanceField.supersample) || 
+                distanceField.supersample == 0)
+            {
+                fprintf(stderr, "Bad supersample factor '%s'\n", argv[argIndex]);
+                return 1;
+            }
+        }
+        else if (option == "-padding" && argIndex + 1 < argc)
+        {
+            if (!ParseNumber(argv[++argIndex], padding) || padding == 0)
+            {
+                fprintf(stderr, "Bad padding '%s'\n", argv[argIndex]);
+                return 1;
+            }
+        }
+        else
+        {
+            fprintf(stderr, "Unknown option '%s'\n", option.c_str());
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    std::vector<int> fontSizes;
+    std::vector<std::string> sizeItems = SplitList(argv[2]);
+    for (size_t sizeIndex = 0; sizeIndex < sizeItems.size(); sizeIndex++)
+    {
+        unsigned int size = 0;
+        if (!ParseNumber(sizeItems[sizeIndex], size) || size == 0)
+        {
+            fprintf(stderr, "Bad pixel size '%s'\n", sizeItems[sizeIndex].c_str());
+            return 1;
+        }
+        fontSizes.push_back((int)size);
+    }
+    if (fontSizes.empty())
+    {
+        fprintf(stderr, "No pixel sizes\n");
+        return 1;
+    }
+
+    std::vector<unsigned int> codePoints;
+    if (!ParseCodePoints(argv[3], codePoints))
+    {
+        fprintf(stderr, "Bad code point list '%s'\n", argv[3]);
+        return 1;
+    }
+
+    MappedFile fontFile;
+    if (!fontFile.Open(fontFilePath))
+    {
+        fprintf(stderr, "Could not open font '%s'\n", fontFilePath.c_str());
+        return 1;
+    }
+
+    // the worker threads open their own faces, but the cell size needs one too
+    FT_Library library;
+    FT_Face face;
+    if (FT_Init_FreeType(&library))
+    {
+        fprintf(stderr, "Could not init freetype library\n");
+        return 1;
+    }
+    if (FT_New_Memory_Face(library, fontFile.Data(), (FT_Long)fontFile.Size(), 0, &face))
+    {
+        fprintf(stderr, "Could not open font '%s'\n", fontFilePath.c_str());
+        FT_Done_FreeType(library);
+        return 1;
+    }
+
+    // the same key that the renderer's disk cache would use, so that it is possible to tell 
+    // what a baked atlas was baked from
+    AtlasFileKey key;
+    key.fontHash = HashBytes(fontFile.Data(), fontFile.Size());
+    key.codePointHash = HashBytes(codePoints.data(), codePoints.size() * sizeof(unsigned int));
+    key.loadFlags = FT_LOAD_RENDER;
+    key.packingMethod = (unsigned int)packingMethod;
+
+    // the same as FreeTypeEncapsulate::SetDistanceField(...), which keys a plain coverage 
+    // atlas as all 0s
+    if (distanceField.spread == 0)
+    {
+        distanceField.supersample = 0;
+    }
+    key.distanceFieldSpread = distanceField.spread;
+    key.distanceFieldSupersample = distanceField.supersample;
+    key.padding = padding;
+
+    FILE *headerFile = 0;
+    std::string headerFilePath = outputName + ".h";
+    if (writeHeader)
+    {
+        headerFile = fopen(headerFilePath.c_str(), "w");
+        if (headerFile == 0)
+        {
+            fprintf(stderr, "Could not create '%s'\n", headerFilePath.c_str());
+            FT_Done_FreeType(library);
+            return 1;
+        }
+
+        fprintf(headerFile, 
+            "#pragma once\n\n"
+            "// generated by AtlasBaker from '%s'; do not edit\n"
+            "// Note: Hand a view to FreeTypeEncapsulate::GenerateAtlas(...) to draw with it.\n"
+            "%s\n"
+            "#include \"AtlasImage.h\"\n\n"
+            "namespace %sAtlas\n{\n", 
+            fontFilePath.c_str(), 
+            (distanceField.spread == 0) ? "" : 
+                "// Also Note: These are distance fields; draw them with shader_sdf.frag.\n",
+            IdentifierFromPath(outputName).c_str());
+    }
+
+    int exitCode = 0;
+    for (size_t sizeIndex = 0; sizeIndex < fontSizes.size(); sizeIndex++)
+    {
+        int fontSize = fontSizes[sizeIndex];
+
+        GlyphArena glyphs;
+        bool rasterized = (distanceField.spread == 0) ?
+            RasterizeGlyphsParallel(fontFile.Data(), fontFile.Size(), fontSize, codePoints, 0, 
+                glyphs) :
+            RasterizeDistanceFieldsParallel(fontFile.Data(), fontFile.Size(), fontSize, 
+                codePoints, distanceField, 0, glyphs);
+        if (!rasterized)
+        {
+            fprintf(stderr, "Could not rasterize glyphs for font size %d\n", fontSize);
+            exitCode = 1;
+            break;
+        }
+
+        AtlasBuilder builder;
+        builder.SetPackingMethod(packingMethod);
+        builder.SetPadding(padding);
+        AtlasImage atlas;
+        if (!builder.Build(glyphs, maxTextureSize, atlas))
+        {
+            fprintf(stderr, "Could not build atlas for font size %d\n", fontSize);
+            exitCode = 1;
+            break;
+        }
+        GlyphCellSize(face, fontSize, atlas.cellWidth, atlas.cellHeight);
+        atlas.cellWidth += 2 * distanceField.spread;
+        atlas.cellHeight += 2 * distanceField.spread;
+        ExtractKerning(face, fontSize, codePoints, atlas.kerningPairs);
+
+        std::string outputPath = headerFilePath;
+        if (writeHeader)
+        {
+            WriteHeaderAtlas(headerFile, atlas, fontSize);
+        }
+        else
+        {
+            outputPath = outputName + "_" + std::to_string(fontSize) + ".ftatlas";
+            key.fontPixelHeightSize = (unsigned int)fontSize;
+            if (!WriteAtlasFile(outputPath, key, MakeAtlasImageView(atlas)))
+            {
+                exitCode = 1;
+                break;
+            }
+        }
+
+        printf("%d px: %u glyphs, %u x %u, %.1f%% occupied -> %s\n", fontSize, 
+            (unsigned int)atlas.glyphs.size(), atlas.width, atlas.height, 
+            100.0f * atlas.packReport.occupancy, outputPath.c_str());
+        if (atlas.mipLevels > 1)
+        {
+            printf("    %u mip levels\n", atlas.mipLevels);
+        }
+        printf("    %u glyphs share another glyph's bitmap, saving %u bytes\n", 
+            (unsigned int)atlas.packReport.sharedGlyphs, 
+            (unsigned int)atlas.packReport.sharedBytes);
+        printf("    %u kerning pairs\n", (unsigned int)atlas.kerningPairs.size());
+
+        // what the atlas would cost as a compressed texture (see 
+        // FreeTypeEncapsulate::SetAtlasCompression(...)), to help decide whether to use one
+        std::vector<unsigned char> blocks;
+        CompressionReport compression;
+        CompressBc4(atlas.pixels.data(), atlas.width, atlas.height, blocks, compression);
+        printf("    BC4: %u -> %u bytes, mean error %.2f, max error %u, PSNR %.1f dB\n", 
+            (unsigned int)compression.uncompressedBytes, 
+            (unsigned int)compression.compressedBytes, compression.meanAbsoluteError, 
+            compression.maxError, compression.psnr);
+    }
+
+    if (headerFile != 0)
+    {
+        fprintf(headerFile, "}\n");
+        if (fclose(headerFile) != 0)
+        {
+            fprintf(stderr, "Could not write '%s'\n", headerFilePath.c_str());
+            exitCode = 1;
+        }
+    }
+
+    FT_Done_FreeType(library);
+    return exitCode;
+}
@@ -0,0 +1,231 @@
+#include "AtlasBuilder.h"
+
+// for hashing glyph bitmaps
+#include "AtlasFile.h"
+
+// for how far apart glyphs need to be for their mip levels
+#include "AtlasMipmaps.h"
+
+#include <stdio.h>      // for fprintf(...)
+#include <string.h>     // for memcpy(...), memcmp(...)
+
+#include <algorithm>    // for std::max
+#include <unordered_map>
+
+AtlasBuilder::AtlasBuilder() :
+    _packingMethod(PackingMethod::Skyline),
+    _powerOfTwo(false),
+    _padding(1)
+{
+    memset(&_packReport, 0, sizeof(_packReport));
+}
+
+void AtlasBuilder::SetPackingMethod(const PackingMethod method)
+{
+    _packingMethod = method;
+}
+
+void AtlasBuilder::SetPowerOfTwo(const bool powerOfTwo)
+{
+    _powerOfTwo = powerOfTwo;
+}
+
+void AtlasBuilder::SetPadding(const unsigned int padding)
+{
+    // glyphs that touch would bleed into each other even without mipmaps
+    _padding = std::max(padding, 1u);
+}
+
+const PackReport &AtlasBuilder::GetPackReport() const
+{
+    return _packReport;
+}
+
+AtlasImageView MakeAtlasImageView(const AtlasImage &atlas)
+{
+    AtlasImageView view;
+    view.width = atlas.width;
+    view.height = atlas.height;
+    view.glyphs = atlas.glyphs.data();
+    view.glyphCount = atlas.glyphs.size();
+    view.pixels = atlas.pixels.data();
+    view.packReport = atlas.packReport;
+    view.cellWidth = atlas.cellWidth;
+    view.cellHeight = atlas.cellHeight;
+    view.mipLevels = atlas.mipLevels;
+    view.kerningPairs = atlas.kerningPairs.data();
+    view.kerningPairCount = atlas.kerningPairs.size();
+    return view;
+}
+
+bool AtlasBuilder::Build(const GlyphArena &arena, const unsigned int maxTextureSize,
+    AtlasImage &atlas)
+{
+    atlas.width = 0;
+    atlas.height = 0;
+    atlas.cellWidth = 0;
+    atlas.cellHeight = 0;
+    atlas.mipLevels = MipLevelsForPadding(_padding);
+    atlas.glyphs.clear();
+    atlas.pixels.clear();
+
+    std::vector<size_t> uniqueGlyphs;
+    if (!Pack(arena, maxTextureSize, atlas, uniqueGlyphs))
+    {
+        return false;
+    }
+
+    Blit(arena, uniqueGlyphs, atlas);
+    return true;
+}
+
+// true if the two glyphs' bitmaps are the same size and have the same bytes
+static bool SameBitmap(const GlyphArena &arena, const RasterizedGlyph &glyph, 
+    const RasterizedGlyph &other)
+{
+    return glyph.width == other.width && glyph.rows == other.rows && 
+        memcmp(arena.pixels.data() + glyph.pixelOffset, arena.pixels.data() + other.pixelOffset,
+            glyph.width * glyph.rows) == 0;
+}
+
+bool AtlasBuilder::Pack(const GlyphArena &arena, const unsigned int maxTextureSize,
+    AtlasImage &atlas, std::vector<size_t> &uniqueGlyphs)
+{
+    // The packer works in units of the mip alignment (see AtlasMipmaps.h) so that every 
+    // glyph lands on a multiple of it.  A unit is 1 pixel without mipmaps.
+    const unsigned int alignment = MipAlignment(atlas.mipLevels);
+    auto unitsFor = [this, alignment](const unsigned int pixels)
+    {
+        return (pixels + _padding + alignment - 1) / alignment;
+    };
+
+    // Find glyphs whose bitmaps were already seen.  Each one is hashed (dimensions and bytes) 
+    // and looked up among the earlier glyphs with the same hash, and the bytes are compared 
+    // for real before two glyphs are declared the same, so a hash collision can only cost a 
+    // little time, never a wrong glyph.
+    // Note: Every blank glyph (space, no-break space, the various Unicode spaces, etc.) has a 
+    // 0 x 0 bitmap, so they all end up sharing a single spot.
+    std::vector<size_t> sharedWith(arena.glyphs.size());
+    std::unordered_multimap<unsigned long long, size_t> seenBitmaps;
+    seenBitmaps.reserve(arena.glyphs.size());
+    uniqueGlyphs.clear();
+    uniqueGlyphs.reserve(arena.glyphs.size());
+    size_t sharedGlyphs = 0;
+    size_t sharedBytes = 0;
+    for (size_t glyphIndex = 0; glyphIndex < arena.glyphs.size(); glyphIndex++)
+    {
+        const RasterizedGlyph &glyph = arena.glyphs[glyphIndex];
+        unsigned long long bitmapHash = HashBytes(&glyph.width, sizeof(glyph.width));
+        bitmapHash = HashBytes(&glyph.rows, sizeof(glyph.rows), bitmapHash);
+        bitmapHash = HashBytes(arena.pixels.data() + glyph.pixelOffset, 
+            glyph.width * glyph.rows, bitmapHash);
+
+        size_t uniqueIndex = uniqueGlyphs.size();
+        auto candidates = seenBitmaps.equal_range(bitmapHash);
+        for (auto candidate = candidates.first; candidate != candidates.second; ++candidate)
+        {
+            if (SameBitmap(arena, glyph, arena.glyphs[uniqueGlyphs[candidate->second]]))
+            {
+                uniqueIndex = candidate->second;
+                break;
+            }
+        }
+
+        if (uniqueIndex == uniqueGlyphs.size())
+        {
+            seenBitmaps.insert(std::make_pair(bitmapHash, uniqueIndex));
+            uniqueGlyphs.push_back(glyphIndex);
+        }
+        else
+        {
+            sharedGlyphs++;
+            sharedBytes += (size_t)unitsFor(glyph.width) * unitsFor(glyph.rows) * 
+                alignment * alignment;
+        }
+        sharedWith[glyphIndex] = uniqueIndex;
+    }
+
+    // A texture atlas means that a bunch of different images are loaded into the same texture.
+    // The characters in TrueType fonts are not the same size because each character is
+    // designed individually and has its own dimensions, so the packer decides where each one
+    // goes and how big the atlas needs to be.
+    // Note: The padding (1 pixel by default) is a "gutter" between characters in case some 
+    // kind of float rounding at render time (specifically, calculating texture coordinates S 
+    // and T) goes 1 pixel further than it should.  This "gutter" prevents that 1 pixel from
+    // infringing on the edges of another glyph.
+    std::vector<PackRect> rects(uniqueGlyphs.size());
+    for (size_t uniqueIndex = 0; uniqueIndex < uniqueGlyphs.size(); uniqueIndex++)
+    {
+        rects[uniqueIndex].width = unitsFor(arena.glyphs[uniqueGlyphs[uniqueIndex]].width);
+        rects[uniqueIndex].height = unitsFor(arena.glyphs[uniqueGlyphs[uniqueIndex]].rows);
+    }
+
+    if (!PackRects(_packingMethod, _powerOfTwo, maxTextureSize / alignment, rects, 
+        _packReport))
+    {
+        fprintf(stderr, "Glyphs do not fit in a %u x %u texture\n", maxTextureSize,
+            maxTextureSize);
+        return false;
+    }
+
+    // back from units to pixels
+    // Note: Occupancy is a ratio, so it comes out the same either way.
+    for (size_t uniqueIndex = 0; uniqueIndex < rects.size(); uniqueIndex++)
+    {
+        rects[uniqueIndex].x *= alignment;
+        rects[uniqueIndex].y *= alignment;
+    }
+    _packReport.atlasWidth *= alignment;
+    _packReport.atlasHeight *= alignment;
+    _packReport.usedPixels *= (size_t)alignment * alignment;
+    _packReport.wastedBytes *= (size_t)alignment * alignment;
+
+    _packReport.sharedGlyphs = sharedGlyphs;
+    _packReport.sharedBytes = sharedBytes;
+    atlas.packReport = _packReport;
+    atlas.width = _packReport.atlasWidth;
+    atlas.height = _packReport.atlasHeight;
+    atlas.glyphs.reserve(arena.glyphs.size());
+    for (size_t glyphIndex = 0; glyphIndex < arena.glyphs.size(); glyphIndex++)
+    {
+        const RasterizedGlyph &src = arena.glyphs[glyphIndex];
+
+        AtlasGlyph dest;
+        dest.codePoint = src.codePoint;
+        dest.ax = src.ax;
+        dest.ay = src.ay;
+        dest.bl = src.bl;
+        dest.bt = src.bt;
+        dest.width = src.width;
+        dest.rows = src.rows;
+        dest.x = rects[sharedWith[glyphIndex]].x;
+        dest.y = rects[sharedWith[glyphIndex]].y;
+        atlas.glyphs.push_back(dest);
+    }
+
+    return true;
+}
+
+void AtlasBuilder::Blit(const GlyphArena &arena, const std::vector<size_t> &uniqueGlyphs, 
+    AtlasImage &atlas) const
+{
+    // Pack(...) produces exactly one atlas glyph per arena glyph and in the same order
+    // Note: The pixels are zeroed so that the gutters and the unused corners of the atlas are
+    // transparent.
+    // Also Note: Glyphs that share a spot would only copy the same bytes over again, so only 
+    // copy the unique ones.
+    atlas.pixels.assign(atlas.width * atlas.height, 0);
+    for (size_t uniqueIndex = 0; uniqueIndex < uniqueGlyphs.size(); uniqueIndex++)
+    {
+        size_t glyphIndex = uniqueGlyphs[uniqueIndex];
+        const RasterizedGlyph &src = arena.glyphs[glyphIndex];
+        const AtlasGlyph &dest = atlas.glyphs[glyphIndex];
+
+        const unsigned char *srcPixels = arena.pixels.data() + src.pixelOffset;
+        unsigned char *destPixels = atlas.pixels.data() + (dest.y * atlas.width) + dest.x;
+        for (unsigned int row = 0; row < src.rows; row++)
+        {
+            memcpy(destPixels + (row * atlas.width), srcPixels + (row * src.width), src.width);
+        }
+    }
+}
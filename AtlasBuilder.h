@@ -0,0 +1,55 @@
+#pragma once
+
+#include "GlyphArena.h"
+#include "GlyphPacker.h"
+#include "AtlasImage.h"
+
+#include <vector>
+
+// takes a set of already rasterized glyphs, decides where each one goes, and copies the glyph
+// bitmaps into a single atlas-sized buffer
+// Note: No OpenGL and no FreeType calls happen in here, so the builder can run anywhere.
+class AtlasBuilder
+{
+public:
+    AtlasBuilder();
+
+    // defaults to the skyline packer and an atlas that is only as big as it needs to be
+    void SetPackingMethod(const PackingMethod method);
+    void SetPowerOfTwo(const bool powerOfTwo);
+
+    // the number of empty pixels between neighboring glyphs (default 1)
+    // Note: More padding buys mip levels that minified text can sample without glyphs 
+    // bleeding into each other (see AtlasMipmaps.h).  The glyphs are also lined up on a grid 
+    // for that, so the atlas grows faster than the padding alone would suggest.
+    void SetPadding(const unsigned int padding);
+
+    // takes: glyph bitmaps and the largest width/height that the atlas is allowed to have
+    // (usually GL_MAX_TEXTURE_SIZE)
+    // returns: true if all glyphs fit, otherwise false
+    // Note: The builder doesn't have the face, so the atlas' cell size is left at 0 for the 
+    // caller to fill in (see GlyphCellSize(...)).
+    bool Build(const GlyphArena &arena, const unsigned int maxTextureSize,
+        AtlasImage &atlas);
+
+    // atlas dimensions, occupancy, wasted bytes, and bytes saved by sharing identical 
+    // bitmaps from the last call to Build(...)
+    const PackReport &GetPackReport() const;
+
+private:
+    // decides the glyphs' positions in the atlas and the atlas' dimensions
+    // Note: Glyphs with byte-for-byte identical bitmaps (blank glyphs, look-alikes such as 
+    // Latin "A" and Cyrillic "А", etc.) are only packed once and share the same spot.
+    // Also returns: the arena indices of the glyphs that got their own spot
+    bool Pack(const GlyphArena &arena, const unsigned int maxTextureSize,
+        AtlasImage &atlas, std::vector<size_t> &uniqueGlyphs);
+
+    // copies the unique glyphs' bitmaps into the atlas' pixels at their packed positions
+    void Blit(const GlyphArena &arena, const std::vector<size_t> &uniqueGlyphs, 
+        AtlasImage &atlas) const;
+
+    PackingMethod _packingMethod;
+    bool _powerOfTwo;
+    unsigned int _padding;
+    PackReport _packReport;
+};
@@ -0,0 +1,92 @@
+#include "AtlasDiskCache.h"
+
+#include <stdio.h>      // for fprintf(...), snprintf(...)
+
+AtlasDiskCache::AtlasDiskCache()
+{
+}
+
+void AtlasDiskCache::SetDirectory(const std::string &directoryPath)
+{
+    _directoryPath = directoryPath;
+    if (!_directoryPath.empty() && _directoryPath.back() != '/' && 
+        _directoryPath.back() != '\\')
+    {
+        _directoryPath += '/';
+    }
+}
+
+bool AtlasDiskCache::IsEnabled() const
+{
+    return !_directoryPath.empty();
+}
+
+std::string AtlasDiskCache::FilePath(const AtlasFileKey &key) const
+{
+    // fold the whole key into the name so that atlases for different fonts, sizes, etc. can 
+    // sit side by side
+    unsigned long long nameHash = HashBytes(&key.fontHash, sizeof(key.fontHash));
+    nameHash = HashBytes(&key.codePointHash, sizeof(key.codePointHash), nameHash);
+    nameHash = HashBytes(&key.fontPixelHeightSize, sizeof(key.fontPixelHeightSize), nameHash);
+    nameHash = HashBytes(&key.loadFlags, sizeof(key.loadFlags), nameHash);
+    nameHash = HashBytes(&key.packingMethod, sizeof(key.packingMethod), nameHash);
+    nameHash = HashBytes(&key.distanceFieldSpread, sizeof(key.distanceFieldSpread), nameHash);
+    nameHash = HashBytes(&key.distanceFieldSupersample, sizeof(key.distanceFieldSupersample), 
+        nameHash);
+    nameHash = HashBytes(&key.padding, sizeof(key.padding), nameHash);
+
+    char fileName[64];
+    snprintf(fileName, sizeof(fileName), "ftatlas_%016llx_%u.ftatlas", nameHash, 
+        key.fontPixelHeightSize);
+    return _directoryPath + fileName;
+}
+
+bool AtlasDiskCache::Load(const AtlasFileKey &key, MappedFile &file, 
+    AtlasImageView &atlas) const
+{
+    if (!IsEnabled())
+    {
+        return false;
+    }
+
+    std::string filePath = FilePath(key);
+    if (!file.Open(filePath))
+    {
+        // not built yet
+        return false;
+    }
+
+    AtlasFileKey fileKey;
+    if (!ReadAtlasFile(file.Data(), file.Size(), fileKey, atlas))
+    {
+        // truncated or made by some other version of the program, so just quietly rebuild it
+        file.Close();
+        return false;
+    }
+
+    // in case two keys ever hash to the same name
+    if (fileKey.fontHash != key.fontHash || fileKey.codePointHash != key.codePointHash || 
+        fileKey.fontPixelHeightSize != key.fontPixelHeightSize || 
+        fileKey.loadFlags != key.loadFlags || fileKey.packingMethod != key.packingMethod ||
+        fileKey.distanceFieldSpread != key.distanceFieldSpread || 
+        fileKey.distanceFieldSupersample != key.distanceFieldSupersample ||
+        fileKey.padding != key.padding)
+    {
+        fprintf(stderr, "Atlas cache file '%s' was made for a different atlas\n", 
+            filePath.c_str());
+        file.Close();
+        return false;
+    }
+
+    return true;
+}
+
+bool AtlasDiskCache::Save(const AtlasFileKey &key, const AtlasImageView &atlas) const
+{
+    if (!IsEnabled())
+    {
+        return false;
+    }
+
+    return WriteAtlasFile(FilePath(key), key, atlas);
+}
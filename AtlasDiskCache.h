@@ -0,0 +1,40 @@
+#pragma once
+
+// for the file format and the key that names a file
+#include "AtlasFile.h"
+
+// for mapping cache files instead of reading them
+#include "MappedFile.h"
+
+#include <string>
+
+// keeps finished atlases on disk so that later launches can skip FreeType entirely
+// Note: A cache file is an ordinary atlas file (see AtlasFile.h), so loading one is a matter of 
+// mapping the file and pointing an AtlasImageView at it.
+// Also Note: A file from a different machine or an older version of this program simply fails 
+// the header check and gets rebuilt.
+class AtlasDiskCache
+{
+public:
+    AtlasDiskCache();
+
+    // takes: the directory that cache files go in, which must already exist
+    // Note: An empty directory turns the cache off.
+    void SetDirectory(const std::string &directoryPath);
+    bool IsEnabled() const;
+
+    // returns: where the atlas for this key lives (or would live)
+    std::string FilePath(const AtlasFileKey &key) const;
+
+    // maps the key's cache file and points the view at its contents
+    // Note: The view is only good for as long as the file stays open.
+    // returns: true if there was a valid cache file for the key, otherwise false
+    bool Load(const AtlasFileKey &key, MappedFile &file, AtlasImageView &atlas) const;
+
+    // writes the atlas to the key's cache file
+    // returns: true if the file was written, otherwise false
+    bool Save(const AtlasFileKey &key, const AtlasImageView &atlas) const;
+
+private:
+    std::string _directoryPath;
+};
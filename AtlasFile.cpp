@@ -0,0 +1,202 @@
+#include "AtlasFile.h"
+
+#include <stdio.h>      // for fopen(...), fprintf(...), rename(...), etc.
+#include <string.h>     // for memcpy(...)
+
+// "FTAC" in a little-endian file
+static const unsigned int AtlasFileMagic = 0x43415446;
+
+// bump this whenever the header, AtlasGlyph, or the way that atlases are built changes
+static const unsigned int AtlasFileVersion = 5;
+
+// the first thing in an atlas file
+// Note: Every member sits on its natural alignment and the whole thing is a multiple of 8 bytes,
+// so the glyph array that follows it is properly aligned in a mapped file too (mappings always 
+// start on a page boundary).
+struct AtlasFileHeader
+{
+    unsigned int magic;
+    unsigned int version;
+
+    // the key that the file was made for
+    unsigned long long fontHash;
+    unsigned long long codePointHash;
+    unsigned int fontPixelHeightSize;
+    unsigned int loadFlags;
+    unsigned int packingMethod;
+    unsigned int distanceFieldSpread;
+    unsigned int distanceFieldSupersample;
+    unsigned int padding;
+
+    unsigned int width;
+    unsigned int height;
+    unsigned int cellWidth;
+    unsigned int cellHeight;
+    unsigned int glyphCount;
+    unsigned int mipLevels;
+
+    // the pack report's fields
+    // Note: Spelled out rather than being a PackReport because PackReport's layout is up to 
+    // the compiler.
+    unsigned int reportAtlasWidth;
+    unsigned int reportAtlasHeight;
+    unsigned long long reportUsedPixels;
+    unsigned long long reportWastedBytes;
+    unsigned long long reportSharedBytes;
+    float reportOccupancy;
+    unsigned int reportSharedGlyphs;
+
+    // the kerning pairs come right after the glyphs (see AtlasKerningPair)
+    // Note: The padding keeps the header a multiple of 8 bytes.
+    unsigned int kerningPairCount;
+    unsigned int unused;
+};
+static_assert(sizeof(AtlasFileHeader) % 8 == 0, "atlas file header must be 8-byte sized");
+static_assert(sizeof(AtlasGlyph) == 9 * 4, "AtlasGlyph must not have padding");
+static_assert(sizeof(AtlasKerningPair) == 3 * 4, "AtlasKerningPair must not have padding");
+
+unsigned long long HashBytes(const void *bytes, const size_t byteCount, 
+    const unsigned long long seed)
+{
+    const unsigned long long fnvPrime = 1099511628211ULL;
+    const unsigned char *bytePtr = (const unsigned char *)bytes;
+    unsigned long long hash = seed;
+
+    // Note: memcpy(...) instead of a cast because the bytes might not be 8-byte aligned; the 
+    // compiler turns it into a plain load.
+    size_t byteIndex = 0;
+    for (; byteIndex + 8 <= byteCount; byteIndex += 8)
+    {
+        unsigned long long word;
+        memcpy(&word, bytePtr + byteIndex, 8);
+        hash = (hash ^ word) * fnvPrime;
+    }
+    for (; byteIndex < byteCount; byteIndex++)
+    {
+        hash = (hash ^ bytePtr[byteIndex]) * fnvPrime;
+    }
+
+    return hash;
+}
+
+bool WriteAtlasFile(const std::string &filePath, const AtlasFileKey &key, 
+    const AtlasImageView &atlas)
+{
+    AtlasFileHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = AtlasFileMagic;
+    header.version = AtlasFileVersion;
+    header.fontHash = key.fontHash;
+    header.codePointHash = key.codePointHash;
+    header.fontPixelHeightSize = key.fontPixelHeightSize;
+    header.loadFlags = key.loadFlags;
+    header.packingMethod = key.packingMethod;
+    header.distanceFieldSpread = key.distanceFieldSpread;
+    header.distanceFieldSupersample = key.distanceFieldSupersample;
+    header.padding = key.padding;
+    header.width = atlas.width;
+    header.height = atlas.height;
+    header.cellWidth = atlas.cellWidth;
+    header.cellHeight = atlas.cellHeight;
+    header.glyphCount = (unsigned int)atlas.glyphCount;
+    header.mipLevels = atlas.mipLevels;
+    header.reportAtlasWidth = atlas.packReport.atlasWidth;
+    header.reportAtlasHeight = atlas.packReport.atlasHeight;
+    header.reportUsedPixels = atlas.packReport.usedPixels;
+    header.reportWastedBytes = atlas.packReport.wastedBytes;
+    header.reportOccupancy = atlas.packReport.occupancy;
+    header.reportSharedGlyphs = (unsigned int)atlas.packReport.sharedGlyphs;
+    header.reportSharedBytes = atlas.packReport.sharedBytes;
+    header.kerningPairCount = (unsigned int)atlas.kerningPairCount;
+
+    std::string tempFilePath = filePath + ".tmp";
+    FILE *tempFile = fopen(tempFilePath.c_str(), "wb");
+    if (tempFile == 0)
+    {
+        fprintf(stderr, "Could not create atlas file '%s'\n", tempFilePath.c_str());
+        return false;
+    }
+
+    size_t pixelBytes = (size_t)atlas.width * atlas.height;
+    bool written = 
+        fwrite(&header, sizeof(header), 1, tempFile) == 1 &&
+        fwrite(atlas.glyphs, sizeof(AtlasGlyph), atlas.glyphCount, tempFile) == 
+            atlas.glyphCount &&
+        fwrite(atlas.kerningPairs, sizeof(AtlasKerningPair), atlas.kerningPairCount,
+            tempFile) == atlas.kerningPairCount &&
+        fwrite(atlas.pixels, 1, pixelBytes, tempFile) == pixelBytes;
+    written = (fclose(tempFile) == 0) && written;
+    if (!written)
+    {
+        fprintf(stderr, "Could not write atlas file '%s'\n", tempFilePath.c_str());
+        remove(tempFilePath.c_str());
+        return false;
+    }
+
+    // Note: rename(...) won't replace an existing file on Windows, so get rid of any stale 
+    // copy first.
+    remove(filePath.c_str());
+    if (rename(tempFilePath.c_str(), filePath.c_str()) != 0)
+    {
+        fprintf(stderr, "Could not rename atlas file to '%s'\n", filePath.c_str());
+        remove(tempFilePath.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool ReadAtlasFile(const unsigned char *fileBytes, const size_t fileSize, AtlasFileKey &key,
+    AtlasImageView &atlas)
+{
+    if (fileSize < sizeof(AtlasFileHeader))
+    {
+        return false;
+    }
+
+    const AtlasFileHeader *header = (const AtlasFileHeader *)fileBytes;
+    if (header->magic != AtlasFileMagic || header->version != AtlasFileVersion)
+    {
+        return false;
+    }
+
+    // the file must be exactly as long as the header says that it is, or else something went 
+    // wrong when it was written
+    size_t glyphBytes = header->glyphCount * sizeof(AtlasGlyph);
+    size_t kerningBytes = header->kerningPairCount * sizeof(AtlasKerningPair);
+    size_t pixelBytes = (size_t)header->width * header->height;
+    if (fileSize != sizeof(AtlasFileHeader) + glyphBytes + kerningBytes + pixelBytes)
+    {
+        return false;
+    }
+
+    key.fontHash = header->fontHash;
+    key.codePointHash = header->codePointHash;
+    key.fontPixelHeightSize = header->fontPixelHeightSize;
+    key.loadFlags = header->loadFlags;
+    key.packingMethod = header->packingMethod;
+    key.distanceFieldSpread = header->distanceFieldSpread;
+    key.distanceFieldSupersample = header->distanceFieldSupersample;
+    key.padding = header->padding;
+
+    atlas.width = header->width;
+    atlas.height = header->height;
+    atlas.cellWidth = header->cellWidth;
+    atlas.cellHeight = header->cellHeight;
+    atlas.mipLevels = header->mipLevels;
+    atlas.glyphs = (const AtlasGlyph *)(fileBytes + sizeof(AtlasFileHeader));
+    atlas.glyphCount = header->glyphCount;
+    atlas.kerningPairs = (const AtlasKerningPair *)
+        (fileBytes + sizeof(AtlasFileHeader) + glyphBytes);
+    atlas.kerningPairCount = header->kerningPairCount;
+    atlas.pixels = fileBytes + sizeof(AtlasFileHeader) + glyphBytes + kerningBytes;
+    atlas.packReport.method = (PackingMethod)header->packingMethod;
+    atlas.packReport.atlasWidth = header->reportAtlasWidth;
+    atlas.packReport.atlasHeight = header->reportAtlasHeight;
+    atlas.packReport.usedPixels = (size_t)header->reportUsedPixels;
+    atlas.packReport.occupancy = header->reportOccupancy;
+    atlas.packReport.wastedBytes = (size_t)header->reportWastedBytes;
+    atlas.packReport.sharedGlyphs = header->reportSharedGlyphs;
+    atlas.packReport.sharedBytes = (size_t)header->reportSharedBytes;
+    return true;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+// for the view that reading a file hands back and the image that gets written
+#include "AtlasImage.h"
+
+#include <string>
+
+// FNV-1a, but folding in 8 bytes at a time instead of 1 so that hashing a whole font file on 
+// every launch stays cheap
+// Note: This is for telling files apart, not for security.  The seed lets a hash be continued 
+// across several calls.
+unsigned long long HashBytes(const void *bytes, const size_t byteCount, 
+    const unsigned long long seed = 14695981039346656037ULL);
+
+// everything that changes what an atlas looks like
+// Note: The disk cache uses this to tell its files apart, and a baked atlas records it so 
+// that it is possible to tell what the atlas was baked from.
+struct AtlasFileKey
+{
+    unsigned long long fontHash;
+    unsigned long long codePointHash;
+    unsigned int fontPixelHeightSize;
+    unsigned int loadFlags;
+    unsigned int packingMethod;
+
+    // both 0 for a plain coverage atlas (see DistanceField.h)
+    unsigned int distanceFieldSpread;
+    unsigned int distanceFieldSupersample;
+
+    // pixels between glyphs (see AtlasBuilder::SetPadding(...))
+    unsigned int padding;
+};
+
+// An atlas file is a header, the glyph array, the kerning pairs, and the pixels, back to back,
+// exactly as they are laid out in memory.  Reading one is a matter of pointing an
+// AtlasImageView at the bytes; nothing is parsed or copied, so the bytes can come from a
+// memory-mapped file (see MappedFile.h) or from an array that was compiled into the program.
+// Note: The file is written in whatever byte order the machine uses.  A file from a machine 
+// with the other byte order (or from an older version of this program) fails the header check.
+
+// writes the key and the atlas to the file
+// Note: The file is written under a temporary name first and then renamed, so a program 
+// that crashes (or another process that is loading the same atlas at the same time) can 
+// never see a half-written file.
+// returns: true if the file was written, otherwise false
+bool WriteAtlasFile(const std::string &filePath, const AtlasFileKey &key, 
+    const AtlasImageView &atlas);
+
+// checks the header and points the view at the glyphs and pixels
+// Note: The view is only good for as long as the bytes are.
+// returns: true if the bytes hold a valid atlas, otherwise false
+bool ReadAtlasFile(const unsigned char *fileBytes, const size_t fileSize, AtlasFileKey &key,
+    AtlasImageView &atlas);
@@ -0,0 +1,98 @@
+#pragma once
+
+// for the report on how the glyphs were packed
+// Note: Nothing in here needs FreeType, so an atlas that was loaded from somewhere other than 
+// FreeType (the disk cache, for example) can be described without it.
+#include "GlyphPacker.h"
+
+#include <vector>
+
+// a glyph's metrics plus where its bitmap ended up in the atlas
+// Note: Every member is 4 bytes and there is no padding, so arrays of these can be written to 
+// and read from files as-is.
+struct AtlasGlyph
+{
+    unsigned int codePoint;
+
+    // advance X and Y and bitmap left and top, in pixels (see RasterizedGlyph)
+    float ax;
+    float ay;
+    float bl;
+    float bt;
+
+    // bitmap dimensions in pixels
+    unsigned int width;
+    unsigned int rows;
+
+    // pixel offset of the bitmap's top left corner within the atlas
+    unsigned int x;
+    unsigned int y;
+};
+
+// how much closer together (or further apart) two glyphs go when one follows the other, on
+// top of the first one's advance, from the font's kerning table (ex: "AV" is usually pulled
+// together)
+// Note: Like AtlasGlyph, every member is 4 bytes and there is no padding.  Only pairs that
+// actually move the pen are kept.
+struct AtlasKerningPair
+{
+    unsigned int left;
+    unsigned int right;
+
+    // in pixels, usually negative
+    float x;
+};
+
+// a finished atlas that lives entirely in CPU memory and is ready to go to the GPU in one
+// upload
+// Note: 1 byte per pixel, rows are tightly packed, and row 0 is the top of the atlas (the same
+// layout as FreeType's bitmaps).
+struct AtlasImage
+{
+    unsigned int width;
+    unsigned int height;
+    std::vector<AtlasGlyph> glyphs;
+    std::vector<unsigned char> pixels;
+    PackReport packReport;
+
+    // the size of the cells that glyphs outside of the prebuilt set are rasterized into (see 
+    // GlyphCache.h and GlyphCellSize(...)), or 0 if there won't be any
+    // Note: The cell size depends on the whole face, not just on the prebuilt glyphs, so it is 
+    // worked out when the atlas is built and kept with it.  That way an atlas that was loaded 
+    // from somewhere else doesn't need to open the face just to find out how big a cell is.
+    unsigned int cellWidth;
+    unsigned int cellHeight;
+
+    // how many mip levels the glyphs' spacing allows, including the full size one (see 
+    // AtlasMipmaps.h); 1 means no mipmaps
+    // Note: Only the full size level is stored.  The rest are made when the atlas is uploaded.
+    unsigned int mipLevels;
+
+    // every kerned pair of the prebuilt glyphs, in no particular order (see KerningTable.h)
+    // Note: Like the cell size, these come from the face, not from the glyphs, so they are
+    // worked out when the atlas is built and kept with it (see ExtractKerning(...)).
+    std::vector<AtlasKerningPair> kerningPairs;
+};
+
+// the same thing as an AtlasImage, but pointing at memory that belongs to someone else, such 
+// as a memory-mapped file, so that the atlas can be uploaded without copying it first
+struct AtlasImageView
+{
+    unsigned int width;
+    unsigned int height;
+    const AtlasGlyph *glyphs;
+    size_t glyphCount;
+    const unsigned char *pixels;
+    PackReport packReport;
+    unsigned int cellWidth;
+    unsigned int cellHeight;
+    unsigned int mipLevels;
+
+    // Note: These come last so that a view that was baked before there were kerning pairs
+    // (see AtlasBaker.cpp) still compiles, with none.
+    const AtlasKerningPair *kerningPairs;
+    size_t kerningPairCount;
+};
+
+// points a view at an image; the image must outlive the view
+AtlasImageView MakeAtlasImageView(const AtlasImage &atlas);
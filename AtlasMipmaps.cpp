@@ -0,0 +1,45 @@
+#include "AtlasMipmaps.h"
+
+#include <algorithm>    // for std::max, std::min
+
+unsigned int MipLevelsForPadding(const unsigned int padding)
+{
+    // the largest power of 2 that fits in the padding decides the last level
+    unsigned int mipLevels = 1;
+    while ((2u << (mipLevels - 1)) <= padding)
+    {
+        mipLevels++;
+    }
+    return mipLevels;
+}
+
+unsigned int MipAlignment(const unsigned int mipLevels)
+{
+    return 1u << (std::max(mipLevels, 1u) - 1);
+}
+
+void DownsampleCoverage(const unsigned char *pixels, const unsigned int width, 
+    const unsigned int height, std::vector<unsigned char> &halved)
+{
+    // the same sizes that OpenGL expects for the next level
+    unsigned int halvedWidth = std::max(width / 2, 1u);
+    unsigned int halvedHeight = std::max(height / 2, 1u);
+    halved.resize(halvedWidth * halvedHeight);
+
+    for (unsigned int y = 0; y < halvedHeight; y++)
+    {
+        const unsigned char *topRow = pixels + ((2 * y) * width);
+        const unsigned char *bottomRow = pixels + (std::min((2 * y) + 1, height - 1) * width);
+        for (unsigned int x = 0; x < halvedWidth; x++)
+        {
+            unsigned int left = 2 * x;
+            unsigned int right = std::min(left + 1, width - 1);
+
+            // "+ 2" rounds to the nearest instead of always rounding down, which would make 
+            // every level a little lighter than the last
+            unsigned int sum = topRow[left] + topRow[right] + bottomRow[left] + 
+                bottomRow[right];
+            halved[(y * halvedWidth) + x] = (unsigned char)((sum + 2) / 4);
+        }
+    }
+}
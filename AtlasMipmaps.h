@@ -0,0 +1,30 @@
+#pragma once
+
+#include <vector>
+
+// Shrinking text samples the atlas at a fraction of its resolution, which makes neighboring
+// fragments read texels that are far apart, which thrashes the texture cache and makes small
+// text shimmer.  Mipmaps fix both, but a mip level is built from blocks of pixels, and a block
+// that straddles two glyphs would blend one glyph into the other.  So the atlas builder spaces
+// glyphs out by the padding and lines them up on a grid (see AtlasBuilder::SetPadding(...)),
+// and these helpers work out how many levels that spacing is good for and build them.
+// Note: Nothing in here needs OpenGL or FreeType.
+
+// takes: the number of empty pixels between neighboring glyphs
+// returns: how many mip levels (including the full size one) can be sampled, with linear 
+// filtering, without any glyph bleeding into another
+// Note: Level N is made from 2^N x 2^N blocks, so the glyphs have to start on multiples of 
+// 2^N (the alignment) and be separated by at least that many pixels.  A padding of 1 (the 
+// default) means no mipmaps.
+unsigned int MipLevelsForPadding(const unsigned int padding);
+
+// the pixel alignment that the glyphs need for the given number of mip levels (2^(levels - 1))
+unsigned int MipAlignment(const unsigned int mipLevels);
+
+// makes the next mip level: half as wide and half as tall (but at least 1 x 1), with every
+// pixel being the average of the 2 x 2 block that it came from
+// Note: The average is how much of the block the glyph covers, so the total coverage (how 
+// dark the text looks from a distance) is the same at every level.  The block is clamped at 
+// the edges for odd sizes, which the atlas never has, but a view from a file might.
+void DownsampleCoverage(const unsigned char *pixels, const unsigned int width, 
+    const unsigned int height, std::vector<unsigned char> &halved);
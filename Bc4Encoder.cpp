@@ -0,0 +1,339 @@
+#include "Bc4Encoder.h"
+
+#include <math.h>       // for log10f(...)
+#include <stdlib.h>     // for abs(...)
+#include <string.h>     // for memcpy(...), memset(...)
+
+#include <algorithm>    // for std::min, std::max
+
+// Note: MSVC doesn't define __SSE2__, so check its own macros too.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BC4_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+// each block is 4x4 pixels and 8 bytes
+static const unsigned int BlockSize = 4;
+static const unsigned int BytesPerBlock = 8;
+
+// the values that a block's indices pick from
+// Note: The GPU does this math with more precision than integers, so these can be off from
+// the GPU's by a rounding step.  That is fine for choosing indices and for the report.
+static void BlockPalette(const unsigned char red0, const unsigned char red1,
+    unsigned char palette[8])
+{
+    palette[0] = red0;
+    palette[1] = red1;
+    if (red0 > red1)
+    {
+        // 6 values between the endpoints
+        for (int index = 2; index < 8; index++)
+        {
+            palette[index] = (unsigned char)
+                ((((8 - index) * red0) + ((index - 1) * red1) + 3) / 7);
+        }
+    }
+    else
+    {
+        // 4 values between the endpoints, plus 0 and 255
+        for (int index = 2; index < 6; index++)
+        {
+            palette[index] = (unsigned char)
+                ((((6 - index) * red0) + ((index - 1) * red1) + 2) / 5);
+        }
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+}
+
+// sum of squared differences between the block and the palette values that it picked
+static unsigned int BlockError(const unsigned char block[16], const unsigned char palette[8],
+    const unsigned char indices[16])
+{
+    unsigned int error = 0;
+    for (int pixel = 0; pixel < 16; pixel++)
+    {
+        int difference = (int)block[pixel] - (int)palette[indices[pixel]];
+        error += (unsigned int)(difference * difference);
+    }
+    return error;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Picks each pixel's index for the 8-value mode, where the block's brightest pixel is
+    endpoint 0 and its darkest pixel is endpoint 1.  The 8 values form a ramp from darkest to
+    brightest, and a pixel's spot on the ramp is how many of the 7 midpoints between
+    neighboring ramp values it is brighter than.  BC4 numbers the ramp oddly (endpoint 0,
+    endpoint 1, then the in-between values from brightest to darkest), so the ramp spot is
+    then turned into an index.
+Parameters:
+    block       The 16 pixels, row by row.
+    darkest     The block's smallest pixel.
+    brightest   The block's biggest pixel; must be bigger than the darkest.
+    indices     Gets 16 indices, one per pixel, on the range [0, 7].
+Returns:    None
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static void RampIndices(const unsigned char block[16], const unsigned char darkest,
+    const unsigned char brightest, unsigned char indices[16])
+{
+    unsigned char ramp[8];
+    for (int spot = 0; spot < 8; spot++)
+    {
+        ramp[spot] = (unsigned char)(((spot * brightest) + ((7 - spot) * darkest) + 3) / 7);
+    }
+    unsigned char midpoints[7];
+    for (int spot = 0; spot < 7; spot++)
+    {
+        midpoints[spot] = (unsigned char)((ramp[spot] + ramp[spot + 1]) / 2);
+    }
+
+#ifdef BC4_USE_SSE2
+    // SSE2 only compares signed bytes, so flip the top bit of everything to compare them as
+    // unsigned
+    const __m128i signFlip = _mm_set1_epi8((char)0x80);
+    __m128i pixels = _mm_xor_si128(_mm_loadu_si128((const __m128i *)block), signFlip);
+    __m128i spots = _mm_setzero_si128();
+    for (int spot = 0; spot < 7; spot++)
+    {
+        // a true comparison is -1, so subtracting it counts it
+        __m128i midpoint = _mm_set1_epi8((char)(midpoints[spot] ^ 0x80));
+        spots = _mm_sub_epi8(spots, _mm_cmpgt_epi8(pixels, midpoint));
+    }
+
+    // spots 1 - 6 become indices 7 - 2, and (8 - spot) & 7 gets those right, but it turns
+    // spot 0 into index 0 and spot 7 into index 1, which is backwards, so swap those two
+    __m128i spotIndices = _mm_and_si128(_mm_sub_epi8(_mm_set1_epi8(8), spots),
+        _mm_set1_epi8(7));
+    __m128i isEndpoint = _mm_cmplt_epi8(spotIndices, _mm_set1_epi8(2));
+    spotIndices = _mm_xor_si128(spotIndices, _mm_and_si128(isEndpoint, _mm_set1_epi8(1)));
+    _mm_storeu_si128((__m128i *)indices, spotIndices);
+#else
+    for (int pixel = 0; pixel < 16; pixel++)
+    {
+        int spot = 0;
+        for (int midpoint = 0; midpoint < 7; midpoint++)
+        {
+            spot += (block[pixel] > midpoints[midpoint]) ? 1 : 0;
+        }
+
+        int index = (8 - spot) & 7;
+        indices[pixel] = (unsigned char)((index < 2) ? (index ^ 1) : index);
+    }
+#endif
+}
+
+// the smallest and biggest of the block's pixels
+static void BlockRange(const unsigned char block[16], unsigned char &darkest,
+    unsigned char &brightest)
+{
+#ifdef BC4_USE_SSE2
+    // fold the 16 bytes in half four times
+    __m128i pixels = _mm_loadu_si128((const __m128i *)block);
+    __m128i low = _mm_min_epu8(pixels, _mm_srli_si128(pixels, 8));
+    __m128i high = _mm_max_epu8(pixels, _mm_srli_si128(pixels, 8));
+    low = _mm_min_epu8(low, _mm_srli_si128(low, 4));
+    high = _mm_max_epu8(high, _mm_srli_si128(high, 4));
+    low = _mm_min_epu8(low, _mm_srli_si128(low, 2));
+    high = _mm_max_epu8(high, _mm_srli_si128(high, 2));
+    low = _mm_min_epu8(low, _mm_srli_si128(low, 1));
+    high = _mm_max_epu8(high, _mm_srli_si128(high, 1));
+    darkest = (unsigned char)(_mm_cvtsi128_si32(low) & 0xFF);
+    brightest = (unsigned char)(_mm_cvtsi128_si32(high) & 0xFF);
+#else
+    darkest = block[0];
+    brightest = block[0];
+    for (int pixel = 1; pixel < 16; pixel++)
+    {
+        darkest = std::min(darkest, block[pixel]);
+        brightest = std::max(brightest, block[pixel]);
+    }
+#endif
+}
+
+// the 6-value mode, with its ramp between the darkest and brightest pixels that aren't 0 or
+// 255, which the mode has exact values for
+// returns: the block's error (see BlockError(...))
+static unsigned int EncodeSixValueMode(const unsigned char block[16], unsigned char &red0,
+    unsigned char &red1, unsigned char indices[16])
+{
+    unsigned char darkest = 255;
+    unsigned char brightest = 0;
+    for (int pixel = 0; pixel < 16; pixel++)
+    {
+        if (block[pixel] != 0 && block[pixel] != 255)
+        {
+            darkest = std::min(darkest, block[pixel]);
+            brightest = std::max(brightest, block[pixel]);
+        }
+    }
+    if (darkest > brightest)
+    {
+        // nothing but 0s and 255s
+        darkest = 0;
+        brightest = 0;
+    }
+
+    // this mode is the one where endpoint 0 is not bigger than endpoint 1
+    red0 = darkest;
+    red1 = brightest;
+    unsigned char palette[8];
+    BlockPalette(red0, red1, palette);
+    for (int pixel = 0; pixel < 16; pixel++)
+    {
+        int bestIndex = 0;
+        int bestDifference = 256;
+        for (int index = 0; index < 8; index++)
+        {
+            int difference = abs((int)block[pixel] - (int)palette[index]);
+            if (difference < bestDifference)
+            {
+                bestIndex = index;
+                bestDifference = difference;
+            }
+        }
+        indices[pixel] = (unsigned char)bestIndex;
+    }
+
+    return BlockError(block, palette, indices);
+}
+
+static void EncodeBlock(const unsigned char block[16], unsigned char encoded[8])
+{
+    unsigned char darkest = 0;
+    unsigned char brightest = 0;
+    BlockRange(block, darkest, brightest);
+
+    unsigned char red0 = brightest;
+    unsigned char red1 = darkest;
+    unsigned char indices[16];
+    if (darkest == brightest)
+    {
+        // all the same, so every pixel is endpoint 0 exactly
+        memset(indices, 0, sizeof(indices));
+    }
+    else
+    {
+        RampIndices(block, darkest, brightest, indices);
+
+        // the other mode can only do better if 0 or 255 is in the block, which, for glyphs,
+        // is just about every block that is on an edge
+        if (darkest == 0 || brightest == 255)
+        {
+            unsigned char palette[8];
+            BlockPalette(red0, red1, palette);
+            unsigned int rampError = BlockError(block, palette, indices);
+
+            unsigned char sixValueRed0 = 0;
+            unsigned char sixValueRed1 = 0;
+            unsigned char sixValueIndices[16];
+            if (EncodeSixValueMode(block, sixValueRed0, sixValueRed1, sixValueIndices) <
+                rampError)
+            {
+                red0 = sixValueRed0;
+                red1 = sixValueRed1;
+                memcpy(indices, sixValueIndices, sizeof(indices));
+            }
+        }
+    }
+
+    // 2 bytes of endpoints followed by 48 bits of indices, 3 bits per pixel, least
+    // significant bit first
+    unsigned long long indexBits = 0;
+    for (int pixel = 0; pixel < 16; pixel++)
+    {
+        indexBits |= (unsigned long long)indices[pixel] << (3 * pixel);
+    }
+    encoded[0] = red0;
+    encoded[1] = red1;
+    for (int byteIndex = 0; byteIndex < 6; byteIndex++)
+    {
+        encoded[2 + byteIndex] = (unsigned char)(indexBits >> (8 * byteIndex));
+    }
+}
+
+// what the GPU will get out of a block
+static void DecodeBlock(const unsigned char encoded[8], unsigned char block[16])
+{
+    unsigned char palette[8];
+    BlockPalette(encoded[0], encoded[1], palette);
+
+    unsigned long long indexBits = 0;
+    for (int byteIndex = 0; byteIndex < 6; byteIndex++)
+    {
+        indexBits |= (unsigned long long)encoded[2 + byteIndex] << (8 * byteIndex);
+    }
+    for (int pixel = 0; pixel < 16; pixel++)
+    {
+        block[pixel] = palette[(indexBits >> (3 * pixel)) & 7];
+    }
+}
+
+void CompressBc4(const unsigned char *pixels, const unsigned int width,
+    const unsigned int height, std::vector<unsigned char> &blocks, CompressionReport &report)
+{
+    unsigned int blockColumns = (width + BlockSize - 1) / BlockSize;
+    unsigned int blockRows = (height + BlockSize - 1) / BlockSize;
+    blocks.resize((size_t)blockColumns * blockRows * BytesPerBlock);
+
+    unsigned long long absoluteErrorSum = 0;
+    unsigned long long squaredErrorSum = 0;
+    unsigned int maxError = 0;
+
+    unsigned char block[16];
+    unsigned char decoded[16];
+    for (unsigned int blockRow = 0; blockRow < blockRows; blockRow++)
+    {
+        for (unsigned int blockColumn = 0; blockColumn < blockColumns; blockColumn++)
+        {
+            // copy the block out of the image, with 0s wherever it hangs off of the edge
+            unsigned int x = blockColumn * BlockSize;
+            unsigned int y = blockRow * BlockSize;
+            unsigned int blockWidth = std::min(BlockSize, width - x);
+            unsigned int blockHeight = std::min(BlockSize, height - y);
+            memset(block, 0, sizeof(block));
+            for (unsigned int row = 0; row < blockHeight; row++)
+            {
+                memcpy(block + (row * BlockSize), pixels + ((size_t)(y + row) * width) + x,
+                    blockWidth);
+            }
+
+            unsigned char *encoded = blocks.data() +
+                (((size_t)blockRow * blockColumns) + blockColumn) * BytesPerBlock;
+            EncodeBlock(block, encoded);
+
+            // only the image's own pixels count toward the report, not the padding
+            DecodeBlock(encoded, decoded);
+            for (unsigned int row = 0; row < blockHeight; row++)
+            {
+                for (unsigned int column = 0; column < blockWidth; column++)
+                {
+                    unsigned int pixel = (row * BlockSize) + column;
+                    unsigned int error = (unsigned int)abs((int)block[pixel] -
+                        (int)decoded[pixel]);
+                    absoluteErrorSum += error;
+                    squaredErrorSum += error * error;
+                    maxError = std::max(maxError, error);
+                }
+            }
+        }
+    }
+
+    size_t pixelCount = (size_t)width * height;
+    report.uncompressedBytes = pixelCount;
+    report.compressedBytes = blocks.size();
+    report.maxError = maxError;
+    report.meanAbsoluteError = 0.0f;
+    report.psnr = 100.0f;
+    if (pixelCount != 0)
+    {
+        report.meanAbsoluteError = (float)absoluteErrorSum / (float)pixelCount;
+        if (squaredErrorSum != 0)
+        {
+            float meanSquaredError = (float)squaredErrorSum / (float)pixelCount;
+            report.psnr = std::min(10.0f * log10f((255.0f * 255.0f) / meanSquaredError),
+                100.0f);
+        }
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <stddef.h>     // for size_t
+
+#include <vector>
+
+// how much compressing an atlas saves and how much it costs in quality, so that it can be
+// decided per font (and per size) whether it is worth it
+// Note: Differences are between the atlas' pixels and what the GPU decodes from the blocks,
+// on the range [0, 255].
+struct CompressionReport
+{
+    // texture bytes without and with compression
+    size_t uncompressedBytes;
+    size_t compressedBytes;
+
+    float meanAbsoluteError;
+    unsigned int maxError;
+
+    // peak signal to noise ratio, in decibels; higher is better, and 100 means lossless
+    // Note: Text usually can't be told apart from the original above about 40 dB.
+    float psnr;
+};
+
+// compresses a 1-byte-per-pixel image into BC4 blocks (also called RGTC1), which OpenGL takes
+// as GL_COMPRESSED_RED_RGTC1
+// Note: Every 4x4 block of pixels becomes 8 bytes (two endpoints and a 3-bit index per pixel
+// that picks one of the 8 values between the endpoints), so the image takes half as much
+// memory and half as much bandwidth to sample.  Blocks are in rows, left to right and top to
+// bottom, and an image whose width or height isn't a multiple of 4 is padded with 0s.
+// Also Note: Each block tries both of BC4's modes and keeps whichever one is closer: a ramp
+// of 8 values between the block's darkest and brightest pixels, or a ramp of 6 values plus
+// exact 0 and 255, which suits glyph edges that go from fully transparent to fully opaque.
+// Also Also Note: The block encoding uses SSE2 where the compiler has it (every x64 build,
+// and x86 builds with /arch:SSE2, which is the default); otherwise it is plain C++, and
+// both give exactly the same blocks.
+void CompressBc4(const unsigned char *pixels, const unsigned int width,
+    const unsigned int height, std::vector<unsigned char> &blocks, CompressionReport &report);
@@ -0,0 +1,320 @@
+// ComputeLayoutCheck: a command-line check that the compute shader layout (see
+// FreeTypeAtlas::RenderTextCompute(...) and shader_layout.comp) puts every quad where
+// FreeTypeAtlas::AppendText(...) puts it on the CPU.
+//
+// usage: ComputeLayoutCheck [font file] [pixel size]
+//  - font file: default FreeSans.ttf
+//  - pixel size: default 32
+//
+// One string that is several work groups long (more than 256 glyphs) is laid out both ways,
+// the quads that the GPU wrote are read back out of the vertex stream, and every vertex is
+// compared.  The pixels and the texture coordinates may be off by a rounding error, because
+// the GPU adds the advances up in a different order, but the colors have to be the same.  The
+// largest difference is printed, and the exit code is 1 if anything is off by more than that.
+// Note: The window is hidden, and nothing is drawn, so this runs anywhere there is an OpenGL
+// 4.3 driver, including a software one such as Mesa's llvmpipe (LIBGL_ALWAYS_SOFTWARE=1 on
+// Linux, or Mesa's opengl32.dll next to the program on Windows).
+// Also Note: The string has kerning in it.  FreeSans has no kerning table, so if the font has
+// no pairs, made-up ones are added to the atlas so that the kerning is still checked.
+//
+// Build note: This is its own project (compute_layout_check.vcxproj) because it has its own
+// main(...).  It needs the same libraries as the demo, and the shaders in the working
+// directory.
+
+#include "glload/include/glload/gl_4_4.h"
+#include "glload/include/glload/gl_load.hpp"
+
+// see main.cpp
+#define FREEGLUT_STATIC
+#define _LIB
+#define FREEGLUT_LIB_PRAGMAS 0
+#include "freeglut/include/GL/freeglut.h"
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#pragma comment(lib, "glload/lib/glloadD.lib")
+#pragma comment(lib, "opengl32.lib")
+#pragma comment(lib, "freeglut/lib/freeglutD.lib")
+#ifdef WIN32
+#pragma comment(lib, "winmm.lib")
+#endif
+#pragma comment (lib, "freetype-2.6.1/objs/vc2010/Win32/freetype261d.lib")
+
+#include "FreeTypeEncapsulate.h"
+#include "FreeTypeAtlas.h"
+#include "AtlasBuilder.h"
+#include "GlyphRasterizer.h"
+#include "GlyphQuads.h"
+#include "GlStateCache.h"
+
+#include <math.h>       // for fabsf(...)
+#include <stdio.h>
+#include <stdlib.h>     // for strtol(...)
+
+#include <algorithm>    // for std::max
+#include <memory>
+#include <string>
+#include <vector>
+
+// how far apart the two layouts' vertices may be
+// Note: The pixels are compared relative to how far the pen has gone, because the further
+// along the string, the more advances have been added up, in a different order on each side.
+static const float PixelTolerance = 1.0e-3f;
+static const float RelativePixelTolerance = 1.0e-5f;
+static const float TexelTolerance = 1.0e-6f;
+
+// the repeated bit of the string: pairs that fonts usually kern, whitespace, punctuation, and
+// a character that isn't in the atlas (the "é"), which neither layout draws, but whose
+// kerning has to go on the glyph before it
+static const char *LinePiece = "AVAWAY To Ty Yo LT F. P, Wa Te \"Va\" caf\xc3\xa9 ";
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Makes an OpenGL 4.4 context with a window that is never shown and loads the OpenGL
+    functions.
+Parameters:
+    argc    From main(...), for freeglut.
+    argv    From main(...), for freeglut.
+Returns:
+    True if the context is good, otherwise false.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static bool CreateHiddenContext(int argc, char *argv[])
+{
+    glutInit(&argc, argv);
+    glutInitDisplayMode(GLUT_DOUBLE | GLUT_ALPHA);
+    glutInitContextVersion(4, 4);
+    glutInitContextProfile(GLUT_CORE_PROFILE);
+    glutInitWindowSize(64, 64);
+    glutCreateWindow(argv[0]);
+    glutHideWindow();
+
+    // glload must load AFTER glut loads the context
+    glload::LoadTest glLoadGood = glload::LoadFunctions();
+    if (!glLoadGood)
+    {
+        fprintf(stderr, "glload::LoadFunctions() failed\n");
+        return false;
+    }
+    if (!glload::IsVersionGEQ(4, 3))
+    {
+        fprintf(stderr, "OpenGL %i.%i has no compute shaders; at least 4.3 is needed\n",
+            glload::GetMajorVersion(), glload::GetMinorVersion());
+        return false;
+    }
+    return true;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Rasterizes the ASCII glyphs and builds an atlas from them, with the font's kerning pairs,
+    or with made-up ones if the font has none.
+Parameters:
+    fontFilePath    The font.
+    fontSize        In pixels.
+    atlas           Gets the atlas.
+Returns:
+    True if the atlas was built, otherwise false.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static bool BuildAtlas(const std::string &fontFilePath, const int fontSize, AtlasImage &atlas)
+{
+    FT_Library library;
+    FT_Face face;
+    if (FT_Init_FreeType(&library))
+    {
+        fprintf(stderr, "Could not init freetype library\n");
+        return false;
+    }
+    if (FT_New_Face(library, fontFilePath.c_str(), 0, &face))
+    {
+        fprintf(stderr, "Could not open font '%s'\n", fontFilePath.c_str());
+        FT_Done_FreeType(library);
+        return false;
+    }
+
+    std::vector<unsigned int> codePoints = AsciiCodePoints();
+    GlyphArena glyphs;
+    RasterizeGlyphs(face, fontSize, codePoints, glyphs);
+    AtlasBuilder builder;
+    GLint maxTextureSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+    bool built = builder.Build(glyphs, (unsigned int)maxTextureSize, atlas);
+    if (built)
+    {
+        // Note: The cell size is left at 0, so there is no glyph cache and no glyph is added
+        // while the string is laid out.  Both layouts see the same atlas.
+        ExtractKerning(face, fontSize, codePoints, atlas.kerningPairs);
+    }
+    FT_Done_Face(face);
+    FT_Done_FreeType(library);
+    if (!built)
+    {
+        fprintf(stderr, "Could not build atlas for font size %d\n", fontSize);
+        return false;
+    }
+
+    if (atlas.kerningPairs.empty())
+    {
+        // a spread of small, uneven amounts between the letters and the punctuation, so that
+        // a kerning that goes on the wrong glyph moves the pen by a different amount
+        printf("'%s' has no kerning pairs, so made-up ones are used\n", fontFilePath.c_str());
+        for (unsigned int left = 33; left < 127; left++)
+        {
+            for (unsigned int right = 33; right < 127; right++)
+            {
+                unsigned int quarters = (left + right) % 7;
+                if ((left * 31 + right) % 3 == 0 && quarters != 0)
+                {
+                    AtlasKerningPair pair = { left, right, -0.25f * (float)quarters };
+                    atlas.kerningPairs.push_back(pair);
+                }
+            }
+        }
+    }
+    return true;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Compares the vertices that the CPU and the GPU laid out.
+Parameters:
+    cpuVertices     From AppendText(...).
+    gpuVertices     From ReadBackTextCompute(...).
+Returns:
+    True if every vertex is within the tolerances, otherwise false.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static bool CompareVertices(const std::vector<TextVertex> &cpuVertices,
+    const std::vector<TextVertex> &gpuVertices)
+{
+    if (cpuVertices.size() != gpuVertices.size())
+    {
+        fprintf(stderr, "the CPU made %u vertices, but the GPU made %u\n",
+            (unsigned int)cpuVertices.size(), (unsigned int)gpuVertices.size());
+        return false;
+    }
+
+    float maxPixelError = 0.0f;
+    float maxTexelError = 0.0f;
+    unsigned int badVertexCount = 0;
+    for (size_t vertexIndex = 0; vertexIndex < cpuVertices.size(); vertexIndex++)
+    {
+        const TextVertex &cpu = cpuVertices[vertexIndex];
+        const TextVertex &gpu = gpuVertices[vertexIndex];
+        float pixelError = std::max(fabsf(cpu.x - gpu.x), fabsf(cpu.y - gpu.y));
+        float texelError = std::max(fabsf(cpu.s - gpu.s), fabsf(cpu.t - gpu.t));
+        float pixelTolerance = PixelTolerance +
+            (RelativePixelTolerance * std::max(fabsf(cpu.x), fabsf(cpu.y)));
+        maxPixelError = std::max(maxPixelError, pixelError);
+        maxTexelError = std::max(maxTexelError, texelError);
+
+        // Note: The comparisons are written so that a NaN fails them.
+        bool good = pixelError <= pixelTolerance && texelError <= TexelTolerance &&
+            cpu.color == gpu.color;
+        if (!good)
+        {
+            // only the first few, so that one bad pen doesn't bury the rest of the output
+            if (badVertexCount < 8)
+            {
+                fprintf(stderr, "glyph %u corner %u: CPU (%g, %g) (%g, %g) 0x%08X, "
+                    "GPU (%g, %g) (%g, %g) 0x%08X\n",
+                    (unsigned int)(vertexIndex / VerticesPerQuad),
+                    (unsigned int)(vertexIndex % VerticesPerQuad), cpu.x, cpu.y, cpu.s, cpu.t,
+                    cpu.color, gpu.x, gpu.y, gpu.s, gpu.t, gpu.color);
+            }
+            badVertexCount++;
+        }
+    }
+
+    printf("%u glyphs, largest difference %g pixels and %g in texture coordinates\n",
+        (unsigned int)(cpuVertices.size() / VerticesPerQuad), maxPixelError, maxTexelError);
+    if (badVertexCount != 0)
+    {
+        fprintf(stderr, "%u of %u vertices are off\n", badVertexCount,
+            (unsigned int)cpuVertices.size());
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    std::string fontFilePath = (argc > 1) ? argv[1] : "FreeSans.ttf";
+    int fontSize = (argc > 2) ? (int)strtol(argv[2], 0, 10) : 32;
+    if (fontSize <= 0)
+    {
+        fprintf(stderr, "Bad pixel size '%s'\n", argv[2]);
+        return 1;
+    }
+
+    if (!CreateHiddenContext(argc, argv))
+    {
+        return 1;
+    }
+
+    FreeTypeEncapsulate ft;
+    GLuint programId = ft.Init("shader.vert", "shader.frag");
+    if (programId == 0 || ft.InitComputeLayoutProgram("shader_layout.comp") == 0)
+    {
+        fprintf(stderr, "Could not build the shader programs\n");
+        return 1;
+    }
+
+    // the atlas sets its sampler uniform on whatever program is in use, like in main.cpp
+    GlStateCache::Current().UseProgram(programId);
+
+    AtlasImage builtAtlas;
+    if (!BuildAtlas(fontFilePath, fontSize, builtAtlas))
+    {
+        return 1;
+    }
+    std::shared_ptr<FreeTypeAtlas> atlas = ft.GenerateAtlas(MakeAtlasImageView(builtAtlas));
+    if (!atlas)
+    {
+        return 1;
+    }
+
+    // a few hundred glyphs, so that there are several work groups, and a pen, a scale, and a
+    // color that aren't round numbers
+    // Note: The viewport size is never set, so AppendText(...) doesn't skip any glyph that
+    // would be off screen, which the compute layout never does either.
+    std::string str;
+    while (str.length() < 3 * 256)
+    {
+        str += LinePiece;
+    }
+    const float posPixels[2] = { 10.25f, 300.5f };
+    const float userScale[2] = { 1.5f, 0.75f };
+    const float color[4] = { 0.25f, 0.5f, 1.0f, 0.75f };
+
+    std::vector<TextVertex> cpuVertices(str.length() * VerticesPerQuad);
+    atlas->BeginBatch();
+    size_t vertexCount = atlas->AppendText(str, posPixels, userScale, PackColor(color),
+        cpuVertices.data(), 0, 0);
+    cpuVertices.resize(vertexCount);
+
+    std::vector<TextVertex> gpuVertices;
+    atlas->ReadBackTextCompute(str, posPixels, userScale, color, gpuVertices);
+
+    GLenum error = glGetError();
+    if (error != GL_NO_ERROR)
+    {
+        fprintf(stderr, "OpenGL error 0x%X\n", error);
+        return 1;
+    }
+    if (vertexCount <= 256 * VerticesPerQuad)
+    {
+        fprintf(stderr, "only %u glyphs were laid out, which is one work group\n",
+            (unsigned int)(vertexCount / VerticesPerQuad));
+        return 1;
+    }
+    if (!CompareVertices(cpuVertices, gpuVertices))
+    {
+        fprintf(stderr, "ComputeLayoutCheck: the layouts don't match\n");
+        return 1;
+    }
+    printf("ComputeLayoutCheck: the layouts match\n");
+    return 0;
+}
@@ -0,0 +1,291 @@
+#include "DistanceField.h"
+
+#include <math.h>       // for sqrtf(...)
+
+#include <algorithm>    // for std::min, std::max
+#include <atomic>       // for handing out glyphs to the worker threads
+#include <thread>
+
+// stands in for "infinitely far away"
+// Note: Not actually infinity because the transform subtracts these from each other, and
+// infinity minus infinity is NaN.
+static const float FarAway = 1e20f;
+
+// everything that one worker needs for one glyph, kept between glyphs so that the buffers
+// only grow a few times instead of being allocated for every glyph
+struct DistanceFieldScratch
+{
+    std::vector<float> distanceToInside;
+    std::vector<float> distanceToOutside;
+
+    // for the 1D transform (see DistanceTransform1D(...))
+    std::vector<float> line;
+    std::vector<float> lineDistances;
+    std::vector<int> parabolaVertices;
+    std::vector<float> parabolaBoundaries;
+};
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    The 1D squared Euclidean distance transform from Felzenszwalb and Huttenlocher, "Distance
+    Transforms of Sampled Functions" (2012).  Every sample is the bottom of a parabola, the
+    lower envelope of all of the parabolas is found in one pass, and then it is read back out
+    in a second pass.  That makes it linear in the number of samples, unlike the brute force
+    search, which is quadratic.
+Parameters:
+    f           Squared distances along the line: 0 for a sample that is on the feature and
+                FarAway for one that isn't, or the result of a transform along the other axis.
+    count       How many samples there are in f.
+    d           Gets the squared distance from each sample to the nearest feature.
+    v, z        Scratch; room for count and count + 1 items.
+Returns:    None
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static void DistanceTransform1D(const float *f, const int count, float *d, int *v, float *z)
+{
+    int k = 0;
+    v[0] = 0;
+    z[0] = -FarAway;
+    z[1] = +FarAway;
+    for (int q = 1; q < count; q++)
+    {
+        // where the new parabola crosses the rightmost one in the envelope
+        float s = ((f[q] + (float)(q * q)) - (f[v[k]] + (float)(v[k] * v[k]))) /
+            (float)(2 * q - 2 * v[k]);
+        while (s <= z[k])
+        {
+            // the new parabola hides that one completely
+            k--;
+            s = ((f[q] + (float)(q * q)) - (f[v[k]] + (float)(v[k] * v[k]))) /
+                (float)(2 * q - 2 * v[k]);
+        }
+        k++;
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = +FarAway;
+    }
+
+    k = 0;
+    for (int q = 0; q < count; q++)
+    {
+        while (z[k + 1] < (float)q)
+        {
+            k++;
+        }
+        float offset = (float)(q - v[k]);
+        d[q] = (offset * offset) + f[v[k]];
+    }
+}
+
+// The 2D transform is separable: one pass down every column and then one pass along every
+// row gives the exact squared distance to the nearest feature pixel.
+static void DistanceTransform2D(std::vector<float> &grid, const int width, const int height,
+    DistanceFieldScratch &scratch)
+{
+    int longestLine = std::max(width, height);
+    scratch.line.resize(longestLine);
+    scratch.lineDistances.resize(longestLine);
+    scratch.parabolaVertices.resize(longestLine);
+    scratch.parabolaBoundaries.resize(longestLine + 1);
+
+    float *line = scratch.line.data();
+    float *lineDistances = scratch.lineDistances.data();
+    int *v = scratch.parabolaVertices.data();
+    float *z = scratch.parabolaBoundaries.data();
+
+    for (int x = 0; x < width; x++)
+    {
+        for (int y = 0; y < height; y++)
+        {
+            line[y] = grid[(y * width) + x];
+        }
+        DistanceTransform1D(line, height, lineDistances, v, z);
+        for (int y = 0; y < height; y++)
+        {
+            grid[(y * width) + x] = lineDistances[y];
+        }
+    }
+
+    // rows are contiguous, so they can be transformed without copying them out first
+    for (int y = 0; y < height; y++)
+    {
+        float *row = grid.data() + (y * width);
+        DistanceTransform1D(row, width, lineDistances, v, z);
+        std::copy(lineDistances, lineDistances + width, row);
+    }
+}
+
+// the size of a glyph's distance field, in atlas pixels, including the border on both sides
+static unsigned int FieldSize(const unsigned int supersampledSize,
+    const DistanceFieldSettings &settings)
+{
+    if (supersampledSize == 0)
+    {
+        // nothing to draw (ex: a space), so don't give it a border to draw either
+        return 0;
+    }
+
+    return ((supersampledSize + settings.supersample - 1) / settings.supersample) +
+        (2 * settings.spread);
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Turns one supersampled coverage bitmap into a distance field.  The bitmap is centered in a
+    grid that is big enough for the border and that is a whole number of atlas pixels across,
+    the distance from every grid pixel to the glyph's edge is found in both directions, and
+    then each block of supersample x supersample grid pixels is averaged into one atlas pixel.
+Parameters:
+    coverage        The supersampled bitmap, tightly packed.
+    width, rows     The supersampled bitmap's dimensions.
+    settings        Spread and supersample factor.
+    scratch         The worker's buffers.
+    field           Gets the distance field; it must have room for FieldSize(width) x
+                    FieldSize(rows) pixels.
+Returns:    None
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static void MakeDistanceField(const unsigned char *coverage, const unsigned int width,
+    const unsigned int rows, const DistanceFieldSettings &settings,
+    DistanceFieldScratch &scratch, unsigned char *field)
+{
+    const int supersample = (int)settings.supersample;
+    const int fieldWidth = (int)FieldSize(width, settings);
+    const int fieldRows = (int)FieldSize(rows, settings);
+    const int gridWidth = fieldWidth * supersample;
+    const int gridRows = fieldRows * supersample;
+    const int border = (int)settings.spread * supersample;
+
+    // a pixel that is at least half covered is inside the glyph
+    // Note: The distance to the inside is 0 for inside pixels, and likewise for the outside.
+    const unsigned char insideCoverage = 128;
+    scratch.distanceToInside.assign(gridWidth * gridRows, FarAway);
+    scratch.distanceToOutside.assign(gridWidth * gridRows, 0.0f);
+    for (unsigned int row = 0; row < rows; row++)
+    {
+        const unsigned char *coverageRow = coverage + (row * width);
+        size_t gridRowStart = ((row + border) * gridWidth) + border;
+        for (unsigned int column = 0; column < width; column++)
+        {
+            if (coverageRow[column] >= insideCoverage)
+            {
+                scratch.distanceToInside[gridRowStart + column] = 0.0f;
+                scratch.distanceToOutside[gridRowStart + column] = FarAway;
+            }
+        }
+    }
+
+    DistanceTransform2D(scratch.distanceToInside, gridWidth, gridRows, scratch);
+    DistanceTransform2D(scratch.distanceToOutside, gridWidth, gridRows, scratch);
+
+    // Both distances are measured between pixel centers, but the edge is halfway between an
+    // inside pixel and an outside pixel, so pull both of them in by half a pixel.  Exactly one
+    // of the two is 0 for any pixel.
+    // Also Note: The result is in atlas pixels, positive outside of the glyph, and it is
+    // stored so that 0.5 (128) is the edge, 1.0 (255) is "spread" pixels inside of it, and
+    // 0.0 is "spread" pixels outside of it.
+    const float gridPixelsPerAtlasPixel = (float)supersample;
+    const float encodeScale = 1.0f / (2.0f * (float)settings.spread);
+    const float blockArea = (float)(supersample * supersample);
+    for (int fieldY = 0; fieldY < fieldRows; fieldY++)
+    {
+        for (int fieldX = 0; fieldX < fieldWidth; fieldX++)
+        {
+            float distanceSum = 0.0f;
+            for (int blockY = 0; blockY < supersample; blockY++)
+            {
+                size_t gridIndex =
+                    (((fieldY * supersample) + blockY) * gridWidth) + (fieldX * supersample);
+                for (int blockX = 0; blockX < supersample; blockX++, gridIndex++)
+                {
+                    float toInside = scratch.distanceToInside[gridIndex];
+                    float toOutside = scratch.distanceToOutside[gridIndex];
+                    distanceSum += (toInside > 0.0f) ?
+                        (sqrtf(toInside) - 0.5f) : -(sqrtf(toOutside) - 0.5f);
+                }
+            }
+
+            float distance = distanceSum / (blockArea * gridPixelsPerAtlasPixel);
+            float encoded = std::min(std::max(0.5f - (distance * encodeScale), 0.0f), 1.0f);
+            field[(fieldY * fieldWidth) + fieldX] = (unsigned char)((encoded * 255.0f) + 0.5f);
+        }
+    }
+}
+
+void MakeDistanceFields(const GlyphArena &supersampledGlyphs,
+    const DistanceFieldSettings &settings, const unsigned int threadCount, GlyphArena &arena)
+{
+    const float supersample = (float)settings.supersample;
+    const float border = (float)settings.spread;
+
+    // decide every glyph's metrics and where its field goes before any work starts so that
+    // the workers can write straight into the arena without stepping on each other
+    size_t firstGlyph = arena.glyphs.size();
+    size_t pixelCount = arena.pixels.size();
+    for (size_t glyphIndex = 0; glyphIndex < supersampledGlyphs.glyphs.size(); glyphIndex++)
+    {
+        const RasterizedGlyph &supersampledGlyph = supersampledGlyphs.glyphs[glyphIndex];
+
+        // Note: The border pushes the bitmap's top left corner up and to the left.
+        RasterizedGlyph glyph = supersampledGlyph;
+        glyph.ax = supersampledGlyph.ax / supersample;
+        glyph.ay = supersampledGlyph.ay / supersample;
+        glyph.width = FieldSize(supersampledGlyph.width, settings);
+        glyph.rows = FieldSize(supersampledGlyph.rows, settings);
+        glyph.bl = (supersampledGlyph.bl / supersample) -
+            ((glyph.width == 0) ? 0.0f : border);
+        glyph.bt = (supersampledGlyph.bt / supersample) +
+            ((glyph.rows == 0) ? 0.0f : border);
+        glyph.pixelOffset = pixelCount;
+        pixelCount += glyph.width * glyph.rows;
+        arena.glyphs.push_back(glyph);
+    }
+    arena.pixels.resize(pixelCount);
+
+    unsigned int workerCount = threadCount;
+    if (workerCount == 0)
+    {
+        // hardware_concurrency() is allowed to return 0 if it can't tell
+        workerCount = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    workerCount = (unsigned int)std::min((size_t)workerCount,
+        supersampledGlyphs.glyphs.size());
+
+    std::atomic<size_t> nextGlyph(0);
+    auto worker = [&]()
+    {
+        DistanceFieldScratch scratch;
+        size_t glyphCount = supersampledGlyphs.glyphs.size();
+        for (size_t glyphIndex = nextGlyph++; glyphIndex < glyphCount; glyphIndex = nextGlyph++)
+        {
+            const RasterizedGlyph &supersampledGlyph = supersampledGlyphs.glyphs[glyphIndex];
+            const RasterizedGlyph &glyph = arena.glyphs[firstGlyph + glyphIndex];
+            if (glyph.width == 0 || glyph.rows == 0)
+            {
+                continue;
+            }
+
+            MakeDistanceField(supersampledGlyphs.pixels.data() + supersampledGlyph.pixelOffset,
+                supersampledGlyph.width, supersampledGlyph.rows, settings, scratch,
+                arena.pixels.data() + glyph.pixelOffset);
+        }
+    };
+
+    if (workerCount <= 1)
+    {
+        // a single glyph that was asked for on demand doesn't need a thread
+        worker();
+        return;
+    }
+
+    std::vector<std::thread> workers;
+    workers.reserve(workerCount);
+    for (unsigned int workerIndex = 0; workerIndex < workerCount; workerIndex++)
+    {
+        workers.push_back(std::thread(worker));
+    }
+    for (size_t workerIndex = 0; workerIndex < workers.size(); workerIndex++)
+    {
+        workers[workerIndex].join();
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+// for the glyphs that go in and come out
+// Note: Nothing in here needs FreeType either, so the distance fields can be made from any
+// coverage bitmaps.
+#include "GlyphArena.h"
+
+// how the glyphs of a signed distance field atlas are made
+// Note: A regular atlas stores how much of each pixel the glyph covers, so it only looks right
+// at (or near) the size that it was rasterized at; scaled up it blurs, scaled down it aliases.
+// A distance field atlas stores how far each pixel is from the glyph's edge instead, and
+// distances interpolate well, so the fragment shader (shader_sdf.frag) can find a sharp edge
+// at any scale.  One small atlas then covers every size that the program draws at.
+struct DistanceFieldSettings
+{
+    // how far, in atlas pixels, the field reaches out from (and into) the glyph's edge
+    // Note: This is also the border that every glyph gets so that the field has room to fall
+    // off.  0 means "no distance field", which is a plain coverage atlas.
+    unsigned int spread;
+
+    // glyphs are rasterized this many times bigger than the atlas' font size and the distances
+    // are worked out at that resolution, which puts the edge within a fraction of an atlas
+    // pixel instead of wherever FreeType's anti-aliasing happened to round it to
+    unsigned int supersample;
+};
+
+// takes: glyphs that were rasterized at "supersample" times the atlas' font size
+// Note: Every glyph is turned into a distance field of the atlas' font size, with a border
+// of "spread" pixels on each side, and appended to the arena in the same order.  Metrics are
+// scaled down to match.
+// Also Note: The glyphs are independent of each other, so they are handed out to a pool of
+// worker threads.  Every glyph's spot in the arena is decided before the threads start, so
+// the arena is byte-for-byte the same no matter how the threads were scheduled.
+// Also Also Note: A thread count of 0 means "one per hardware thread".
+void MakeDistanceFields(const GlyphArena &supersampledGlyphs,
+    const DistanceFieldSettings &settings, const unsigned int threadCount, GlyphArena &arena);
@@ -1,174 +1,218 @@
 #include "FreeTypeAtlas.h"
+#include "AtlasImage.h"
+#include "Utf8.h"
+
+// for spacing the glyph cache's cells out like the prebuilt glyphs and for filling in the 
+// smaller mip levels
+#include "AtlasMipmaps.h"
+
+// for the glyphs' quads and the indices that draw them
+#include "GlyphQuads.h"
+#include "QuadIndexBuffer.h"
+
+// for writing vertices straight into GPU memory
+#include "StreamBuffer.h"
+
+// for skipping OpenGL calls that wouldn't change anything
+#include "GlStateCache.h"
 
 // the OpenGL version include also includes all previous versions
 // Build note: Do NOT mistakenly include _int_gl_4_4.h.  That one doesn't define OpenGL stuff 
 // first.
 #include "glload/include/glload/gl_4_4.h"
 
-// Build note: Must be included after OpenGL code (in this case, glload).
-// Build note: Also need to link freeglut/lib/freeglutD.lib.  However, the linker will try to 
-// find "freeglut.lib" (note the lack of "D") instead unless the following preprocessor 
-// directives are set either here or in the source-building command line (VS has a
-// "Preprocessor" section under "C/C++" for preprocessor definitions).  This is true for every
-// source file that wants to use freeglut, so the source-building command line is a useful tool.
-// However, since this is bare bones and attempts to avoid any VS-specific project stuff or
-// solution stuff, I am taking the verbose path.
-#define FREEGLUT_STATIC
-#define _LIB
-#define FREEGLUT_LIB_PRAGMAS 0
-#include "freeglut/include/GL/freeglut.h"
-
-#include <algorithm>    // for std::max
+// Note: The atlas used to ask freeglut for the window's size on every draw.  Text is now laid
+// out in pixels, and only the shader knows the window's size (see
+// FreeTypeEncapsulate::SetViewportSize(...)), so the atlas doesn't need freeglut at all.
+
+#include <math.h>       // for floorf(...), ceilf(...)
+#include <stddef.h>     // for offsetof(...)
+#include <stdio.h>      // for fprintf(...)
+#include <string.h>     // for memcpy(...), memset(...)
+
+#include <algorithm>    // for std::max, std::min
 #include <vector>       // for memory safe allocation of coordinate info for each glyph
 
-struct point {
-    GLfloat x;
-    GLfloat y;
-    GLfloat s;
-    GLfloat t;
+// how many glyphs outside of the prebuilt set the atlas starts out with room for
+// Note: More than that and the atlas grows (see GrowAtlas()) until the texture is as tall as 
+// OpenGL allows, after which the least recently used ones are evicted.
+static const unsigned int DynamicGlyphCapacity = 128;
+
+// keep the cache's grid from becoming a tall, thin column when the prebuilt set is small
+static const unsigned int MinCellColumns = 16;
+
+// glyphs per work group in the compute layout
+// Note: Must match local_size_x in shader_layout.comp.
+static const unsigned int LayoutGroupSize = 256;
+
+// OpenGL only promises 65535 work groups in a dispatch, so that is as long as a string that is
+// laid out on the GPU can be
+static const size_t MaxComputeLayoutGlyphs = 65535 * LayoutGroupSize;
+
+// what the compute layout gets for each glyph of a string
+// Note: Must match LayoutGlyph in shader_layout.comp.  The kerning goes with the glyph before
+// the pair, so that adding up the advances adds it in too.
+struct LayoutGlyph
+{
+    unsigned int tableIndex;
+    float kerningAfter;
 };
 
-FreeTypeAtlas::FreeTypeAtlas(const int uniformTextSamplerLoc, const int uniformTextColorLoc) :
+// the texture parameters that every atlas texture gets (see FinishUpload(...))
+// Note: With mipmaps, minified text is filtered trilinearly: linearly within the two nearest 
+// levels and then linearly between them, so text that is shrinking smoothly doesn't pop 
+// from one level to the next.  GL_TEXTURE_MAX_LEVEL has to match the levels that were 
+// actually uploaded or else OpenGL considers the texture incomplete and samples black.
+static void SetAtlasTextureParameters(const unsigned int mipLevels)
+{
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, 
+        (mipLevels > 1) ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)mipLevels - 1);
+}
+
+// rounds a size up to the next multiple of the (power of 2) mip alignment
+static unsigned int AlignUp(const unsigned int size, const unsigned int alignment)
+{
+    return (size + alignment - 1) & ~(alignment - 1);
+}
+
+// the smallest size that is a multiple of both
+// Note: Euclid's algorithm finds the greatest common divisor, and what is left of one after
+// dividing that out is what the other one needs to be multiplied by.
+static size_t LeastCommonMultiple(const size_t first, const size_t second)
+{
+    size_t a = first;
+    size_t b = second;
+    while (b != 0)
+    {
+        size_t remainder = a % b;
+        a = b;
+        b = remainder;
+    }
+    return (first / a) * second;
+}
+
+FreeTypeAtlas::FreeTypeAtlas(const int uniformTextSamplerLoc) :
+    _atlasWidth(0),
+    _atlasHeight(0),
+    _mipLevels(1),
+    _maxTextureSize(0),
+    _cellOriginY(0),
+    _cellWidth(0),
+    _cellHeight(0),
+    _cellColumns(0),
+    _renderStamp(0),
+    _layoutGeneration(0),
     _uniformTextSamplerLoc(uniformTextSamplerLoc),
-    _uniformTextColorLoc(uniformTextColorLoc)
+    _prebuiltGlyphCount(0),
+    _glyphTableDirtyBegin(0),
+    _glyphTableDirtyEnd(0),
+    _glyphTableGpuEntries(0),
+    _glyphTableSsboId(0),
+    _vaoId(0),
+    _vaoStreamGeneration(0),
+    _instancedVaoId(0),
+    _instancedVaoStreamGeneration(0),
+    _instancedUniformTextSamplerLoc(0),
+    _blockAdvanceSsboId(0),
+    _blockAdvanceCapacity(0),
+    _storageBufferAlignment(1),
+    _viewportWidth(0),
+    _viewportHeight(0),
+    _hasClipRect(false),
+    _scissorClip(false),
+    _cullEnabled(false),
+    _advancesOnlyRight(true)
 {
     // clear out the character memory to all 0s (standard practice for arrays)
-    memset(_glyphCharInfo, 0, sizeof(_glyphCharInfo));
-}
-
-bool FreeTypeAtlas::Init(const FT_Face face, const int fontPixelHeightSize)
-{
-    // configure the font's size
-    // Note: Setting the pixel width (middle argument) to 0 lets FreeType determine font width 
-    // based on the provided height.
-    // http://learnopengl.com/#!In-Practice/Text-Rendering
-    FT_Set_Pixel_Sizes(face, 0, fontPixelHeightSize);
-
-    // save some dereferencing
-    FT_GlyphSlot glyph = face->glyph;
-
-    // before I begin...
-    // A texture atlas means that a bunch of different images are loaded into the same texture.  
-    // In many applications, such as games with sprites, the textures are all the same size, so 
-    // it is rather easy to make a perfect grid.  TrueType fonts are not so pretty for nice 
-    // grids, but when rendered properly they look very nice, so I'm willing to jump through 
-    // some hoops when loading them.  The characters in TrueType fonts are not the same size 
-    // because each character is designed individually and has its own dimensions.  To load 
-    // these into an atlas, I am going to run through all the characters and calculate how much 
-    // space will be required to load them side-by-side, but be aware that this row of 
-    // characters will be of uneven height (not all characters are the same height) and may run 
-    // up against the maximum byte width of a texture.  Then I'll allocate the bytes necessary 
-    // for a texture to hold all the character's glyphs, and finally I'll load them all 
-    // side-by-side in the same order as when I calculated the required texture size.
-
-    // The GL standard defines a maximum size (in bytes) for textures.  This affects 1D and 2D 
-    // textures (I've been told that 3D textures have their own max values).  1D is just a line, 
-    // so it only applies to that one dimension.  For 2D textures, the max size applies to both 
-    // width and height.  This value is determined by the graphics API.  I checked this program
-    // (on 3-29-2016), and at this time OpenGL is telling me that my max texture size is 16384 
-    // bytes.  This means that I have 16384 bytes for width and 16384 bytes for height, and I 
-    // doubt that I am going to max out either with this FreeType library, although if font size (??font size -> bitmap size??)
-    // became enormous I might need to start a second row.  But while the GL standard does not 
-    // tell the graphics API an upper limit, it does tell them a lower limit for this max value, 
-    // which I believe is 1024 bytes.  That is, OpenGL is free to specify that a maximum texture 
-    // size is 16kb, or 32kb, or whatever, but the max texture size must not be below 1024 
-    // bytes, which should be sufficient to support rather old video or just incapable video 
-    // hardware.  A max size of 1024 bytes means that a 2D texture can 1024x1024 bytes, or 
-    // 1024x512 bytes, or 2x1024 (yes, 2 bytes), and it would be okay.  
+    memset(_asciiGlyphCharInfo, 0, sizeof(_asciiGlyphCharInfo));
+    memset(&_computeLayout, 0, sizeof(_computeLayout));
+    memset(&_packReport, 0, sizeof(_packReport));
+    memset(&_compressionReport, 0, sizeof(_compressionReport));
+    memset(&_clipRect, 0, sizeof(_clipRect));
+    memset(&_cullRect, 0, sizeof(_cullRect));
+    memset(&_glyphExtents, 0, sizeof(_glyphExtents));
+}
+
+bool FreeTypeAtlas::Init(const AtlasImageView &atlas, const GlyphSource &glyphSource, 
+    const bool compress)
+{
+    _glyphSource = glyphSource;
+    _packReport = atlas.packReport;
+
+    if (compress)
+    {
+        // there is nowhere to put glyphs on demand
+        _glyphSource = nullptr;
+        return UploadCompressedAtlas(atlas);
+    }
+
+    return UploadAtlas(atlas);
+}
+
+bool FreeTypeAtlas::UploadAtlas(const AtlasImageView &atlas)
+{
     GLint maxTextureSizeBytes;
     glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSizeBytes);
-
-    // for FreeType fonts under default rendering, 1 pixel == 1 byte
-    // Note: FreeType 2 (the header indicates that I am using 2.6.1 as of 3-29-2016) does not 
-    // provide RGB data for a texture, but it does provide monochrome (1-bit) or 8-bit greyscale 
-    // bitmaps.  
-    // http://www.freetype.org/freetype2/docs/ft2faq.html#general-donts
-    // Also Note: When loading a glyph, I use FT_LOAD_RENDER, which causes a character's glyph 
-    // to be loaded from the TrueType file into a small bitmap in the default render mode.  
-    // http://www.freetype.org/freetype2/docs/reference/ft2-base_interface.html#FT_LOAD_RENDER
-    // Also Also Note: The default render mode loads an 8-bit greyscale bitmap with 256 levels 
-    // of opacity (2^8) (implicitly, this means 256 levels of opacity per pixel).  "Use linear 
-    // alpha blending and gamma correction to correctly render non-monochrome glyph bitmaps onto 
-    // a surface." (alpha blending is activated in the "render text" method) This means that 
-    // there is one 8-bit byte per pixel.  Keep this in mind when calculating the texture size.  
-    // http://www.freetype.org/freetype2/docs/reference/ft2-base_interface.html#FT_Render_Mode
-
-
-    // build up the dimensions for the atlas, then make a texture for it later
-    // Note: Not only are the dimensions needed before allocating space for the texture, but in 
-    // loading up these dimensions BEFORE creating the texture, I can make sure sure that all the
-    // characters load (that is, check that FT_Load_Char(...) does not return errors).
-    // Also Note: The row width builds additively with each glyph, but the row height is only the 
-    // height of the tallest glyph.
-    // Also Also Note:??mention max texture size??
-    //??why restrict to a max width? trying to mimic the actual bitmap layout??
-    unsigned int atlasPixelWidth = 0;
-    unsigned int atlasPixelHeight = 0;
-    unsigned int rowPixelWidth = 0;
-    unsigned int rowPixelHeight = 0;
-
-    // load only the visible characters of the basic ASCII set
-    // Note: The basic set is 2^7 = 128 items, and the first 32 are non-printable, so skip them.
-    for (size_t charCode = 32; charCode < 128; charCode++)
-    {
-        if (FT_Load_Char(face, charCode, FT_LOAD_RENDER))
+    _maxTextureSize = (unsigned int)maxTextureSizeBytes;
+
+    // Glyphs that aren't in the prebuilt set are rasterized the first time that they are drawn 
+    // and go into a grid of cells underneath the packed glyphs (see GlyphCache.h).
+    // Note: With mipmaps, the cells are spaced out and lined up just like the packed glyphs 
+    // (see AtlasBuilder::SetPadding(...)) so that they don't bleed into each other either.  
+    // Each cell already has 1 pixel of gutter, so it needs alignment - 1 more.
+    _mipLevels = std::max(atlas.mipLevels, 1u);
+    const unsigned int alignment = MipAlignment(_mipLevels);
+    _atlasWidth = atlas.width;
+    _atlasHeight = atlas.height;
+    _cellOriginY = AlignUp(atlas.height, alignment);
+    _cellWidth = (atlas.cellWidth == 0) ? 0 : 
+        AlignUp(atlas.cellWidth + alignment - 1, alignment);
+    _cellHeight = (atlas.cellHeight == 0) ? 0 : 
+        AlignUp(atlas.cellHeight + alignment - 1, alignment);
+    unsigned int cellCount = 0;
+    if (_glyphSource && _cellWidth != 0 && _cellHeight != 0)
+    {
+        _cellColumns = std::max(atlas.width / _cellWidth, MinCellColumns);
+        unsigned int cellRows = (DynamicGlyphCapacity + _cellColumns - 1) / _cellColumns;
+
+        // Note: The prebuilt glyphs, once they are rounded up to the mip alignment, can take up
+        // the whole height (or more, for an atlas that was baked for a bigger maximum), and
+        // then the room that is left would wrap around to a huge number of rows.
+        unsigned int roomRows = (_cellOriginY < _maxTextureSize) ?
+            (_maxTextureSize - _cellOriginY) / _cellHeight : 0;
+        cellRows = std::min(cellRows, roomRows);
+        if (cellRows == 0)
         {
-            fprintf(stderr, "Loading character '%c' failed\n", charCode);
-            continue;
+            // like a compressed atlas, only the prebuilt glyphs can be drawn
+            fprintf(stderr, "No room for the glyph cache below the prebuilt glyphs\n");
+            _glyphSource = nullptr;
         }
-
-        // if this glyph would make this row's width exceed the max allowable texture size, 
-        // start a new row
-        // Note: Remember that FreeType provides an 8-bit alpha bitmap, so in this particular 
-        // application, each pixel is 1 byte and pixels and bytes can be compared.
-        // Also Note: The "+1" is a 1-pixel "gutter" between characters in case some kind of 
-        // float rounding at render time (specifically, calculating texture coordinates S and 
-        // T, each by definition on the range [0.0,1.0]) goes 1 pixel further than it should.  
-        // This 1-pixel "gutter" prevents that 1 pixel from infringing on the edges of another 
-        // glyph.
-        // Also Also Note: The unsigned integer cast is to prevent a compiler warning.  Because 
-        // I'm picky that way :).
-        if ((rowPixelWidth + glyph->bitmap.width + 1) >= (unsigned int)maxTextureSizeBytes)
+        else
         {
-            // if this row is longer than any previous row, expand the atlas
-            // Note: Since this only happens if the next glyph will make the row exceed the max 
-            // allowable texture width, the difference between the two will probably only be a 
-            // handful of pixels, but these calculations need to be exact to look right.
-            atlasPixelWidth = std::max(atlasPixelWidth, rowPixelWidth);
-
-            // row height has already been calculated, so just add it
-            atlasPixelHeight += rowPixelHeight;
-
-            // reset row width and height before starting the new row
-            rowPixelWidth = 0;
-            rowPixelHeight = 0;
-        }
+            cellCount = cellRows * _cellColumns;
 
-        // expand the row's width by the width of this character's glyph + the 1-pixel "gutter"
-        rowPixelWidth += glyph->bitmap.width + 1;
+            _atlasWidth = std::max(atlas.width, _cellColumns * _cellWidth);
+            _atlasHeight = _cellOriginY + (cellRows * _cellHeight);
 
-        // if the current glyph is taller than any other glyph in the row, accomodate it
-        // Note: Yes, this means that there will be wasted bytes, but unless I used some kind of 
-        // fancy closest-packing algorithm I am going to have wasted bytes.  But bytes are cheap 
-        // (for PCs, at least), so I'm willing to waste some bytes if it means that atlas 
-        // loading will be easier.
-        rowPixelHeight = std::max(rowPixelHeight, glyph->bitmap.rows);
+            // a glyph that hasn't been rasterized yet could be anywhere within a cell of its
+            // pen (see PastCullRect(...))
+            PixelRect anyCachedGlyph = { -(float)_cellWidth, -(float)_cellHeight,
+                (float)_cellWidth, (float)_cellHeight };
+            _glyphExtents = anyCachedGlyph;
+        }
     }
-
-    // when the above loop exits, it will have adjusted the variables for the last row's width 
-    // and height, but not for atlas width and height, so take care of the atlas width and 
-    // height the same way as it happens when a new row is created
-    atlasPixelWidth = std::max(atlasPixelWidth, rowPixelWidth);
-    atlasPixelHeight += rowPixelHeight;
+    _glyphCache.Init(cellCount);
 
     // must have already created AND BOUND a program for this to work
     glGenTextures(1, &_textureId);
-    glBindTexture(GL_TEXTURE_2D, _textureId);
-
-    // allocate space for the texture in GPU memory
-    // Note: This is why "atlas width" and "atlas height" had to be computed beforehand.
+    GlStateCache::Current().BindTexture(GL_TEXTURE_2D, _textureId);
 
-    // some kind of detail thing; leave at default of 0
+    // the mip level; 0 is the full size atlas, and the smaller ones are made from it below
     GLint level = 0;
 
     // tell OpenGL that it should store the data as alpha values (no RGB)
@@ -200,397 +244,1262 @@ bool FreeTypeAtlas::Init(const FT_Face face, const int fontPixelHeightSize)
     // unsigned byte (8 bits) can specify 2^8 = 256 (0 - 255) different values.  This is 
     // good enough for what FreeType is trying to draw.  OpenGL compensates for the byte by
     // dividing it by 256 to get it on the range [0.0, 1.0].  
-    // Also Note: Some file formats provide data as sets of floats, in which case this type
-    // would be GL_FLOAT.
     GLenum providedFormatDataType = GL_UNSIGNED_BYTE;
 
     // no border (??units? how does this work? play with it??)
     GLint border = 0;
 
-    // the 0 (null (void *) pointer) at the end tells OpenGL that no data is provided for the 
-    // texture right now, so it should only allocate the required memory for now
-    glTexImage2D(GL_TEXTURE_2D, level, internalFormat, atlasPixelWidth, atlasPixelHeight,
-        border, providedFormat, providedFormatDataType, 0);
+    // OpenGL assumes by default that each row of pixel data starts on a 4-byte boundary, but 
+    // the atlas' rows are tightly packed 1-byte pixels, so tell it that rows can start anywhere
+    // Note: This must be set BEFORE the upload or any atlas whose width is not a multiple of 4
+    // will come out sheared.
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    if (_atlasWidth == atlas.width && _atlasHeight == atlas.height)
+    {
+        // the whole atlas was already assembled in CPU memory, so allocate the texture and 
+        // fill it in the same call
+        glTexImage2D(GL_TEXTURE_2D, level, internalFormat, _atlasWidth, _atlasHeight,
+            border, providedFormat, providedFormatDataType, atlas.pixels);
+    }
+    else
+    {
+        // The texture is bigger than the packed glyphs because of the glyph cache's cells, so 
+        // allocate it empty, zero it on the GPU so that the empty cells start out transparent, 
+        // and then send the packed glyphs straight from wherever they are (possibly a memory-
+        // mapped cache file) into the top of the texture.  This avoids making a padded, 
+        // full-size copy of the atlas in CPU memory just for the upload.
+        // Note: glClearTexImage(...) is OpenGL 4.4, which is what the program asks for.
+        glTexImage2D(GL_TEXTURE_2D, level, internalFormat, _atlasWidth, _atlasHeight,
+            border, providedFormat, providedFormatDataType, 0);
+        unsigned char zero = 0;
+        glClearTexImage(_textureId, level, providedFormat, providedFormatDataType, &zero);
+        glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, atlas.width, atlas.height, providedFormat, 
+            providedFormatDataType, atlas.pixels);
+    }
 
+    // The smaller levels are made here rather than with glGenerateMipmap(...) because the 
+    // driver is free to filter however it likes, and that may reach across the gutters.  Each 
+    // level comes from the one above it, the same way as the cells do (see CacheGlyph(...)), 
+    // and the whole texture is a multiple of the alignment, so each level is exactly half of 
+    // the one above it.
+    std::vector<unsigned char> levelPixels;
+    std::vector<unsigned char> halvedPixels;
+    const unsigned char *packedPixels = atlas.pixels;
+    unsigned int packedWidth = atlas.width;
+    unsigned int packedHeight = atlas.height;
+    for (level = 1; level < (GLint)_mipLevels; level++)
+    {
+        DownsampleCoverage(packedPixels, packedWidth, packedHeight, halvedPixels);
+        levelPixels.swap(halvedPixels);
+        packedPixels = levelPixels.data();
+        packedWidth = std::max(packedWidth / 2, 1u);
+        packedHeight = std::max(packedHeight / 2, 1u);
+
+        unsigned int levelWidth = std::max(_atlasWidth >> level, 1u);
+        unsigned int levelHeight = std::max(_atlasHeight >> level, 1u);
+        if (levelWidth == packedWidth && levelHeight == packedHeight)
+        {
+            glTexImage2D(GL_TEXTURE_2D, level, internalFormat, levelWidth, levelHeight,
+                border, providedFormat, providedFormatDataType, packedPixels);
+        }
+        else
+        {
+            glTexImage2D(GL_TEXTURE_2D, level, internalFormat, levelWidth, levelHeight,
+                border, providedFormat, providedFormatDataType, 0);
+            unsigned char zero = 0;
+            glClearTexImage(_textureId, level, providedFormat, providedFormatDataType, &zero);
+            glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, packedWidth, packedHeight, 
+                providedFormat, providedFormatDataType, packedPixels);
+        }
+    }
+
+    return FinishUpload(atlas);
+}
+
+bool FreeTypeAtlas::UploadCompressedAtlas(const AtlasImageView &atlas)
+{
+    // Compressed textures can only be written a whole block at a time, and only with blocks 
+    // that were compressed ahead of time, so the glyph cache's cells, which are written one 
+    // glyph at a time, are out.  The texture is just the prebuilt glyphs, rounded up to whole 
+    // blocks.
+    std::vector<unsigned char> blocks;
+    CompressBc4(atlas.pixels, atlas.width, atlas.height, blocks, _compressionReport);
+    _atlasWidth = (atlas.width + 3) & ~3u;
+    _atlasHeight = (atlas.height + 3) & ~3u;
+    _mipLevels = 1;
+    _cellOriginY = _atlasHeight;
+    _cellWidth = 0;
+    _cellHeight = 0;
+    _glyphCache.Init(0);
+
+    glGenTextures(1, &_textureId);
+    GlStateCache::Current().BindTexture(GL_TEXTURE_2D, _textureId);
+
+    // Note: GL_COMPRESSED_RED_RGTC1 is core as of OpenGL 3.0, and like GL_RED, it ends up in 
+    // the red channel, so the shaders don't need to change.
+    // Also Note: Only the full size level is uploaded, even if the atlas was spaced out for 
+    // mipmaps; the smaller levels would each need to be compressed too.
+    GLint level = 0;
+    GLint border = 0;
+    glCompressedTexImage2D(GL_TEXTURE_2D, level, GL_COMPRESSED_RED_RGTC1, _atlasWidth, 
+        _atlasHeight, border, (GLsizei)blocks.size(), blocks.data());
+
+    return FinishUpload(atlas);
+}
+
+bool FreeTypeAtlas::FinishUpload(const AtlasImageView &atlas)
+{
     // tell the frag shader which texture sampler to use before loading the texture info
     // ??necessary??
+    // Note: Texture unit 0 is the only one that is ever used, so it stays active.
     glActiveTexture(GL_TEXTURE0);
     _textureSamplerId = 0;
-    glUniform1i(_uniformTextSamplerLoc, _textureSamplerId);
-
-    // ??the heck is this??
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    GlStateCache::Current().Uniform1i(_uniformTextSamplerLoc, _textureSamplerId);
 
     // texture configuration setup (I don't understand most of these)
     // - clamp both S and T (texture's X and Y; they have their own axis names) to edges so that 
     // any texture coordinates that are provided to OpenGL won't be allowed beyond the [-1, +1] 
     // range that texture coordinates are restricted to
     // - linear filtering when the texture needs to be magnified or (I cringe at the term) 
-    // "minified" based on scaling
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-
-    // paste all glyph bitmaps into the texture, but when loading them, I need to keep track of 
-    // where they are
-    int offsetX = 0;
-    int offsetY = 0;
-    // hijack the "row pixel height" and re-use it for helping to calculate Y offset
-    for (size_t charCode = 32; charCode < 128; charCode++)
+    // "minified" based on scaling, and between mip levels too if there are any
+    SetAtlasTextureParameters(_mipLevels);
+
+    // save glyph info for render time
+    // Note: The instanced path's table gets an entry for every prebuilt glyph and one for 
+    // every cell, whether or not anything is in it yet.
+    _glyphCharInfo.clear();
+    _glyphCharInfo.reserve(atlas.glyphCount + _glyphCache.CellCount());
+    _prebuiltGlyphCount = (unsigned int)atlas.glyphCount;
+    _glyphTable.assign(_prebuiltGlyphCount + _glyphCache.CellCount(), GlyphTableEntry());
+    for (size_t glyphIndex = 0; glyphIndex < atlas.glyphCount; glyphIndex++)
     {
-        if (FT_Load_Char(face, charCode, FT_LOAD_RENDER))
+        const AtlasGlyph &glyph = atlas.glyphs[glyphIndex];
+        FreeTypeGlyphCharInfo &info = _glyphCharInfo[glyph.codePoint];
+        if (glyph.codePoint < 128)
         {
-            fprintf(stderr, "Loading character '%c' failed\n", charCode);
-            continue;
+            // Note: Pointers to unordered_map elements stay good when the map grows.
+            _asciiGlyphCharInfo[glyph.codePoint] = &info;
         }
 
-        // this is the same idea as the "atlas pixel width/height" condition when determining 
-        // atlas size, but now it deals with the byte offsets into the loaded texture
-        // Note: The unsigned integer cast is to prevent a compiler warning.  Because I'm picky
-        // that way :).
-        if ((offsetX + glyph->bitmap.width + 1) >= (unsigned int)maxTextureSizeBytes)
-        {
-            // vertical offset jumps to next row
-            offsetY += rowPixelHeight;
-
-            // row height and horizontal offset reset to beginning of row
-            rowPixelHeight = 0;
-            offsetX = 0;
-        }
-
-        // send the glyph's bitmap to its own place in the atlas' texture
-        GLint level = 0;
-        GLint internalFormat = GL_RED;
-        GLint providedFormat = GL_RED;
-        GLenum providedFormatDataType = GL_UNSIGNED_BYTE;
-        GLint border = 0;
-        glTexSubImage2D(GL_TEXTURE_2D, level, offsetX, offsetY, glyph->bitmap.width,
-            glyph->bitmap.rows, providedFormat, providedFormatDataType, glyph->bitmap.buffer);
-
-        // save glyph info for render time
-
-        // because "advance" (pixel distance to jump before next character that makes the text 
-        // appear according to font design) is stored, for reasons only the FreeType creator 
-        // knows, in 1/64 pixels, and multiplying by 2^6 (64) will generate it in pixels
         // Note: The Y advance is only used in fonts that are meant to be written vertically.
         // The Y advance does NOT describe the distance between lines of text.  Nevertheless,
         // for the sake of generic font handling, record the Y advance too.
-        _glyphCharInfo[charCode].ax = (float)(glyph->advance.x >> 6);
-        _glyphCharInfo[charCode].ay = (float)(glyph->advance.y >> 6);
+        info.ax = glyph.ax;
+        info.ay = glyph.ay;
 
         // pixel distance from font origin (a formally defined bottom-left point for the font 
         // designer) to the bitmap origin (because rectangles outside OpenGL, including the 
         // bitmap standard, define the top left as the rectangle origin) - yay for different 
         // standards mixing it up in the same program
-        _glyphCharInfo[charCode].bl = (float)(glyph->bitmap_left);
-        _glyphCharInfo[charCode].bt = (float)(glyph->bitmap_top);
-
-        // don't know how FreeType stores glyphs in the TrueType file format and I don't need to 
-        // since the "load char" function work, but I do need to know where the glyph's data is 
-        // in the atlas' texture
-        // Note: Remember that OpenGL defines texture origin as the bottom left of a rectangle.
-        // Also Note: Remember that a texture has its own pixel coordinate system S and T that
+        info.bl = glyph.bl;
+        info.bt = glyph.bt;
+
+        // where the glyph's data is in the atlas' texture
+        // Note: Remember that a texture has its own pixel coordinate system S and T that
         // interpolate along a texture from [S=0.0, T=0.0] to [S=1.0T=1.0].
-        _glyphCharInfo[charCode].tx = (float)(offsetX / (float)atlasPixelWidth);
-        _glyphCharInfo[charCode].ty = (float)(offsetY / (float)atlasPixelHeight);
+        info.tx = (float)(glyph.x / (float)_atlasWidth);
+        info.ty = (float)(glyph.y / (float)_atlasHeight);
 
         // rectangles (including OpenGL textures) are defined by an origin (already recorded) 
-        // and width and height
-        // Note: The portion of the atlas texture for this character needs an origin and width and height, and since the origin is in texture coordinates, the width and height for this portion of the texture must also be in texture coordinates.
-        _glyphCharInfo[charCode].bw = (float)(glyph->bitmap.width);
-        _glyphCharInfo[charCode].nbw = (float)(glyph->bitmap.width / (float)atlasPixelWidth);
-        _glyphCharInfo[charCode].bh = (float)(glyph->bitmap.rows);
-        _glyphCharInfo[charCode].nbh = (float)(glyph->bitmap.rows / (float)atlasPixelHeight);
-
-        // just like in the earlier loop
-        rowPixelHeight = std::max(rowPixelHeight, glyph->bitmap.rows);
-        offsetX += glyph->bitmap.width + 1;
+        // and width and height, and since the origin is in texture coordinates, the width and 
+        // height for this portion of the texture must also be in texture coordinates
+        info.bw = (float)(glyph.width);
+        info.nbw = (float)(glyph.width / (float)_atlasWidth);
+        info.bh = (float)(glyph.rows);
+        info.nbh = (float)(glyph.rows / (float)_atlasHeight);
+
+        info.tableIndex = (unsigned int)glyphIndex;
+        SetGlyphTableEntry(info.tableIndex, info, glyph.x, glyph.y);
+        IncludeGlyphExtents(info);
     }
+    _kerning.Init(atlas.kerningPairs, atlas.kerningPairCount);
 
-    // create the vertex buffer that will be used to create quads as a base for the FreeType 
-    // glyph textures
-    glGenBuffers(1, &_vboId);
-    if (_vboId == -1)
+    // the vertex buffer that will be used to create quads as a base for the FreeType glyph 
+    // textures is made by whichever atlas comes first, like the index buffer
+    _vertexStream = StreamBuffer::Shared();
+    if (_vertexStream->BufferId() == 0)
     {
         fprintf(stderr, "could not generate vertex buffer object\n");
         return false;
     }
 
+    // the index buffer is made by whichever atlas comes first
+    _quadIndexBuffer = QuadIndexBuffer::Shared();
+
+    // the vertex array is set up on the first draw (see BindTextVertexArray())
+    glGenVertexArrays(1, &_vaoId);
+
     // no problems initializing atlas (I hope)
     return true;
 }
 
+const FreeTypeAtlas::FreeTypeGlyphCharInfo *FreeTypeAtlas::FindGlyph(
+    const unsigned int codePoint)
+{
+    if (codePoint < 128 && _asciiGlyphCharInfo[codePoint] != 0)
+    {
+        return _asciiGlyphCharInfo[codePoint];
+    }
+
+    std::unordered_map<unsigned int, FreeTypeGlyphCharInfo>::const_iterator found = 
+        _glyphCharInfo.find(codePoint);
+    if (found != _glyphCharInfo.end())
+    {
+        // only glyphs in the cache's cells can be evicted, so only they need to be touched
+        _glyphCache.Touch(codePoint, _renderStamp);
+        return &found->second;
+    }
+
+    return CacheGlyph(codePoint);
+}
+
+const FreeTypeAtlas::FreeTypeGlyphCharInfo *FreeTypeAtlas::CacheGlyph(
+    const unsigned int codePoint)
+{
+    if (!_glyphSource)
+    {
+        return 0;
+    }
+
+    GlyphArena arena;
+    if (!_glyphSource(codePoint, arena))
+    {
+        // Note: Only ask once.  If there is nothing to rasterize with, then there won't be on 
+        // the next frame either.
+        fprintf(stderr, "Nothing to rasterize glyphs outside of the atlas with\n");
+        _glyphSource = nullptr;
+        return 0;
+    }
+
+    FreeTypeGlyphCharInfo info;
+    memset(&info, 0, sizeof(info));
+    if (arena.glyphs.empty())
+    {
+        // FreeType already complained; remember the failure so that this glyph isn't 
+        // rasterized again on every frame
+        return AddGlyphWithoutCell(codePoint, info);
+    }
+
+    const RasterizedGlyph &glyph = arena.glyphs[0];
+    info.ax = glyph.ax;
+    info.ay = glyph.ay;
+    info.bl = glyph.bl;
+    info.bt = glyph.bt;
+
+    if (glyph.width == 0 || glyph.rows == 0)
+    {
+        // whitespace; it only needs an advance, not a cell
+        return AddGlyphWithoutCell(codePoint, info);
+    }
+
+    // Note: The cell has to leave room for the same gutter that the prebuilt glyphs get.
+    const unsigned int alignment = MipAlignment(_mipLevels);
+    if (glyph.width + alignment > _cellWidth || glyph.rows + alignment > _cellHeight)
+    {
+        // keep the advance so that the rest of the text lines up, but draw nothing
+        fprintf(stderr, "Glyph '%u' is too big for the glyph cache\n", codePoint);
+        return AddGlyphWithoutCell(codePoint, info);
+    }
+
+    // make more room rather than kick out a glyph that might be needed again soon
+    if (_glyphCache.FreeCellCount() == 0)
+    {
+        GrowAtlas();
+    }
+
+    unsigned int cell = 0;
+    bool evicted = false;
+    unsigned int evictedCodePoint = 0;
+    if (!_glyphCache.Insert(codePoint, _renderStamp, cell, evicted, evictedCodePoint))
+    {
+        // every cell is in use by the draw call that is being assembled, so skip this glyph 
+        // for now and try again on the next draw call
+        return 0;
+    }
+
+    if (evicted)
+    {
+        // a quad that was made for the evicted glyph would now show this one
+        _glyphCharInfo.erase(evictedCodePoint);
+        _layoutGeneration++;
+    }
+
+    unsigned int cellX = (cell % _cellColumns) * _cellWidth;
+    unsigned int cellY = _cellOriginY + ((cell / _cellColumns) * _cellHeight);
+
+    // send the whole cell, not just the glyph, so that whatever glyph used to be in the cell 
+    // can't peek out around the edges of the new one
+    // Note: The atlas' texture is already bound by the draw call that asked for the glyph.
+    _cellPixels.assign(_cellWidth * _cellHeight, 0);
+    const unsigned char *glyphPixels = arena.pixels.data() + glyph.pixelOffset;
+    for (unsigned int row = 0; row < glyph.rows; row++)
+    {
+        memcpy(_cellPixels.data() + (row * _cellWidth), glyphPixels + (row * glyph.width), 
+            glyph.width);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, cellX, cellY, _cellWidth, _cellHeight, GL_RED, 
+        GL_UNSIGNED_BYTE, _cellPixels.data());
+
+    // the cell is a multiple of the alignment and starts on one, so on every smaller level 
+    // it is exactly the cell shifted down by the level
+    // Note: This overwrites the cell's pixels, but they are reassigned for the next glyph.
+    for (unsigned int level = 1; level < _mipLevels; level++)
+    {
+        DownsampleCoverage(_cellPixels.data(), _cellWidth >> (level - 1), 
+            _cellHeight >> (level - 1), _cellMipPixels);
+        _cellPixels.swap(_cellMipPixels);
+        glTexSubImage2D(GL_TEXTURE_2D, level, cellX >> level, cellY >> level, 
+            _cellWidth >> level, _cellHeight >> level, GL_RED, GL_UNSIGNED_BYTE, 
+            _cellPixels.data());
+    }
+
+    info.tx = (float)(cellX / (float)_atlasWidth);
+    info.ty = (float)(cellY / (float)_atlasHeight);
+    info.bw = (float)(glyph.width);
+    info.nbw = (float)(glyph.width / (float)_atlasWidth);
+    info.bh = (float)(glyph.rows);
+    info.nbh = (float)(glyph.rows / (float)_atlasHeight);
+
+    // the cell's entry in the table now describes this glyph
+    info.tableIndex = _prebuiltGlyphCount + cell;
+    SetGlyphTableEntry(info.tableIndex, info, cellX, cellY);
+    IncludeGlyphExtents(info);
+    return &(_glyphCharInfo[codePoint] = info);
+}
+
+bool FreeTypeAtlas::GrowAtlas()
+{
+    // Note: Init(...) doesn't make any cells when the prebuilt glyphs already reach the max
+    // height, and then the room that is left would wrap around (see UploadAtlas(...)).
+    if (_cellColumns == 0 || _cellHeight == 0 || _cellOriginY >= _maxTextureSize)
+    {
+        return false;
+    }
+
+    unsigned int cellRows = _glyphCache.CellCount() / _cellColumns;
+    unsigned int maxCellRows = (_maxTextureSize - _cellOriginY) / _cellHeight;
+    unsigned int newCellRows = std::min(std::max(cellRows * 2, 1u), maxCellRows);
+    if (newCellRows <= cellRows)
+    {
+        return false;
+    }
+
+    // Only the height changes, so the cells keep their positions and so do the prebuilt 
+    // glyphs.  Only the T coordinates, which are relative to the height, need to change.
+    unsigned int oldHeight = _atlasHeight;
+    unsigned int newHeight = _cellOriginY + (newCellRows * _cellHeight);
+
+    GlStateCache &glState = GlStateCache::Current();
+    GLuint newTextureId = 0;
+    glGenTextures(1, &newTextureId);
+    glState.BindTexture(GL_TEXTURE_2D, newTextureId);
+    unsigned char zero = 0;
+    for (GLint level = 0; level < (GLint)_mipLevels; level++)
+    {
+        glTexImage2D(GL_TEXTURE_2D, level, GL_RED, _atlasWidth >> level, newHeight >> level, 
+            0, GL_RED, GL_UNSIGNED_BYTE, 0);
+        glClearTexImage(newTextureId, level, GL_RED, GL_UNSIGNED_BYTE, &zero);
+    }
+    SetAtlasTextureParameters(_mipLevels);
+
+    // texture to texture, entirely on the GPU, one mip level at a time
+    // Note: glCopyImageSubData(...) is OpenGL 4.3, and the program asks for 4.4.
+    for (GLint level = 0; level < (GLint)_mipLevels; level++)
+    {
+        glCopyImageSubData(_textureId, GL_TEXTURE_2D, level, 0, 0, 0, 
+            newTextureId, GL_TEXTURE_2D, level, 0, 0, 0, 
+            _atlasWidth >> level, oldHeight >> level, 1);
+    }
+    glState.Forget(GL_TEXTURE_2D, _textureId);
+    glDeleteTextures(1, &_textureId);
+    _textureId = newTextureId;
+    _atlasHeight = newHeight;
+
+    // A T coordinate is a pixel row divided by the height, so going from the old height to 
+    // the new one is a single multiplication.
+    // Note: The glyph info is reached through the map and through the ASCII table, but the 
+    // table only points into the map, so this covers both.
+    // Also Note: The glyph table is in texels, so the existing entries are still right and
+    // the new cells only need entries of their own.  Those go in right after the old cells,
+    // which moves the entries of the glyphs that have no cell (see AddGlyphWithoutCell(...)).
+    float rescale = (float)oldHeight / (float)newHeight;
+    unsigned int oldCellsEnd = _prebuiltGlyphCount + (cellRows * _cellColumns);
+    unsigned int newCellCount = (newCellRows - cellRows) * _cellColumns;
+    for (auto &glyphInfo : _glyphCharInfo)
+    {
+        glyphInfo.second.ty *= rescale;
+        glyphInfo.second.nbh *= rescale;
+        if (glyphInfo.second.tableIndex >= oldCellsEnd)
+        {
+            glyphInfo.second.tableIndex += newCellCount;
+        }
+    }
+    _glyphTable.insert(_glyphTable.begin() + oldCellsEnd, newCellCount, GlyphTableEntry());
+
+    _glyphCache.Grow(newCellRows * _cellColumns);
+
+    // quads that were made before this have the old T coordinates
+    _layoutGeneration++;
+    return true;
+}
+
+void FreeTypeAtlas::SetGlyphTableEntry(const unsigned int tableIndex, 
+    const FreeTypeGlyphCharInfo &info, const unsigned int texelX, const unsigned int texelY)
+{
+    GlyphTableEntry &entry = _glyphTable[tableIndex];
+    entry.bl = info.bl;
+    entry.bt = info.bt;
+    entry.bw = info.bw;
+    entry.bh = info.bh;
+    entry.x = (float)texelX;
+    entry.y = (float)texelY;
+    entry.ax = info.ax;
+    entry.ay = info.ay;
+
+    // widen the stretch of entries that needs to go up before the next instanced draw
+    if (_glyphTableDirtyBegin == _glyphTableDirtyEnd)
+    {
+        _glyphTableDirtyBegin = tableIndex;
+        _glyphTableDirtyEnd = tableIndex + 1;
+    }
+    else
+    {
+        _glyphTableDirtyBegin = std::min(_glyphTableDirtyBegin, (size_t)tableIndex);
+        _glyphTableDirtyEnd = std::max(_glyphTableDirtyEnd, (size_t)tableIndex + 1);
+    }
+}
+
+const FreeTypeAtlas::FreeTypeGlyphCharInfo *FreeTypeAtlas::AddGlyphWithoutCell(
+    const unsigned int codePoint, FreeTypeGlyphCharInfo &info)
+{
+    // Note: The entry never changes, and a glyph without a cell is never evicted, so it is
+    // only ever moved along by GrowAtlas().
+    info.tableIndex = (unsigned int)_glyphTable.size();
+    _glyphTable.push_back(GlyphTableEntry());
+    SetGlyphTableEntry(info.tableIndex, info, 0, 0);
+
+    // it draws nothing, but its advance still moves the pen
+    IncludeGlyphExtents(info);
+    return &(_glyphCharInfo[codePoint] = info);
+}
+
+void FreeTypeAtlas::UploadGlyphTable()
+{
+    // Send up whatever changed in the table while the glyphs were gathered (and before), or
+    // all of it if the table has grown since the buffer was last sized.
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, _glyphTableSsboId);
+    if (_glyphTable.size() != _glyphTableGpuEntries)
+    {
+        glBufferData(GL_SHADER_STORAGE_BUFFER, _glyphTable.size() * sizeof(GlyphTableEntry),
+            _glyphTable.data(), GL_DYNAMIC_DRAW);
+        _glyphTableGpuEntries = _glyphTable.size();
+    }
+    else if (_glyphTableDirtyBegin != _glyphTableDirtyEnd)
+    {
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER,
+            _glyphTableDirtyBegin * sizeof(GlyphTableEntry),
+            (_glyphTableDirtyEnd - _glyphTableDirtyBegin) * sizeof(GlyphTableEntry),
+            _glyphTable.data() + _glyphTableDirtyBegin);
+    }
+    _glyphTableDirtyBegin = 0;
+    _glyphTableDirtyEnd = 0;
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    GlStateCache::Current().BindShaderStorageBuffer(0, _glyphTableSsboId);
+}
+
+void FreeTypeAtlas::BeginBatch()
+{
+    // a new draw call
+    _renderStamp++;
+
+    // the texture has to be bound for glyphs to be added to it (see CacheGlyph(...))
+    GlStateCache::Current().BindTexture(GL_TEXTURE_2D, _textureId);
+}
+
+size_t FreeTypeAtlas::AppendText(const std::string &str, const float posPixels[2],
+    const float userScale[2], const unsigned int color, TextVertex *vertices,
+    const size_t firstVertex, const size_t vertexCount)
+{
+    return AppendText(str.data(), str.length(), posPixels, userScale, color, vertices,
+        firstVertex, vertexCount);
+}
+
+size_t FreeTypeAtlas::AppendText(const char *str, const size_t length,
+    const float posPixels[2], const float userScale[2], const unsigned int color,
+    TextVertex *vertices, const size_t firstVertex, const size_t vertexCount)
+{
+    // the glyph origin will advance for each successive character
+    // Ex: If the string were "ABC", then "B" draws further right than "A", and "C" further right
+    // than "B".
+    float pen[2] = { posPixels[0], posPixels[1] };
+
+    // 4 vertices per glyph, and the caller made room for 4 per byte
+    // Note: The string is UTF-8, so there may be fewer characters than bytes, but never more.
+    size_t newVertexCount = vertexCount;
+    size_t byteIndex = 0;
+    unsigned int previousCodePoint = 0;
+    while (byteIndex < length)
+    {
+        // nothing from here on can be seen (see SetClipRect(...))
+        if (PastCullRect(pen, userScale))
+        {
+            break;
+        }
+
+        // the pair's kerning goes in before the glyph is placed
+        // Note: The first glyph has no pair, and no pair starts with code point 0.
+        unsigned int codePoint = DecodeUtf8(str, length, byteIndex);
+        pen[0] += _kerning.Find(previousCodePoint, codePoint) * userScale[0];
+        previousCodePoint = codePoint;
+
+        // the texture is bound, so a glyph that isn't in the atlas yet can be added now
+        // Note: Adding it may have made the atlas grow, in which case the new texture is 
+        // bound instead, and the quads that are already in the list have to be moved to the 
+        // new texture's T coordinates (see GrowAtlas()).
+        unsigned int atlasHeightBefore = _atlasHeight;
+        const FreeTypeGlyphCharInfo *glyph = FindGlyph(codePoint);
+        if (_atlasHeight != atlasHeightBefore)
+        {
+            float rescale = (float)atlasHeightBefore / (float)_atlasHeight;
+            for (size_t vertexIndex = firstVertex; vertexIndex < newVertexCount; vertexIndex++)
+            {
+                vertices[vertexIndex].t *= rescale;
+            }
+        }
+        if (glyph == 0)
+        {
+            continue;
+        }
+
+        // a glyph that can't be seen only moves the pen, and nothing is written for it
+        if (_cullEnabled && !GlyphQuadOverlaps(*glyph, userScale, pen, _cullRect))
+        {
+            pen[0] += glyph->ax * userScale[0];
+            pen[1] += glyph->ay * userScale[1];
+            continue;
+        }
+
+        MakeGlyphQuad(*glyph, userScale, color, pen, vertices + newVertexCount);
+        newVertexCount += VerticesPerQuad;
+    }
+
+    return newVertexCount;
+}
+
+void FreeTypeAtlas::AppendGlyph(const unsigned int codePoint, const float userScale[2],
+    const unsigned int color, float pen[2], TextVertex corners[VerticesPerQuad])
+{
+    const FreeTypeGlyphCharInfo *glyph = FindGlyph(codePoint);
+    if (glyph == 0)
+    {
+        TextVertex empty = { pen[0], pen[1], 0.0f, 0.0f, color };
+        for (unsigned int corner = 0; corner < VerticesPerQuad; corner++)
+        {
+            corners[corner] = empty;
+        }
+        return;
+    }
+
+    MakeGlyphQuad(*glyph, userScale, color, pen, corners);
+}
+
+float FreeTypeAtlas::Kerning(const unsigned int left, const unsigned int right) const
+{
+    return _kerning.Find(left, right);
+}
+
+void FreeTypeAtlas::BindForBatch() const
+{
+    GlStateCache &glState = GlStateCache::Current();
+    glState.BindTexture(GL_TEXTURE_2D, _textureId);
+    glState.Uniform1i(_uniformTextSamplerLoc, _textureSamplerId);
+    ApplyScissor();
+}
+
+unsigned int FreeTypeAtlas::LayoutGeneration() const
+{
+    return _layoutGeneration;
+}
+
+void FreeTypeAtlas::SetViewportSize(const int width, const int height)
+{
+    _viewportWidth = width;
+    _viewportHeight = height;
+    UpdateCullRect();
+}
+
+void FreeTypeAtlas::SetClipRect(const float clipPixels[4], const bool scissor)
+{
+    PixelRect clipRect = { clipPixels[0], clipPixels[1], clipPixels[2], clipPixels[3] };
+    _clipRect = clipRect;
+    _hasClipRect = true;
+    _scissorClip = scissor;
+    UpdateCullRect();
+}
+
+void FreeTypeAtlas::ClearClipRect()
+{
+    _hasClipRect = false;
+    _scissorClip = false;
+    UpdateCullRect();
+}
+
+void FreeTypeAtlas::UpdateCullRect()
+{
+    // Note: A window that is 0 pixels across (minimized) draws nothing anyway, so it isn't
+    // worth culling against.
+    _cullEnabled = false;
+    if (_viewportWidth > 0 && _viewportHeight > 0)
+    {
+        PixelRect window = { 0.0f, 0.0f, (float)_viewportWidth, (float)_viewportHeight };
+        _cullRect = window;
+        _cullEnabled = true;
+    }
+    if (!_hasClipRect)
+    {
+        return;
+    }
+
+    if (!_cullEnabled)
+    {
+        _cullRect = _clipRect;
+        _cullEnabled = true;
+        return;
+    }
+
+    // a clip rectangle that is entirely off of the window leaves nothing, and then every
+    // glyph is skipped
+    _cullRect.left = std::max(_cullRect.left, _clipRect.left);
+    _cullRect.bottom = std::max(_cullRect.bottom, _clipRect.bottom);
+    _cullRect.right = std::min(_cullRect.right, _clipRect.right);
+    _cullRect.top = std::min(_cullRect.top, _clipRect.top);
+}
+
+void FreeTypeAtlas::IncludeGlyphExtents(const GlyphQuadMetrics &glyph)
+{
+    if (glyph.ax < 0.0f || glyph.ay != 0.0f)
+    {
+        _advancesOnlyRight = false;
+    }
+    if (glyph.bw == 0.0f || glyph.bh == 0.0f)
+    {
+        return;
+    }
+
+    // relative to the pen, with the same placement as MakeGlyphQuad(...)
+    _glyphExtents.left = std::min(_glyphExtents.left, -glyph.bl);
+    _glyphExtents.right = std::max(_glyphExtents.right, glyph.bw - glyph.bl);
+    _glyphExtents.top = std::max(_glyphExtents.top, glyph.bt);
+    _glyphExtents.bottom = std::min(_glyphExtents.bottom, glyph.bt - glyph.bh);
+}
+
+bool FreeTypeAtlas::PastCullRect(const float pen[2], const float userScale[2]) const
+{
+    // Note: A mirrored (negative) scale turns the extents around, so don't skip anything.
+    if (!_cullEnabled || !_advancesOnlyRight || userScale[0] <= 0.0f || userScale[1] <= 0.0f)
+    {
+        return false;
+    }
+
+    // the pen only moves right, so once even the glyph that reaches furthest left of its pen
+    // would start past the right edge, so would every glyph after it
+    // Note: Kerning can pull the next glyph back to the left of the pen, but the pen still
+    // moves right overall (an advance is bigger than its kerning), so only one pair's worth
+    // needs allowing for.
+    float reachLeft = _glyphExtents.left + _kerning.MostNegative();
+    if (pen[0] + (reachLeft * userScale[0]) >= _cullRect.right)
+    {
+        return true;
+    }
+
+    // the pen never moves up or down either, so a line that is entirely above or below the
+    // rectangle stays that way
+    return (pen[1] + (_glyphExtents.top * userScale[1]) <= _cullRect.bottom) ||
+        (pen[1] + (_glyphExtents.bottom * userScale[1]) >= _cullRect.top);
+}
+
+void FreeTypeAtlas::ApplyScissor() const
+{
+    GlStateCache &glState = GlStateCache::Current();
+    if (!_scissorClip)
+    {
+        glState.DisableScissor();
+        return;
+    }
+
+    // every pixel that the rectangle touches, so that a glyph that is partly inside isn't cut
+    // off a pixel early
+    int left = (int)floorf(_clipRect.left);
+    int bottom = (int)floorf(_clipRect.bottom);
+    int right = std::max((int)ceilf(_clipRect.right), left);
+    int top = std::max((int)ceilf(_clipRect.top), bottom);
+    int box[4] = { left, bottom, right - left, top - bottom };
+    glState.EnableScissor(box);
+}
+
+const PackReport &FreeTypeAtlas::GetPackReport() const
+{
+    return _packReport;
+}
+
+const CompressionReport &FreeTypeAtlas::GetCompressionReport() const
+{
+    return _compressionReport;
+}
+
 FreeTypeAtlas::~FreeTypeAtlas()
 {
+    GlStateCache &glState = GlStateCache::Current();
+    glState.Forget(GL_TEXTURE_2D, _textureId);
     glDeleteTextures(1, &_textureId);
-    glDeleteBuffers(1, &_vboId);
+    glState.Forget(GL_VERTEX_ARRAY, _vaoId);
+    glDeleteVertexArrays(1, &_vaoId);
+
+    // Note: Deleting buffer 0 is silently ignored, so this is safe even if the instanced path 
+    // was never set up.  The same goes for vertex array 0.
+    glState.Forget(GL_SHADER_STORAGE_BUFFER, _glyphTableSsboId);
+    glDeleteBuffers(1, &_glyphTableSsboId);
+    glState.Forget(GL_VERTEX_ARRAY, _instancedVaoId);
+    glDeleteVertexArrays(1, &_instancedVaoId);
+    glDeleteBuffers(1, &_blockAdvanceSsboId);
 }
 
-// x and y are screen coordinates (each on the range [-1,+1])
-void FreeTypeAtlas::RenderChar(const char c, const float posScreenCoord[2], 
-    const float userScale[2], const float color[4]) const
+// x and y are pixels from the window's bottom left corner
+void FreeTypeAtlas::RenderChar(const unsigned int codePoint, const float posPixels[2],
+    const float userScale[2], const float color[4])
 {
+    // a new draw call
+    _renderStamp++;
+
+    // the quad is written straight into the vertex buffer, wherever the ring has room
+    // Note: This comes first because the buffer might be made anew (see StreamBuffer.h), and 
+    // the vertex array needs to point at the one that the quad ends up in.
+    size_t byteOffset = 0;
+    TextVertex *box = (TextVertex *)_vertexStream->Reserve(
+        VerticesPerQuad * sizeof(TextVertex), sizeof(TextVertex), byteOffset);
+    if (box == 0)
+    {
+        return;
+    }
+
     // the text will be drawn, in part, via a manipulation of pixel alpha values, and apparently
     // OpenGL's blending does this
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    // Note: The cache skips all of this when the last draw already set it up, and nothing is
+    // unbound afterwards, so drawing the same atlas again costs one draw call and nothing
+    // else (see GlStateCache.h).
+    GlStateCache &glState = GlStateCache::Current();
+    glState.EnableAlphaBlend();
+    ApplyScissor();
 
     // bind the texture that contains the atlas and tell OpenGL 
-    glBindTexture(GL_TEXTURE_2D, _textureId);
-    glUniform1i(_uniformTextSamplerLoc, _textureSamplerId);
+    glState.BindTexture(GL_TEXTURE_2D, _textureId);
+    glState.Uniform1i(_uniformTextSamplerLoc, _textureSamplerId);
 
-    // use the user-provided color
-    glUniform4fv(_uniformTextColorLoc, 1, color);
+    // the vertex attributes and both buffers were set up once (see BindTextVertexArray())
+    BindTextVertexArray();
 
-    // set the 
-    // 2 floats per screen coord, 2 floats per texture coord, so 1 variable will do
-    GLint itemsPerVertexAttrib = 2;
+    // the texture is bound, so a glyph that isn't in the atlas yet can be added now
+    const FreeTypeGlyphCharInfo *glyph = FindGlyph(codePoint);
+    if (glyph == 0)
+    {
+        return;
+    }
 
-    // how many bytes to "jump" until the next instance of the attribute
-    GLint bytesPerVertex = 4 * sizeof(float);
-
-    // this is cast as a pointer due to OpenGL legacy stuff
-    GLint bufferStartByteOffset = 0;
-
-    // shorthand for "vertex attribute index"
-    GLint vai = 0;
-
-    // need to create 1 quad (2 triangles) for each character, each of which occupies a 
-    // rectangle in the atlas texture
-    // Note: MUST bind BEFORE setting vertex attribute array pointers or it WILL crash.  The GPU 
-    // operates on the values set in the vertex attribute pointers and not on the buffer ID.  
-    // The buffer ID is simply a way to tell OpenGL to activate a certain part of the context, 
-    // and then the following vertex attribute data tells OpenGL how the next draw call is going 
-    // to go down.  This is a GL context thing and those will only work on the currently-set 
-    // buffer.  No error is thrown if the current buffer's ID is 0 (no buffer), and that just 
-    // begs for a silent bug.  A lot of OpenGL code does not clean up the buffer bindings at the 
-    // end of the draw call (why unbind if you're just going to bind another in a moment 
-    // anyway?), and in doing so this error might be swallowed.  
-    glBindBuffer(GL_ARRAY_BUFFER, _vboId);
-
-    // screen coordinates first
-    // Note: 2 floats starting 0 bytes from set start.
-    glEnableVertexAttribArray(vai);
-    glVertexAttribPointer(vai, itemsPerVertexAttrib, GL_FLOAT, GL_FALSE, bytesPerVertex,
-        (void *)bufferStartByteOffset);
-
-    // texture coordinates second
-    // Note: My approach (a common one) is to use the same kind and number of items for each
-    // vertex attribute, so this array's settings are nearly identical to the screen 
-    // coordinate's, the only difference being an offset (screen coordinate bytes first, then
-    // texture coordinate byte; see the box).
-    vai++;
-    bufferStartByteOffset += itemsPerVertexAttrib * sizeof(float);
-    glEnableVertexAttribArray(vai);
-    glVertexAttribPointer(vai, itemsPerVertexAttrib, GL_FLOAT, GL_FALSE, bytesPerVertex,
-        (void *)bufferStartByteOffset);
-
-    // X and Y screen coordinates are on the range [-1,+1]
-    float oneOverScreenPixelWidth = 2.0f / glutGet(GLUT_WINDOW_WIDTH);
-    float oneOverScreenPixelHeight = 2.0f / glutGet(GLUT_WINDOW_HEIGHT);
-
-    // figure out where the texture needs to start drawing in screen coordinates
-    // Note: A glyph has a formal origin point that we (humans) usually think of as being where
-    // the character "starts".  But as far as OpenGL is concerned, I have a 2D rectangle of pixel
-    // data, and that's it.  If I drew that texture at the user-provided x and y, then the 
-    // character would likely look like it isn't centered.  The TrueType format provides info 
-    // that FreeType extracts so that I can figure out where to draw the texture so that it 
-    // LOOKS like the glyph ('g', c, ';', etc.) "starts" at the user-provided x and y.
-    float scaledGlyphLeft = _glyphCharInfo[c].bl * oneOverScreenPixelWidth * userScale[0];
-    float scaledGlyphWidth = _glyphCharInfo[c].bw * oneOverScreenPixelWidth * userScale[0];
-    float scaledGlyphTop = _glyphCharInfo[c].bt * oneOverScreenPixelHeight * userScale[1];
-    float scaledGlyphHeight = _glyphCharInfo[c].bh * oneOverScreenPixelHeight * userScale[1];
-
-    // could these be condensed into the "scaled glyph" calulations? yes, but this is clearer to 
-    // me
-    float screenCoordLeft = posScreenCoord[0] - scaledGlyphLeft;
-    float screenCoordRight = screenCoordLeft + scaledGlyphWidth;
-    float screenCoordTop = posScreenCoord[1] + scaledGlyphTop;
-    float screenCoordBottom = screenCoordTop - scaledGlyphHeight;
+    // a glyph that can't be seen isn't drawn at all (see SetClipRect(...))
+    float pen[2] = { posPixels[0], posPixels[1] };
+    if (_cullEnabled && !GlyphQuadOverlaps(*glyph, userScale, pen, _cullRect))
+    {
+        return;
+    }
 
     // unlike my project "freeglut_glload_render_freetype", which loads glyphs into their own 
     // textures one at a time (crude, but conveys basics), I can no longer use the whole texture 
-    // and must use the offset info that was stored when the atlas was created
-    // Note: Remember that textures use their own 2D coordinate system (S,T) to avoid confusion 
-    // with screen coordinates (X,Y).
-    float sLeft = _glyphCharInfo[c].tx;//0.0f;
-    float sRight = _glyphCharInfo[c].tx + _glyphCharInfo[c].nbw;//1.0f;
-    float tBottom = _glyphCharInfo[c].ty;
-    float tTop = _glyphCharInfo[c].ty + _glyphCharInfo[c].nbh;
-
-    // OpenGL draws triangles, but a rectangle needs to be drawn, so specify the four corners
-    // of the box in such a way that GL_LINE_STRIP will draw the two triangle halves of the 
-    // box
-    // Note: As long as the lines from point A to B to C to D don't cross each other (draw 
-    // it on paper), this is fine.  I am going with the pattern 
-    // bottom left -> bottom right -> top left -> top right.
-    // Also Note: Bitmap standards (and most other rectangle standards in programming, such 
-    // as for GUIs) understand the top left as the origin, and therefore the texture's pixels 
-    // are provided in a rectangle that goes from top left to bottom right.  OpenGL is the 
-    // odd one out in the world of rectangles, and it draws textures from lower left 
-    // ([S=0,T=0]) to upper right ([S=1,T=1]).  This means that the texture, from OpenGL's 
-    // perspective, is "upside down".  Yay for different standards.
-    point box[4] = {
-        { screenCoordLeft, screenCoordBottom, sLeft, tTop },
-        { screenCoordRight, screenCoordBottom, sRight, tTop },
-        { screenCoordLeft, screenCoordTop, sLeft, tBottom },
-        { screenCoordRight, screenCoordTop, sRight, tBottom }
-    };
-
-    // the vertex buffer's size is dependent upon string length, and in this demo that value is 
-    // not constant, so the vertex data needs to be completely refreshed every draw call, and 
-    // therefore glBufferData(...) is used instead of glBufferSubData(...) 
-    glBufferData(GL_ARRAY_BUFFER, sizeof(box), box, GL_DYNAMIC_DRAW);
-
-    // all that so that this one function call will work
-    // Note: Start at vertex 0 (that is, start at element 0 in the GL_ARRAY_BUFFER) and draw 
-    // 4 of them.
-    // Also Note: Due to the way that fonts work in texture atlases, only one character is 
-    // drawn at a time, which means that only 1 quad is drawn at a time.  Rather than set up 
-    // indexes and perform an element draw, just use a GL_TRIANGLE_STRIP.  That works great 
-    // for a single (and only a single) quad, hence the hard-coded vertex count (4) in the 
-    // draw call.  If it were not a quad, instancing and glDrawElements(...) should be used
-    // instead.
-    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-
-    // cleanup
-    glBindTexture(GL_TEXTURE_2D, 0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glDisable(GL_BLEND);
-    glBlendFunc(0, 0);
+    // and must use the offset info that was stored when the atlas was created (see 
+    // MakeGlyphQuad(...) for the details)
+    // Also Note: The box is the mapped vertex buffer itself, so there is nothing to upload.
+    // Also Also Note: The user-provided color goes into every corner (see PackColor(...)).
+    MakeGlyphQuad(*glyph, userScale, PackColor(color), pen, box);
+    _vertexStream->Commit(VerticesPerQuad * sizeof(TextVertex));
+
+    // a new glyph may have made the atlas grow, which binds a new texture (see GrowAtlas())
+    glState.BindTexture(GL_TEXTURE_2D, _textureId);
+
+    // OpenGL draws triangles, but a rectangle needs to be drawn, so the shared index buffer 
+    // picks out the two triangle halves of the box (see GlyphQuads.h)
+    _quadIndexBuffer->DrawQuads(byteOffset / sizeof(TextVertex), 1);
+
+    // the ring can't hand these bytes out again until the GPU is done drawing them
+    _vertexStream->Fence();
 }
 
 // see RenderChar(...) for more detail
-void FreeTypeAtlas::RenderText(const std::string &str, const float posScreenCoord[2],
-    const float userScale[2], const float color[4]) const
+void FreeTypeAtlas::RenderText(const std::string &str, const float posPixels[2],
+    const float userScale[2], const float color[4])
 {
-    // the text will be drawn, in part, via a manipulation of pixel alpha values, and apparently
-    // OpenGL's blending does this
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    RenderText(str.data(), str.length(), posPixels, userScale, color);
+}
 
-    // bind the texture that contains the atlas and tell OpenGL 
-    glBindTexture(GL_TEXTURE_2D, _textureId);
-    glUniform1i(_uniformTextSamplerLoc, _textureSamplerId);
+void FreeTypeAtlas::RenderText(const char *str, const size_t length, const float posPixels[2],
+    const float userScale[2], const float color[4])
+{
+    // a new draw call
+    _renderStamp++;
+
+    // room for 4 vertices per byte, which is the most that the string could need, straight 
+    // in the vertex buffer (see RenderChar(...))
+    size_t byteOffset = 0;
+    TextVertex *vertices = (TextVertex *)_vertexStream->Reserve(
+        VerticesPerQuad * length * sizeof(TextVertex), sizeof(TextVertex), byteOffset);
+    if (vertices == 0)
+    {
+        return;
+    }
+
+    GlStateCache &glState = GlStateCache::Current();
+    glState.EnableAlphaBlend();
+    ApplyScissor();
+    glState.BindTexture(GL_TEXTURE_2D, _textureId);
+    glState.Uniform1i(_uniformTextSamplerLoc, _textureSamplerId);
+    BindTextVertexArray();
+
+    // run through each character, gather all the vertex and other info together, and draw it 
+    // all in one go
+    // Note: Each character is 4 vertices, and the shared index buffer turns every 4 of them 
+    // into the two triangles of a quad.  This used to be one triangle strip for the whole 
+    // string, which also drew triangles that connected each glyph to the next one.
+    size_t vertexCount = AppendText(str, length, posPixels, userScale, PackColor(color),
+        vertices, 0, 0);
+    if (vertexCount == 0)
+    {
+        return;
+    }
+
+    // The vertex buffer's size is dependent upon string length, and in this demo that value 
+    // is not constant, so this used to reallocate the buffer with glBufferData(...) on every 
+    // draw call.  The vertices are already in the buffer now, so only the part of the 
+    // reservation that was actually used needs to be kept.
+    _vertexStream->Commit(vertexCount * sizeof(TextVertex));
+    glState.BindTexture(GL_TEXTURE_2D, _textureId);
+
+    // all that so that this one function call will work
+    _quadIndexBuffer->DrawQuads(byteOffset / sizeof(TextVertex), vertexCount / VerticesPerQuad);
+    _vertexStream->Fence();
+}
 
-    // use the user-provided color
-    glUniform4fv(_uniformTextColorLoc, 1, color);
+void FreeTypeAtlas::BindTextVertexArray()
+{
+    GlStateCache &glState = GlStateCache::Current();
+    glState.BindVertexArray(_vaoId);
+    if (_vaoStreamGeneration == _vertexStream->Generation())
+    {
+        return;
+    }
 
-    // set the 
-    // 2 floats per screen coord, 2 floats per texture coord, so 1 variable will do
+    // The vertex array was just made, or the vertex stream has been made anew since it was
+    // set up, so point it at the stream.
+    // Note: The core profile can't draw without a vertex array object, and the attribute
+    // pointers, which buffer they read from, the element buffer, and which attributes are
+    // enabled all belong to it.  Since none of that changes from draw to draw, it is set up
+    // here once instead of on every RenderText(...).
+    _vaoStreamGeneration = _vertexStream->Generation();
+
+    // 2 floats per pixel coord, 2 floats per texture coord, so 1 variable will do
+    // Note: The color is 4 bytes, which arrive in the shader as a vec4 on [0.0,1.0] because
+    // they are normalized.
     GLint itemsPerVertexAttrib = 2;
 
     // how many bytes to "jump" until the next instance of the attribute
-    GLint bytesPerVertex = 4 * sizeof(float);
-
-    // this is cast as a pointer due to OpenGL legacy stuff
-    GLint bufferStartByteOffset = 0;
-
-    // shorthand for "vertex attribute index"
-    GLint vai = 0;
-
-    // need to create 1 quad (2 triangles) for each character, each of which occupies a 
-    // rectangle in the atlas texture
-    // Note: MUST bind BEFORE setting vertex attribute array pointers or it WILL crash.  
-    glBindBuffer(GL_ARRAY_BUFFER, _vboId);
-
-    // screen coordinates first
-    // Note: 2 floats starting 0 bytes from set start.
-    glEnableVertexAttribArray(vai);
-    glVertexAttribPointer(vai, itemsPerVertexAttrib, GL_FLOAT, GL_FALSE, bytesPerVertex,
-        (void *)bufferStartByteOffset);
-
-    // texture coordinates second
-    // Note: My approach (a common one) is to use the same kind and number of items for each
-    // vertex attribute, so this array's settings are nearly identical to the screen 
-    // coordinate's, the only difference being an offset (screen coordinate bytes first, then
-    // texture coordinate byte; see the box).
-    vai++;
-    bufferStartByteOffset += itemsPerVertexAttrib * sizeof(float);
-    glEnableVertexAttribArray(vai);
-    glVertexAttribPointer(vai, itemsPerVertexAttrib, GL_FLOAT, GL_FALSE, bytesPerVertex,
-        (void *)bufferStartByteOffset);
-
-    // X and Y screen coordinates are on the range [-1,+1]
-    float oneOverScreenPixelWidth = 2.0f / glutGet(GLUT_WINDOW_WIDTH);
-    float oneOverScreenPixelHeight = 2.0f / glutGet(GLUT_WINDOW_HEIGHT);
+    GLint bytesPerVertex = sizeof(TextVertex);
+
+    // Note: MUST bind BEFORE setting vertex attribute array pointers or it WILL crash.  The GPU
+    // operates on the values set in the vertex attribute pointers and not on the buffer ID.
+    // The buffer ID is simply a way to tell OpenGL to activate a certain part of the context,
+    // and then the following vertex attribute data tells OpenGL how the next draw call is going
+    // to go down.  This is a GL context thing and those will only work on the currently-set
+    // buffer.  No error is thrown if the current buffer's ID is 0 (no buffer), and that just
+    // begs for a silent bug.
+    glBindBuffer(GL_ARRAY_BUFFER, _vertexStream->BufferId());
+
+    // pixel coordinates first, then texture coordinates, then color
+    // Note: Every draw starts at its own vertex with a base vertex (see
+    // QuadIndexBuffer::DrawQuads(...)), so the pointers always start at the start of the
+    // buffer.
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, itemsPerVertexAttrib, GL_FLOAT, GL_FALSE, bytesPerVertex,
+        (void *)offsetof(TextVertex, x));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, itemsPerVertexAttrib, GL_FLOAT, GL_FALSE, bytesPerVertex,
+        (void *)offsetof(TextVertex, s));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, bytesPerVertex,
+        (void *)offsetof(TextVertex, color));
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _quadIndexBuffer->BufferId());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
 
-    // the glyph origin will advance for each successive character
-    // Ex: If the string were "ABC", then "B" draws further right than "A", and "C" further right
-    // than "B".
-    float glyphOriginX = posScreenCoord[0];
-    float glyphOriginY = posScreenCoord[1];
+void FreeTypeAtlas::BindInstancedVertexArray()
+{
+    // see BindTextVertexArray()
+    GlStateCache &glState = GlStateCache::Current();
+    glState.BindVertexArray(_instancedVaoId);
+    if (_instancedVaoStreamGeneration == _vertexStream->Generation())
+    {
+        return;
+    }
+    _instancedVaoStreamGeneration = _vertexStream->Generation();
+
+    // every attribute steps once per instance (glyph) instead of once per vertex
+    // Note: The glyph index is an integer all the way into the shader, so it needs the "I"
+    // version of the pointer call, or else it would arrive as a float.  The fixed point scale
+    // arrives as floats from 0 to 65535 and the shader divides it by 256.
+    // Also Note: The divisors belong to the vertex array too, so they don't leak into the
+    // regular path's attributes like they would without one.
+    glBindBuffer(GL_ARRAY_BUFFER, _vertexStream->BufferId());
+    GLint bytesPerInstance = sizeof(GlyphInstance);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, bytesPerInstance,
+        (void *)offsetof(GlyphInstance, penX));
+    glVertexAttribDivisor(0, 1);
+    glEnableVertexAttribArray(1);
+    glVertexAttribIPointer(1, 1, GL_UNSIGNED_INT, bytesPerInstance,
+        (void *)offsetof(GlyphInstance, glyphIndex));
+    glVertexAttribDivisor(1, 1);
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 2, GL_UNSIGNED_SHORT, GL_FALSE, bytesPerInstance,
+        (void *)offsetof(GlyphInstance, scaleX));
+    glVertexAttribDivisor(2, 1);
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(3, 4, GL_UNSIGNED_BYTE, GL_TRUE, bytesPerInstance,
+        (void *)offsetof(GlyphInstance, color));
+    glVertexAttribDivisor(3, 1);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _quadIndexBuffer->BufferId());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
 
-    // set aside memory so that screen coordinate and texture coorninate info can be drawn with a
-    // single draw call
-    // Note: Each character has 4 points.  See comments on "box" in RenderChar(...) for more 
-    // detailed comments.
-    std::vector<point> glyphBoxes(4 * str.length());
+bool FreeTypeAtlas::InitInstanced(const int uniformTextSamplerLoc)
+{
+    _instancedUniformTextSamplerLoc = uniformTextSamplerLoc;
 
-    // run through each character, gather all the vertex and other info together, and draw it 
-    // all in one go
-    for (size_t charIndex = 0; charIndex < str.length(); charIndex++)
-    {
-        char c = str[charIndex];
-
-        // figure out where the texture needs to start drawing in screen coordinates
-        float scaledGlyphLeft = _glyphCharInfo[c].bl * oneOverScreenPixelWidth * userScale[0];
-        float scaledGlyphWidth = _glyphCharInfo[c].bw * oneOverScreenPixelWidth * userScale[0];
-        float scaledGlyphTop = _glyphCharInfo[c].bt * oneOverScreenPixelHeight * userScale[1];
-        float scaledGlyphHeight = _glyphCharInfo[c].bh * oneOverScreenPixelHeight * userScale[1];
-
-        // could these be condensed into the "scaled glyph" calulations? yes, but this is clearer to 
-        // me
-        float screenCoordLeft = glyphOriginX - scaledGlyphLeft;
-        float screenCoordRight = screenCoordLeft + scaledGlyphWidth;
-        float screenCoordTop = glyphOriginY + scaledGlyphTop;
-        float screenCoordBottom = screenCoordTop - scaledGlyphHeight;
-
-        // unlike my project "freeglut_glload_render_freetype", which loads glyphs into their own 
-        // textures one at a time (crude, but conveys basics), I can no longer use the whole texture 
-        // and must use the offset info that was stored when the atlas was created
-        // Note: Remember that textures use their own 2D coordinate system (S,T) to avoid confusion 
-        // with screen coordinates (X,Y).
-        float sLeft = _glyphCharInfo[c].tx;//0.0f;
-        float sRight = _glyphCharInfo[c].tx + _glyphCharInfo[c].nbw;//1.0f;
-        float tBottom = _glyphCharInfo[c].ty;
-        float tTop = _glyphCharInfo[c].ty + _glyphCharInfo[c].nbh;
-
-        // OpenGL draws triangles, but a rectangle needs to be drawn, so specify the four corners
-        // of the box in such a way that GL_LINE_STRIP will draw the two triangle halves of the 
-        // box
-        point box[4] = {
-            { screenCoordLeft, screenCoordBottom, sLeft, tTop },
-            { screenCoordRight, screenCoordBottom, sRight, tTop },
-            { screenCoordLeft, screenCoordTop, sLeft, tBottom },
-            { screenCoordRight, screenCoordTop, sRight, tBottom }
-        };
-
-        // copy the info on each of the four corners into the array that was created to store 
-        // them
-        glyphBoxes[(charIndex * 4) + 0] = box[0];
-        glyphBoxes[(charIndex * 4) + 1] = box[1];
-        glyphBoxes[(charIndex * 4) + 2] = box[2];
-        glyphBoxes[(charIndex * 4) + 3] = box[3];
-
-        // advance glyph origin for the next character 
-        glyphOriginX += _glyphCharInfo[c].ax * oneOverScreenPixelWidth;
-        glyphOriginY += _glyphCharInfo[c].ay * oneOverScreenPixelHeight;
-    }
-
-    // the vertex buffer's size is dependent upon string length, and in this demo that value is 
-    // not constant, so the vertex data needs to be completely refreshed every draw call, and 
-    // therefore glBufferData(...) is used instead of glBufferSubData(...) 
-    glBufferData(GL_ARRAY_BUFFER, glyphBoxes.size() * sizeof(point), glyphBoxes.data(), 
-        GL_DYNAMIC_DRAW);
+    // the table goes up in full on the first draw (see UploadGlyphTable())
+    // Note: The compute layout may have made it already.
+    if (_glyphTableSsboId == 0)
+    {
+        glGenBuffers(1, &_glyphTableSsboId);
+        _glyphTableGpuEntries = 0;
+    }
+    glGenVertexArrays(1, &_instancedVaoId);
+    if (_glyphTableSsboId == 0 || _instancedVaoId == 0)
+    {
+        fprintf(stderr, "could not generate instanced glyph buffers\n");
+        return false;
+    }
 
-    // all that so that this one function call will work
-    glDrawArrays(GL_TRIANGLE_STRIP, 0, glyphBoxes.size());
+    return true;
+}
 
-    // cleanup
-    glBindTexture(GL_TEXTURE_2D, 0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glDisable(GL_BLEND);
-    glBlendFunc(0, 0);
+// see RenderText(...) for more detail
+void FreeTypeAtlas::RenderTextInstanced(const std::string &str, const float posPixels[2],
+    const float userScale[2], const float color[4])
+{
+    if (_instancedVaoId == 0)
+    {
+        return;
+    }
+
+    // a new draw call
+    _renderStamp++;
+
+    // one instance per byte at most, straight in the vertex buffer (see RenderText(...))
+    size_t byteOffset = 0;
+    GlyphInstance *instances = (GlyphInstance *)_vertexStream->Reserve(
+        str.length() * sizeof(GlyphInstance), sizeof(GlyphInstance), byteOffset);
+    if (instances == 0)
+    {
+        return;
+    }
+
+    // the texture has to be bound for glyphs to be added to it (see CacheGlyph(...))
+    GlStateCache &glState = GlStateCache::Current();
+    glState.BindTexture(GL_TEXTURE_2D, _textureId);
+
+    // the shader gets the scale in 8.8 fixed point, so advance the pen by the same rounded 
+    // scale or else long strings would slowly drift away from their glyphs
+    GlyphInstance instance;
+    instance.scaleX = GlyphScaleToFixed(userScale[0]);
+    instance.scaleY = GlyphScaleToFixed(userScale[1]);
+    instance.color = PackColor(color);
+    float advanceScale[2] = { instance.scaleX / 256.0f, instance.scaleY / 256.0f };
+
+    // Only the pen moves on the CPU.  Nothing in an instance depends on the texture's size, so 
+    // unlike AppendText(...), nothing needs fixing up if a new glyph makes the atlas grow.
+    size_t instanceCount = 0;
+    float pen[2] = { posPixels[0], posPixels[1] };
+    size_t byteIndex = 0;
+    unsigned int previousCodePoint = 0;
+    while (byteIndex < str.length())
+    {
+        // see AppendText(...)
+        if (PastCullRect(pen, advanceScale))
+        {
+            break;
+        }
+
+        unsigned int codePoint = DecodeUtf8(str.data(), str.length(), byteIndex);
+        pen[0] += _kerning.Find(previousCodePoint, codePoint) * advanceScale[0];
+        previousCodePoint = codePoint;
+        const FreeTypeGlyphCharInfo *glyph = FindGlyph(codePoint);
+        if (glyph == 0)
+        {
+            continue;
+        }
+
+        // whitespace, and glyphs that can't be seen (see SetClipRect(...)), only advance the
+        // pen
+        if (glyph->bw != 0.0f && glyph->bh != 0.0f &&
+            (!_cullEnabled || GlyphQuadOverlaps(*glyph, advanceScale, pen, _cullRect)))
+        {
+            instance.penX = pen[0];
+            instance.penY = pen[1];
+            instance.glyphIndex = glyph->tableIndex;
+            instances[instanceCount++] = instance;
+        }
+
+        pen[0] += glyph->ax * advanceScale[0];
+        pen[1] += glyph->ay * advanceScale[1];
+    }
+    if (instanceCount == 0)
+    {
+        return;
+    }
+
+    UploadGlyphTable();
+
+    // see RenderText(...)
+    // Note: A new glyph may have made the atlas grow, which binds a new texture.
+    glState.EnableAlphaBlend();
+    ApplyScissor();
+    glState.BindTexture(GL_TEXTURE_2D, _textureId);
+    glState.Uniform1i(_instancedUniformTextSamplerLoc, _textureSamplerId);
+
+    // the instances start at their place in the stream by way of the base instance (see
+    // QuadIndexBuffer::DrawQuadInstances(...)), so the vertex array never changes
+    _vertexStream->Commit(instanceCount * sizeof(GlyphInstance));
+    BindInstancedVertexArray();
+
+    // one quad, drawn once per glyph
+    _quadIndexBuffer->DrawQuadInstances(byteOffset / sizeof(GlyphInstance), instanceCount);
+    _vertexStream->Fence();
+}
+
+bool FreeTypeAtlas::InitComputeLayout(const ComputeLayoutProgram &program)
+{
+    _computeLayout = program;
+
+    // the table goes up in full on the first draw (see UploadGlyphTable())
+    // Note: The instanced path may have made it already.
+    if (_glyphTableSsboId == 0)
+    {
+        glGenBuffers(1, &_glyphTableSsboId);
+        _glyphTableGpuEntries = 0;
+    }
+    glGenBuffers(1, &_blockAdvanceSsboId);
+    if (_glyphTableSsboId == 0 || _blockAdvanceSsboId == 0)
+    {
+        fprintf(stderr, "could not generate compute layout buffers\n");
+        return false;
+    }
+    _blockAdvanceCapacity = 0;
+
+    GLint storageBufferAlignment = 0;
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &storageBufferAlignment);
+    _storageBufferAlignment = (unsigned int)std::max(storageBufferAlignment, 1);
+
+    return true;
+}
+
+// see RenderText(...) for more detail
+void FreeTypeAtlas::RenderTextCompute(const std::string &str, const float posPixels[2],
+    const float userScale[2], const float color[4])
+{
+    size_t firstVertex = 0;
+    size_t glyphCount = 0;
+    if (!DispatchComputeLayout(str, posPixels, userScale, color, firstVertex, glyphCount))
+    {
+        return;
+    }
+    glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+
+    // from here on it is RenderText(...), only with quads that the GPU wrote
+    // Note: A new glyph may have made the atlas grow, which binds a new texture.
+    GlStateCache &glState = GlStateCache::Current();
+    glState.UseProgram(_computeLayout.drawProgramId);
+    glState.EnableAlphaBlend();
+    ApplyScissor();
+    glState.BindTexture(GL_TEXTURE_2D, _textureId);
+    glState.Uniform1i(_uniformTextSamplerLoc, _textureSamplerId);
+    BindTextVertexArray();
+    _quadIndexBuffer->DrawQuads(firstVertex, glyphCount);
+    _vertexStream->Fence();
+}
+
+void FreeTypeAtlas::ReadBackTextCompute(const std::string &str, const float posPixels[2],
+    const float userScale[2], const float color[4], std::vector<TextVertex> &vertices)
+{
+    vertices.clear();
+    size_t firstVertex = 0;
+    size_t glyphCount = 0;
+    if (!DispatchComputeLayout(str, posPixels, userScale, color, firstVertex, glyphCount))
+    {
+        return;
+    }
+
+    // Note: The stream is mapped, but its mapping is only coherent with what the GPU has
+    // finished, so reading it would need a fence and a wait anyway.  glGetBufferSubData(...)
+    // waits by itself, and it is allowed on a persistently mapped buffer.
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    vertices.resize(glyphCount * VerticesPerQuad);
+    glBindBuffer(GL_COPY_READ_BUFFER, _vertexStream->BufferId());
+    glGetBufferSubData(GL_COPY_READ_BUFFER, (GLintptr)(firstVertex * sizeof(TextVertex)),
+        (GLsizeiptr)(vertices.size() * sizeof(TextVertex)), vertices.data());
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    _vertexStream->Fence();
+
+    // the same program is in use afterwards as after RenderTextCompute(...)
+    GlStateCache::Current().UseProgram(_computeLayout.drawProgramId);
+}
+
+bool FreeTypeAtlas::DispatchComputeLayout(const std::string &str, const float posPixels[2],
+    const float userScale[2], const float color[4], size_t &firstVertex, size_t &glyphCount)
+{
+    if (_blockAdvanceSsboId == 0)
+    {
+        return false;
+    }
+    if (str.length() > MaxComputeLayoutGlyphs)
+    {
+        fprintf(stderr, "%u bytes is too long to lay out on the GPU\n",
+            (unsigned int)str.length());
+        return false;
+    }
+
+    // a new draw call
+    _renderStamp++;
+
+    // One reservation holds both the glyph indices that go in and the quads that come out,
+    // so that the stream can't be made anew in between (see StreamBuffer::Reserve(...)).
+    // Note: The compute shader sees both as storage buffer ranges, which have to start on the
+    // driver's alignment, and the quads also have to start on a whole vertex for the draw.
+    // A vertex is 20 bytes and the alignment is a power of 2, so the stride is the smallest
+    // multiple of both.
+    size_t stride = LeastCommonMultiple(_storageBufferAlignment, sizeof(TextVertex));
+    size_t indexBytes = (((str.length() * sizeof(LayoutGlyph)) + stride - 1) / stride) * stride;
+    size_t byteOffset = 0;
+    unsigned char *reserved = (unsigned char *)_vertexStream->Reserve(
+        indexBytes + (VerticesPerQuad * str.length() * sizeof(TextVertex)), stride, byteOffset);
+    if (reserved == 0)
+    {
+        return false;
+    }
+
+    // the texture has to be bound for glyphs to be added to it (see CacheGlyph(...))
+    GlStateCache &glState = GlStateCache::Current();
+    glState.BindTexture(GL_TEXTURE_2D, _textureId);
+
+    // This is all that is left of the per-glyph loop on the CPU: one table index per glyph,
+    // and the kerning between it and the next one, straight into the stream.  Nothing here
+    // depends on the pen or the texture's size.
+    // Note: A new glyph may make the atlas grow, which moves the entries of the glyphs that
+    // have no cell (see GrowAtlas()), so if that happens, go through again.  The second time
+    // through, every glyph is already in the atlas.
+    // Also Note: A code point that has no glyph is left out, so its pairs' kerning goes on
+    // the glyph before it, which is where AppendText(...) would have put the pen.
+    LayoutGlyph *layoutGlyphs = (LayoutGlyph *)reserved;
+    glyphCount = 0;
+    unsigned int layoutGeneration = 0;
+    do
+    {
+        layoutGeneration = _layoutGeneration;
+        glyphCount = 0;
+        size_t byteIndex = 0;
+        unsigned int previousCodePoint = 0;
+        while (byteIndex < str.length())
+        {
+            unsigned int codePoint = DecodeUtf8(str.data(), str.length(), byteIndex);
+            float kerning = _kerning.Find(previousCodePoint, codePoint);
+            previousCodePoint = codePoint;
+            if (glyphCount > 0)
+            {
+                layoutGlyphs[glyphCount - 1].kerningAfter += kerning;
+            }
+
+            const FreeTypeGlyphCharInfo *glyph = FindGlyph(codePoint);
+            if (glyph == 0)
+            {
+                continue;
+            }
+            LayoutGlyph layoutGlyph = { glyph->tableIndex, 0.0f };
+            layoutGlyphs[glyphCount++] = layoutGlyph;
+        }
+    } while (_layoutGeneration != layoutGeneration);
+    if (glyphCount == 0)
+    {
+        return false;
+    }
+
+    size_t vertexBytes = glyphCount * VerticesPerQuad * sizeof(TextVertex);
+    _vertexStream->Commit(indexBytes + vertexBytes);
+    UploadGlyphTable();
+
+    // one sum of advances per work group, which the second pass turns into where each work
+    // group's pen starts
+    GLuint groupCount = (GLuint)((glyphCount + LayoutGroupSize - 1) / LayoutGroupSize);
+    if (groupCount > _blockAdvanceCapacity)
+    {
+        _blockAdvanceCapacity = groupCount;
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, _blockAdvanceSsboId);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, _blockAdvanceCapacity * 2 * sizeof(float), 0,
+            GL_DYNAMIC_COPY);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+
+    // the table is at binding point 0 already (see UploadGlyphTable())
+    // Note: The state cache only keeps track of binding point 0, so these go straight to
+    // OpenGL.
+    GLuint streamId = _vertexStream->BufferId();
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 1, streamId, (GLintptr)byteOffset,
+        (GLsizeiptr)(glyphCount * sizeof(LayoutGlyph)));
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, _blockAdvanceSsboId);
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 3, streamId,
+        (GLintptr)(byteOffset + indexBytes), (GLsizeiptr)vertexBytes);
+
+    // Note: The uniforms are unsigned ints and vec2s, which the state cache doesn't do, and
+    // the pass changes three times per string anyway.  glProgramUniform*(...) doesn't care
+    // which program is bound.
+    GLuint programId = _computeLayout.programId;
+    glProgramUniform1ui(programId, _computeLayout.uniformGlyphCountLoc, (GLuint)glyphCount);
+    glProgramUniform2fv(programId, _computeLayout.uniformPenStartLoc, 1, posPixels);
+    glProgramUniform2fv(programId, _computeLayout.uniformUserScaleLoc, 1, userScale);
+    glProgramUniform2f(programId, _computeLayout.uniformAtlasSizeLoc, (float)_atlasWidth,
+        (float)_atlasHeight);
+    glProgramUniform1ui(programId, _computeLayout.uniformTextColorLoc, PackColor(color));
+    glState.UseProgram(programId);
+
+    // pass 0 adds up each work group's advances, pass 1 turns those sums into where each work
+    // group starts (one work group does all of them), and pass 2 finds each glyph's pen
+    // within its work group and writes its quad
+    // Note: Each pass reads what the one before it wrote, so each one has to wait for the one
+    // before it to finish writing, and whatever reads the quads has to wait for them.
+    glProgramUniform1ui(programId, _computeLayout.uniformLayoutPassLoc, 0);
+    glDispatchCompute(groupCount, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    glProgramUniform1ui(programId, _computeLayout.uniformLayoutPassLoc, 1);
+    glDispatchCompute(1, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    glProgramUniform1ui(programId, _computeLayout.uniformLayoutPassLoc, 2);
+    glDispatchCompute(groupCount, 1, 1);
+
+    firstVertex = (byteOffset + indexBytes) / sizeof(TextVertex);
+    return true;
 }
@@ -1,35 +1,320 @@
 #pragma once
 
-// there doesn't seem to be any way out of including all of FreeType without some shady forward 
-// declarations of FreeType internal structures
-// Note: FreeType has a single header for everything.  This is evil.
-#include <ft2build.h>
-#include FT_FREETYPE_H  // also defined relative to "freetype-2.6.1/include/"
+// for the packing method and the report on how well the glyphs packed
+#include "GlyphPacker.h"
 
+// for rasterizing and keeping glyphs that weren't in the prebuilt set
+#include "GlyphCache.h"
+
+// for the glyphs that are rasterized on demand
+#include "GlyphArena.h"
+
+// for the report on how well a compressed atlas compressed
+#include "Bc4Encoder.h"
+
+// for the glyph metrics and the vertices that they become
+#include "GlyphQuads.h"
+
+// for spacing pairs of glyphs with the font's kerning
+#include "KerningTable.h"
+
+#include <functional>   // for rasterizing glyphs without knowing about FreeType
+#include <memory>       // for the shared index buffer
 #include <string>
+#include <unordered_map>
+#include <vector>
+
+// the atlas that the builder makes or that was loaded from a file (see AtlasImage.h)
+struct AtlasImageView;
+
+// every atlas draws its quads with the same index buffer (see QuadIndexBuffer.h)
+class QuadIndexBuffer;
+
+// and writes its vertices into the same mapped vertex buffer (see StreamBuffer.h)
+class StreamBuffer;
+
+// the program that lays text out on the GPU (see shader_layout.comp) and the locations of its
+// uniforms, which FreeTypeEncapsulate::InitComputeLayoutProgram(...) looks up
+// Note: Actually GLuints and GLints (see _textureId in FreeTypeAtlas).
+struct ComputeLayoutProgram
+{
+    unsigned int programId;
 
+    // the regular program (see FreeTypeEncapsulate::Init(...)), which draws the quads that
+    // the compute program wrote
+    unsigned int drawProgramId;
+
+    int uniformLayoutPassLoc;
+    int uniformGlyphCountLoc;
+    int uniformPenStartLoc;
+    int uniformUserScaleLoc;
+    int uniformAtlasSizeLoc;
+    int uniformTextColorLoc;
+};
+
+// Note: Despite the name, the atlas itself never calls FreeType.  The glyphs come to it 
+// already rasterized, either from FreeTypeEncapsulate or from a baked atlas (see AtlasBaker.cpp),
+// so a program that only draws baked atlases doesn't need to link FreeType at all.
 class FreeTypeAtlas
 {
 public:
-    // the FT_Face type is a pointer, so don't use a reference or pointer
-    FreeTypeAtlas(const int uniformTextSamplerLoc, const int uniformTextColorLoc);
+    // rasterizes a glyph that is not in the prebuilt set into the arena
+    // Note: An atlas that was loaded from the disk cache might never need a glyph that isn't 
+    // in it, so whoever provides this should hold off on starting FreeType until the first 
+    // call.
+    // returns: false if there is nothing to rasterize glyphs with, in which case it won't be 
+    // called again and those glyphs are simply not drawn
+    typedef std::function<bool(const unsigned int codePoint, GlyphArena &arena)> GlyphSource;
 
-    bool Init(const FT_Face face, const int fontPixelHeightSize);
+    FreeTypeAtlas(const int uniformTextSamplerLoc);
+
+    // uploads an atlas that was already built (see AtlasBuilder.h), memory-mapped from the 
+    // disk cache (see AtlasDiskCache.h), or baked into the program (see AtlasBaker.cpp)
+    // Note: The view only has to stay valid until this returns.
+    // Also Note: Without a glyph source, only the atlas' own glyphs can be drawn.
+    // Also Also Note: A compressed atlas (see Bc4Encoder.h) takes half of the video memory, 
+    // but it can't take glyphs on demand, so the glyph source is ignored.
+    bool Init(const AtlasImageView &atlas, const GlyphSource &glyphSource = GlyphSource(),
+        const bool compress = false);
 
     ~FreeTypeAtlas();
 
-    // position is in screen coordinates of the OpenGL display, which on the range 
-    // [-0.999f, +0.999f], and note that the range is technically [-1,+1] but in practice an X
-    // of -1 will not render
+    // position is in pixels from the bottom left corner of the window, and it is the pen
+    // position of the first glyph (the left end of its baseline)
+    // Note: Pixels become screen coordinates in the vertex shader (see
+    // FreeTypeEncapsulate::SetViewportSize(...)), so nothing here depends on the window's size.
+
+    // Note: These are not const because a character that the atlas hasn't seen yet is 
+    // rasterized and added to the atlas' texture on the spot.
+    // Also Note: The color goes into every vertex (see PackColor(...)), not into a uniform.
 
     // render a single char (demonstrates most simple drawing of a single char)
-    void RenderChar(const char c, const float posScreenCoord[2], const float userScale[2],
-        const float color[4]) const;
+    void RenderChar(const unsigned int codePoint, const float posPixels[2],
+        const float userScale[2], const float color[4]);
+
+    // render a UTF-8 string (demonstrates use of glyph "advance" value between characters)
+    // Note: The advance is scaled along with the glyphs, so scaled text doesn't overlap itself.
+    // Also Note: Pairs of prebuilt glyphs are kerned too (see Kerning(...)).
+    void RenderText(const std::string &str, const float posPixels[2],
+        const float userScale[2], const float color[4]);
+
+    // same as above, for text that isn't in a std::string, like a line of a memory-mapped
+    // file (see TextFileView.h)
+    // Note: The bytes don't need a terminating 0, and nothing is copied.
+    // Also Note: Room for 4 vertices per byte is still reserved up front (see
+    // AppendText(...)), so a line that could be megabytes long should go through TextFileView,
+    // which stops at the panel's edge.
+    void RenderText(const char *str, const size_t length, const float posPixels[2],
+        const float userScale[2], const float color[4]);
+
+    // for drawing text from many strings (and many atlases) with one buffer upload (see 
+    // TextBatch.h), in place of RenderText(...)
+
+    // binds the atlas' texture and starts a new draw call as far as the glyph cache is 
+    // concerned, so that no glyph that is appended after this is evicted before the draw
+    void BeginBatch();
 
-    // render a string (demonstrates use of glyph "advance" value between characters)
-    void RenderText(const std::string &str, const float posScreenCoord[2], 
-        const float userScale[2], const float color[4]) const;
+    // writes a quad (4 vertices; see GlyphQuads.h) for every glyph in a UTF-8 string, 
+    // starting at vertices[vertexCount]
+    // returns: the new vertex count
+    // color: packed (see PackColor(...)), so a batch can mix colors freely
+    // Note: There must be room for 4 vertices per byte of the string.  The vertices can be 
+    // mapped GPU memory (see StreamBuffer.h).
+    // Also Note: A glyph that isn't in the atlas yet is added on the spot.  If that makes the 
+    // atlas grow, every vertex from firstVertex onward has its T coordinate moved to the new 
+    // texture, so everything since BeginBatch() should start at firstVertex.  That reads the 
+    // vertices back, which is slow from mapped memory, but it only happens when the atlas 
+    // grows.
+    size_t AppendText(const std::string &str, const float posPixels[2],
+        const float userScale[2], const unsigned int color, TextVertex *vertices,
+        const size_t firstVertex, const size_t vertexCount);
+
+    // same as above, for text that isn't in a std::string (see RenderText(...))
+    size_t AppendText(const char *str, const size_t length, const float posPixels[2],
+        const float userScale[2], const unsigned int color, TextVertex *vertices,
+        const size_t firstVertex, const size_t vertexCount);
+
+    // writes the quad for one glyph at the pen and moves the pen by the glyph's advance, for
+    // text that is rewritten one glyph at a time (see TextMesh.h)
+    // Note: Call BeginBatch() first.  The pen is in pixels (see MakeGlyphQuad(...)).
+    // Also Note: A glyph that can't be drawn gets an empty quad (every corner at the pen) and
+    // doesn't move the pen, so every code point has exactly one quad.  Unlike AppendText(...),
+    // quads that were made earlier are not fixed up if the atlas grows, so check
+    // LayoutGeneration() afterwards.
+    // Also Also Note: Only one glyph is known here, so it isn't kerned against the one before
+    // it.  Move the pen by Kerning(...) first.
+    void AppendGlyph(const unsigned int codePoint, const float userScale[2],
+        const unsigned int color, float pen[2], TextVertex corners[VerticesPerQuad]);
+
+    // returns: how far the pen moves between the two glyphs, on top of the left one's
+    // advance, in unscaled pixels (usually negative), or 0 if the font doesn't kern the pair
+    // Note: The pairs were looked up when the atlas was built (see ExtractKerning(...)), so
+    // this is a table lookup, not a call to FreeType (see KerningTable.h).  Only pairs of
+    // prebuilt glyphs are kerned; glyphs that are rasterized on demand only have advances.
+    float Kerning(const unsigned int left, const unsigned int right) const;
+
+    // binds the atlas' texture, sets the sampler uniform, and sets up the scissor test (see
+    // SetClipRect(...)) for a batched draw
+    // Note: Like every draw, this goes through the state cache (see GlStateCache.h), so
+    // drawing one batch after another with the same atlas doesn't bind anything again.
+    void BindForBatch() const;
+
+    // goes up by 1 whenever quads that were made earlier could be wrong now, which is when
+    // the atlas grows (the T coordinates move) or a glyph is evicted (its cell now holds
+    // another glyph)
+    // Note: Quads that are kept around between frames (see TextMesh.h) are made again when
+    // this changes.
+    unsigned int LayoutGeneration() const;
+
+    // for drawing with one small instance per glyph instead of 4 vertices (see 
+    // GlyphInstance in GlyphQuads.h and shader_instanced.vert)
+
+    // makes the buffers for the instances and for the glyph table, which the vertex shader 
+    // makes each glyph's quad from
+    // Note: Call after Init(...).  The locations are the instanced program's (see 
+    // FreeTypeEncapsulate::InitInstancedProgram(...)).
+    // returns: false if the buffers couldn't be made, in which case RenderTextInstanced(...) 
+    // draws nothing
+    bool InitInstanced(const int uniformTextSamplerLoc);
+
+    // same as RenderText(...), but 20 bytes go up per glyph instead of 80
+    // Note: The instanced program must be in use, not the regular one.
+    void RenderTextInstanced(const std::string &str, const float posPixels[2],
+        const float userScale[2], const float color[4]);
+
+    // for laying text out on the GPU with a compute shader (OpenGL 4.3) instead of glyph by
+    // glyph on the CPU (see shader_layout.comp)
+
+    // makes the buffers that the compute shader reads and writes
+    // Note: Call after Init(...).  The glyph table is the same one that the instanced path
+    // uses, so an atlas that does both only keeps one.
+    // returns: false if the buffers couldn't be made, in which case RenderTextCompute(...)
+    // draws nothing
+    bool InitComputeLayout(const ComputeLayoutProgram &program);
+
+    // same as RenderText(...), but the pens and the quads are worked out on the GPU
+    // Note: The CPU only decodes the string and finds each glyph's entry in the table, which
+    // it has to do anyway to rasterize glyphs that are new, and its kerning with the next
+    // one.  The pen positions are a prefix sum of the advances, so the GPU does them in
+    // parallel and writes the quads straight into the vertex stream, where the regular program
+    // draws them.
+    // Also Note: The regular program should be in use, and it still is afterwards.
+    void RenderTextCompute(const std::string &str, const float posPixels[2],
+        const float userScale[2], const float color[4]);
+
+    // same as RenderTextCompute(...), but the quads that the GPU wrote are read back into
+    // the vertices instead of drawn, for checking them against AppendText(...) (see
+    // ComputeLayoutCheck.cpp)
+    // Note: This waits for the GPU to finish, so it is for tests, not for drawing.
+    // Also Note: The vertices are emptied first, and stay empty if nothing was laid out.
+    void ReadBackTextCompute(const std::string &str, const float posPixels[2],
+        const float userScale[2], const float color[4], std::vector<TextVertex> &vertices);
+
+    // for skipping the glyphs that can't be seen, and for clipping text to a panel
+    // Note: RenderText(...), RenderChar(...), RenderTextInstanced(...), and AppendText(...)
+    // (and therefore TextBatch) check each glyph before writing anything for it, and a glyph
+    // that is entirely outside of the window and the clip rectangle is skipped.  Once the pen
+    // has gone past the right edge, or if the whole line is above or below them, the rest of
+    // the string isn't even looked at.  A long scrolling panel only sends up the glyphs that
+    // are on screen.
+    // Also Note: RenderTextCompute(...) doesn't know where the pens are on the CPU, so it
+    // sends everything, and TextMesh keeps every quad so that it can compare text quad by
+    // quad.  Both are still cut off by the scissor test, if there is one.
+
+    // glyphs that are entirely outside of the window are skipped
+    // Note: FreeTypeEncapsulate::SetViewportSize(...) calls this for every atlas that it
+    // made, so there is usually no need to call it directly.  Until it is called, only the
+    // clip rectangle skips anything.
+    void SetViewportSize(const int width, const int height);
+
+    // glyphs that are entirely outside of the rectangle (left, bottom, right, and top, in
+    // pixels from the window's bottom left corner) are skipped too
+    // scissor: if true, the glyphs that straddle the rectangle's edges are also cut off at
+    // them, by the scissor test, so that nothing is drawn outside of it
+    // Note: Skipping only ever leaves out whole glyphs, so without the scissor test, a glyph
+    // that is partly inside is drawn in full.
+    // Also Note: The rectangle applies to every draw from this atlas until it is changed or
+    // cleared, and a TextBatch uses whichever rectangle the atlas has when it is flushed.
+    // The scissor test stays on until the next draw from an atlas that has no scissor
+    // rectangle, like the rest of the state that text drawing leaves behind (see
+    // GlStateCache.h).
+    void SetClipRect(const float clipPixels[4], const bool scissor);
+    void ClearClipRect();
+
+    // atlas dimensions, occupancy, and wasted bytes from Init(...)
+    const PackReport &GetPackReport() const;
+
+    // size and quality of the compressed atlas, or all 0s if the atlas isn't compressed
+    const CompressionReport &GetCompressionReport() const;
 private:
+    // sends an atlas that was assembled in CPU memory to the GPU in one go and records each 
+    // glyph's texture coordinates
+    // Note: The texture also gets room for glyphs that are rasterized on demand.
+    bool UploadAtlas(const AtlasImageView &atlas);
+
+    // same as above, but compresses the atlas first and leaves no room for the glyph cache
+    // Note: The texture is padded up to whole 4x4 blocks.
+    bool UploadCompressedAtlas(const AtlasImageView &atlas);
+
+    // sets up sampling for the texture that was just uploaded, records the prebuilt glyphs' 
+    // texture coordinates, and makes the vertex buffer
+    bool FinishUpload(const AtlasImageView &atlas);
+
+    struct FreeTypeGlyphCharInfo;
+
+    // returns: the glyph's info, rasterizing it first if necessary, or null if there is no 
+    // room for it right now
+    const FreeTypeGlyphCharInfo *FindGlyph(const unsigned int codePoint);
+    const FreeTypeGlyphCharInfo *CacheGlyph(const unsigned int codePoint);
+
+    // doubles the glyph cache's rows of cells by moving the atlas into a taller texture, 
+    // copying the old one over on the GPU, and rescaling every glyph's T coordinates
+    // Note: Nothing is rasterized again, and the glyph pixels never come back to the CPU.
+    // returns: false if the texture is already as tall as it can be, otherwise true
+    bool GrowAtlas();
+
+    // binds the vertex array for RenderChar(...) and RenderText(...), or for
+    // RenderTextInstanced(...), and points it at the vertex stream if the stream has been
+    // made anew since it was last set up
+    void BindTextVertexArray();
+    void BindInstancedVertexArray();
+
+    // writes a glyph's entry in the glyph table
+    void SetGlyphTableEntry(const unsigned int tableIndex, const FreeTypeGlyphCharInfo &info, 
+        const unsigned int texelX, const unsigned int texelY);
+
+    // gives a glyph that has no cell (whitespace, or too big for one) an entry at the end of
+    // the glyph table, for its advance, and keeps it
+    const FreeTypeGlyphCharInfo *AddGlyphWithoutCell(const unsigned int codePoint,
+        FreeTypeGlyphCharInfo &info);
+
+    // sends up the entries of the glyph table that changed since the last time, or all of it
+    // if it has grown, and binds it to storage buffer binding point 0
+    void UploadGlyphTable();
+
+    // the part of RenderTextCompute(...) that lays the string out, up to the quads being in
+    // the vertex stream
+    // firstVertex: where the quads start in the stream, in vertices
+    // returns: false if nothing was laid out, otherwise true
+    // Note: The compute program is left in use, and the quads can't be read until the caller
+    // puts in a memory barrier for however it reads them.  The caller also fences the stream.
+    bool DispatchComputeLayout(const std::string &str, const float posPixels[2],
+        const float userScale[2], const float color[4], size_t &firstVertex,
+        size_t &glyphCount);
+
+    // widens the extents of every glyph that the atlas can draw to take in a new one
+    void IncludeGlyphExtents(const GlyphQuadMetrics &glyph);
+
+    // works out the rectangle that glyphs are culled against from the window's size and the
+    // clip rectangle
+    void UpdateCullRect();
+
+    // returns: true if no glyph at this pen, or at any pen after it in the string, can be seen
+    bool PastCullRect(const float pen[2], const float userScale[2]) const;
+
+    // turns the scissor test on for the clip rectangle, if it asked for one, or off
+    void ApplyScissor() const;
+
     // have to reference it on every draw call, so keep it around
     // Note: It is actually a GLuint, which is a typedef of "unsigned int", but I don't want to 
     // include all of the OpenGL declarations in a header file, so just use the original type.
@@ -38,49 +323,146 @@ private:
     unsigned int _textureId;
 
     // the atlas needs access to a vertex buffer
-    // Note: Let the atlas make one.  The FreeType encapsulation could do this, but I am hesitant
-    // to make a buffer object that would be used by potentially multiple atlases, so let the 
-    // atlas make its own.
-    unsigned int _vboId;
+    // Note: This used to be one buffer per atlas that was reallocated with glBufferData(...) 
+    // on every draw.  Now every atlas writes into the same persistently mapped ring, which 
+    // never reallocates and keeps track of what the GPU might still be reading.
+    std::shared_ptr<StreamBuffer> _vertexStream;
+
+    // the indices that turn every 4 vertices into a quad, shared with every other atlas
+    std::shared_ptr<QuadIndexBuffer> _quadIndexBuffer;
 
     // which sampler to use (0 - GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS (??you sure??)
     // Note: Technically it is a GLint, but is simple int here for the same reason 
     // "texture ID" is an unsigned int instead of GLuint.
     int _textureSamplerId;
 
-    // the FreeType glyph set provides the basic printable ASCII character set, and even though 
-    // the first 31 are not visible and will therefore not be loaded, the useless bytes are an 
-    // acceptable tradeoff for rapid ASCII character lookup
-    struct FreeTypeGlyphCharInfo {
-        // advance X and Y for screen coordinate calculations
-        float ax;
-        float ay;
-
-        // bitmap left and top for screen coordinate calculations
-        float bl;
-        float bt;
-
-        // glyph bitmap width and height for screen coordinate calculations
-        float bw;
-        float bh;
-
-        // glyph bitmap width and height normalized to [0.0,1.0] for texture coordinate calculations
-        // Note: It is better for performance to do the normalization (a division) at startup.
-        float nbw;
-        float nbh;
-
-        // TODO: change to "texture S" and "texture T" to be clear
-        float tx;	// x offset of glyph in texture coordinates (S on range [0.0,1.0])
-        float ty;	// y offset of glyph in texture coordinates (T on range [0.0,1.0])
-    } _glyphCharInfo[128];
-
-    // the atlas needs to tell the fragment shader which texture sampler and texture color 
-    // (FreeType only provides alpha channel) to use, it does that via uniform, and to use 
-    // it the atlas should store the uniform's location
+    // everything needed to draw a glyph, looked up by code point
+    struct FreeTypeGlyphCharInfo : GlyphQuadMetrics
+    {
+        // the glyph's entry in the glyph table
+        // Note: Prebuilt glyphs come first, in the atlas' order, followed by one entry per 
+        // glyph cache cell, followed by the glyphs that were added later but have no cell
+        // (see AddGlyphWithoutCell(...)).  Glyphs with no pixels (whitespace) are never
+        // drawn, but the compute layout still needs their advance.
+        unsigned int tableIndex;
+    };
+    std::unordered_map<unsigned int, FreeTypeGlyphCharInfo> _glyphCharInfo;
+
+    // the prebuilt glyphs never leave the atlas, so pointers to them never go bad, and most 
+    // text is ASCII, so keep a direct lookup for those and skip the hashing
+    // Note: Entries are null for characters that were not in the prebuilt set.
+    const FreeTypeGlyphCharInfo *_asciiGlyphCharInfo[128];
+
+    // for rasterizing glyphs on demand
+    GlyphSource _glyphSource;
+
+    // texture dimensions in pixels
+    unsigned int _atlasWidth;
+    unsigned int _atlasHeight;
+
+    // 1 unless the atlas' glyphs were spaced out for mipmaps (see AtlasMipmaps.h)
+    // Note: Every cell, and the texture itself, is a multiple of the mip alignment, so each 
+    // level is exactly half of the one before it and a cell can be updated on every level.
+    unsigned int _mipLevels;
+
+    // GL_MAX_TEXTURE_SIZE, which caps how far the atlas can grow
+    unsigned int _maxTextureSize;
+
+    // the cache's grid of cells starts below the prebuilt glyphs
+    unsigned int _cellOriginY;
+    unsigned int _cellWidth;
+    unsigned int _cellHeight;
+    unsigned int _cellColumns;
+    GlyphCache _glyphCache;
+
+    // bumped on every draw call so that the cache won't evict a glyph that the draw call 
+    // being assembled still needs
+    unsigned int _renderStamp;
+
+    // see LayoutGeneration()
+    unsigned int _layoutGeneration;
+
+    // the prebuilt glyphs' kerning pairs (see Kerning(...))
+    KerningTable _kerning;
+
+    // reused for every cell upload
+    std::vector<unsigned char> _cellPixels;
+    std::vector<unsigned char> _cellMipPixels;
+
+    // the atlas needs to tell the fragment shader which texture sampler to use, it does
+    // that via uniform, and to use it the atlas should store the uniform's location
     // Note: Actually a GLint.
     // Also Note: The FreeType encapsulation is responsible for the texture atlas' shader 
-    // program, and it will provide these values.
+    // program, and it will provide this value.
+    // Also Also Note: There used to be a color uniform too (FreeType only provides the alpha
+    // channel), but the color is in the vertices now.
     int _uniformTextSamplerLoc;
-    int _uniformTextColorLoc;
+
+    // the glyph table for the instanced path and the compute layout, which lives in a
+    // GL_SHADER_STORAGE_BUFFER
+    // Note: The table is in pixels and texels, so growing the atlas only adds entries for the 
+    // new cells.  Entries that changed since the last draw are sent up right before the next 
+    // one, and only those.
+    std::vector<GlyphTableEntry> _glyphTable;
+    unsigned int _prebuiltGlyphCount;
+    size_t _glyphTableDirtyBegin;
+    size_t _glyphTableDirtyEnd;
+    size_t _glyphTableGpuEntries;
+
+    // actually a GLuint (see _textureId); 0 until InitInstanced(...) or
+    // InitComputeLayout(...)
+    // Note: The instances themselves go into the vertex stream.
+    unsigned int _glyphTableSsboId;
+
+    // one vertex array for each vertex layout, with the stream generation (see
+    // StreamBuffer::Generation()) that each one was last pointed at, or 0 if never
+    // Note: Actually GLuints.
+    unsigned int _vaoId;
+    unsigned int _vaoStreamGeneration;
+    unsigned int _instancedVaoId;
+    unsigned int _instancedVaoStreamGeneration;
+
+    // the instanced program's sampler uniform
+    // Note: Actually a GLint.
+    int _instancedUniformTextSamplerLoc;
+
+    // the compute layout's program, and the buffer that it adds up each work group's
+    // advances in (see shader_layout.comp)
+    // Note: The buffer is actually a GLuint, 0 until InitComputeLayout(...), and it only ever
+    // grows.  The glyph indices and the quads go into the vertex stream.
+    ComputeLayoutProgram _computeLayout;
+    unsigned int _blockAdvanceSsboId;
+    size_t _blockAdvanceCapacity;
+
+    // GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, which the ranges of the vertex stream that
+    // the compute shader reads and writes have to start on
+    unsigned int _storageBufferAlignment;
+
+    // see SetViewportSize(...) and SetClipRect(...)
+    // Note: The cull rectangle is the part of the window that is inside the clip rectangle,
+    // and it is only worked out when one of them changes, not on every glyph.
+    int _viewportWidth;
+    int _viewportHeight;
+    bool _hasClipRect;
+    bool _scissorClip;
+    PixelRect _clipRect;
+    bool _cullEnabled;
+    PixelRect _cullRect;
+
+    // how far, in unscaled pixels, any glyph that the atlas can draw reaches from its pen
+    // (see PastCullRect(...))
+    // Note: The rest of a string can only be skipped if no glyph can reach back past where
+    // the pen is now.  Glyphs that haven't been rasterized yet aren't known, so an atlas with
+    // a glyph cache widens the extents by a whole cell (the biggest glyph that it takes) in
+    // every direction.
+    // Also Note: That also needs the pen to only ever move right, which it does in fonts that
+    // are written left to right.  A glyph that moves it any other way turns skipping the rest
+    // of a string off.
+    PixelRect _glyphExtents;
+    bool _advancesOnlyRight;
+
+    // kept around so that users can compare packers on their own fonts
+    PackReport _packReport;
+    CompressionReport _compressionReport;
 };
 
@@ -0,0 +1,272 @@
+#include "FreeTypeAtlasArray.h"
+#include "AtlasImage.h"
+#include "Utf8.h"
+#include "QuadIndexBuffer.h"
+#include "StreamBuffer.h"
+#include "GlStateCache.h"
+
+// the OpenGL version include also includes all previous versions
+// Build note: Do NOT mistakenly include _int_gl_4_4.h.  That one doesn't define OpenGL stuff 
+// first.
+#include "glload/include/glload/gl_4_4.h"
+
+#include <stddef.h>     // for offsetof(...)
+#include <stdio.h>      // for fprintf(...)
+#include <string.h>     // for memset(...), memcpy(...)
+
+#include <algorithm>    // for std::max
+
+FreeTypeAtlasArray::FreeTypeAtlasArray(const int uniformTextSamplerLoc) :
+    _textureId(0),
+    _textureSamplerId(0),
+    _uniformTextSamplerLoc(uniformTextSamplerLoc),
+    _vaoId(0),
+    _vaoStreamGeneration(0),
+    _layerWidth(0),
+    _layerHeight(0)
+{
+}
+
+FreeTypeAtlasArray::~FreeTypeAtlasArray()
+{
+    GlStateCache &glState = GlStateCache::Current();
+    glState.Forget(GL_TEXTURE_2D_ARRAY, _textureId);
+    glDeleteTextures(1, &_textureId);
+    glState.Forget(GL_VERTEX_ARRAY, _vaoId);
+    glDeleteVertexArrays(1, &_vaoId);
+}
+
+bool FreeTypeAtlasArray::Init(const std::vector<AtlasImageView> &atlases)
+{
+    if (atlases.empty())
+    {
+        fprintf(stderr, "A texture array atlas needs at least one atlas\n");
+        return false;
+    }
+
+    // every layer has to be big enough for the biggest atlas
+    _layerWidth = 0;
+    _layerHeight = 0;
+    for (size_t atlasIndex = 0; atlasIndex < atlases.size(); atlasIndex++)
+    {
+        _layerWidth = std::max(_layerWidth, atlases[atlasIndex].width);
+        _layerHeight = std::max(_layerHeight, atlases[atlasIndex].height);
+    }
+
+    // texture arrays have their own limit on the number of layers (at least 2048 in OpenGL 4.x)
+    GLint maxLayers;
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+    if (atlases.size() > (size_t)maxLayers)
+    {
+        fprintf(stderr, "%u atlases is more than the %d layers that a texture array can have\n",
+            (unsigned int)atlases.size(), maxLayers);
+        return false;
+    }
+
+    glGenTextures(1, &_textureId);
+    GlStateCache::Current().BindTexture(GL_TEXTURE_2D_ARRAY, _textureId);
+
+    // see FreeTypeAtlas::UploadAtlas(...) for the details on the formats and the alignment
+    GLint level = 0;
+    GLint internalFormat = GL_RED;
+    GLint providedFormat = GL_RED;
+    GLenum providedFormatDataType = GL_UNSIGNED_BYTE;
+    GLint border = 0;
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    // allocate every layer at once, zero the whole thing on the GPU so that the parts of a 
+    // layer that its atlas doesn't cover are transparent, and then send each atlas into the 
+    // top left of its own layer straight from wherever it is
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, level, internalFormat, _layerWidth, _layerHeight, 
+        (GLsizei)atlases.size(), border, providedFormat, providedFormatDataType, 0);
+    unsigned char zero = 0;
+    glClearTexImage(_textureId, level, providedFormat, providedFormatDataType, &zero);
+
+    _layers.clear();
+    _layers.resize(atlases.size());
+    for (size_t layerIndex = 0; layerIndex < atlases.size(); layerIndex++)
+    {
+        const AtlasImageView &atlas = atlases[layerIndex];
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, (GLint)layerIndex, atlas.width, 
+            atlas.height, 1, providedFormat, providedFormatDataType, atlas.pixels);
+
+        Layer &layer = _layers[layerIndex];
+        memset(layer.asciiGlyphs, 0, sizeof(layer.asciiGlyphs));
+        layer.packReport = atlas.packReport;
+        layer.glyphs.reserve(atlas.glyphCount);
+        for (size_t glyphIndex = 0; glyphIndex < atlas.glyphCount; glyphIndex++)
+        {
+            const AtlasGlyph &glyph = atlas.glyphs[glyphIndex];
+            GlyphInfo &info = layer.glyphs[glyph.codePoint];
+            if (glyph.codePoint < 128)
+            {
+                // Note: Pointers to unordered_map elements stay good when the map grows.
+                layer.asciiGlyphs[glyph.codePoint] = &info;
+            }
+
+            // Note: Texture coordinates are relative to the layer, not to the atlas, because 
+            // the atlas might not fill its layer.
+            info.ax = glyph.ax;
+            info.ay = glyph.ay;
+            info.bl = glyph.bl;
+            info.bt = glyph.bt;
+            info.bw = (float)(glyph.width);
+            info.bh = (float)(glyph.rows);
+            info.nbw = (float)(glyph.width / (float)_layerWidth);
+            info.nbh = (float)(glyph.rows / (float)_layerHeight);
+            info.tx = (float)(glyph.x / (float)_layerWidth);
+            info.ty = (float)(glyph.y / (float)_layerHeight);
+            info.layer = (float)layerIndex;
+        }
+        layer.kerning.Init(atlas.kerningPairs, atlas.kerningPairCount);
+    }
+
+    // see FreeTypeAtlas::UploadAtlas(...)
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+
+    _vertexStream = StreamBuffer::Shared();
+    _quadIndexBuffer = QuadIndexBuffer::Shared();
+    glGenVertexArrays(1, &_vaoId);
+    return true;
+}
+
+unsigned int FreeTypeAtlasArray::LayerCount() const
+{
+    return (unsigned int)_layers.size();
+}
+
+void FreeTypeAtlasArray::AddText(const unsigned int layer, const std::string &str, 
+    const float posPixels[2], const float userScale[2], const float color[4])
+{
+    if (layer >= _layers.size())
+    {
+        fprintf(stderr, "Texture array atlas has no layer %u\n", layer);
+        return;
+    }
+    const Layer &glyphLayer = _layers[layer];
+
+    // in pixels, like FreeTypeAtlas::RenderText(...)
+    float pen[2] = { posPixels[0], posPixels[1] };
+    unsigned int packedColor = PackColor(color);
+
+    // 4 vertices per glyph, and there are never more glyphs than bytes
+    _vertices.reserve(_vertices.size() + (VerticesPerQuad * str.length()));
+
+    size_t byteIndex = 0;
+    unsigned int previousCodePoint = 0;
+    while (byteIndex < str.length())
+    {
+        unsigned int codePoint = DecodeUtf8(str.data(), str.length(), byteIndex);
+        pen[0] += glyphLayer.kerning.Find(previousCodePoint, codePoint) * userScale[0];
+        previousCodePoint = codePoint;
+
+        const GlyphInfo *glyph = 0;
+        if (codePoint < 128)
+        {
+            glyph = glyphLayer.asciiGlyphs[codePoint];
+        }
+        else
+        {
+            std::unordered_map<unsigned int, GlyphInfo>::const_iterator found = 
+                glyphLayer.glyphs.find(codePoint);
+            if (found != glyphLayer.glyphs.end())
+            {
+                glyph = &found->second;
+            }
+        }
+        if (glyph == 0)
+        {
+            continue;
+        }
+
+        // the same quad as FreeTypeAtlas makes (see MakeGlyphQuad(...)), plus the layer
+        // Note: Quads from different strings (and different layers) all go into one draw 
+        // call, which the shared index buffer splits into separate triangles.
+        TextVertex box[VerticesPerQuad];
+        MakeGlyphQuad(*glyph, userScale, packedColor, pen, box);
+        for (unsigned int corner = 0; corner < VerticesPerQuad; corner++)
+        {
+            ArrayVertex vertex = { box[corner].x, box[corner].y, box[corner].s, box[corner].t,
+                glyph->layer, box[corner].color };
+            _vertices.push_back(vertex);
+        }
+    }
+}
+
+void FreeTypeAtlasArray::Render()
+{
+    if (_vertices.empty())
+    {
+        return;
+    }
+
+    // The strings come in over several AddText(...) calls, so unlike FreeTypeAtlas, the 
+    // vertices can't be written straight into the vertex stream; they are copied in here in 
+    // one go instead.  That still avoids reallocating a buffer on every draw.
+    // Note: The reservation is lined up on whole (24 byte) vertices so that the draw can start
+    // at one.
+    size_t byteOffset = 0;
+    size_t vertexBytes = _vertices.size() * sizeof(ArrayVertex);
+    void *streamVertices = _vertexStream->Reserve(vertexBytes, sizeof(ArrayVertex), byteOffset);
+    if (streamVertices == 0)
+    {
+        _vertices.clear();
+        return;
+    }
+    memcpy(streamVertices, _vertices.data(), vertexBytes);
+    _vertexStream->Commit(vertexBytes);
+
+    // see FreeTypeAtlas::RenderText(...) for the details
+    GlStateCache &glState = GlStateCache::Current();
+    glState.EnableAlphaBlend();
+
+    // the array has no clip rectangle, so the scissor test that an atlas may have left on
+    // (see FreeTypeAtlas::SetClipRect(...)) has to go
+    glState.DisableScissor();
+
+    // one bind for every size and every font
+    glState.BindTexture(GL_TEXTURE_2D_ARRAY, _textureId);
+    glState.Uniform1i(_uniformTextSamplerLoc, _textureSamplerId);
+
+    // see FreeTypeAtlas::BindTextVertexArray()
+    glState.BindVertexArray(_vaoId);
+    if (_vaoStreamGeneration != _vertexStream->Generation())
+    {
+        _vaoStreamGeneration = _vertexStream->Generation();
+        glBindBuffer(GL_ARRAY_BUFFER, _vertexStream->BufferId());
+        GLint bytesPerVertex = sizeof(ArrayVertex);
+
+        // pixel coordinates, then texture coordinates, then the layer, then the color
+        // Note: The layer attribute only exists in this vertex array, so it no longer has to
+        // be turned off again for the regular shaders.
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, bytesPerVertex,
+            (void *)offsetof(ArrayVertex, x));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, bytesPerVertex,
+            (void *)offsetof(ArrayVertex, s));
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, bytesPerVertex,
+            (void *)offsetof(ArrayVertex, layer));
+        glEnableVertexAttribArray(3);
+        glVertexAttribPointer(3, 4, GL_UNSIGNED_BYTE, GL_TRUE, bytesPerVertex,
+            (void *)offsetof(ArrayVertex, color));
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _quadIndexBuffer->BufferId());
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    _quadIndexBuffer->DrawQuads(byteOffset / sizeof(ArrayVertex), 
+        _vertices.size() / VerticesPerQuad);
+    _vertexStream->Fence();
+
+    // keep the memory for the next frame
+    _vertices.clear();
+}
+
+const PackReport &FreeTypeAtlasArray::GetPackReport(const unsigned int layer) const
+{
+    return _layers[layer].packReport;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+// for the report on how well each layer's glyphs packed
+#include "GlyphPacker.h"
+
+// for the glyph metrics and the quads that they become
+#include "GlyphQuads.h"
+
+// for each layer's kerning pairs
+#include "KerningTable.h"
+
+#include <memory>       // for the shared index buffer
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// the atlases that become the array's layers (see AtlasImage.h)
+struct AtlasImageView;
+
+// the index buffer and the vertex stream that every atlas shares (see QuadIndexBuffer.h and 
+// StreamBuffer.h)
+class QuadIndexBuffer;
+class StreamBuffer;
+
+// several atlases (different sizes, different fonts, or both) in one GL_TEXTURE_2D_ARRAY, one 
+// atlas per layer
+// Note: With FreeTypeAtlas, every size is its own texture and its own draw call.  Here every 
+// glyph knows which layer it is in, so text in any mix of sizes and fonts is queued up with 
+// AddText(...) and then goes out with one texture bind and one draw call in Render(...).
+// Also Note: This needs the texture array shaders (shader_array.vert and shader_array.frag), 
+// not the regular ones.
+// Also Also Note: The array is built once and never changes, so there is no glyph cache.  A 
+// character that isn't in a layer is skipped.
+class FreeTypeAtlasArray
+{
+public:
+    FreeTypeAtlasArray(const int uniformTextSamplerLoc);
+    ~FreeTypeAtlasArray();
+
+    // uploads each atlas into its own layer
+    // Note: Every layer of a texture array has the same dimensions, so the layers are as big 
+    // as the biggest atlas, and the smaller ones leave some of their layer empty.  Putting 
+    // atlases of similar sizes in the same array keeps that waste down.
+    // Also Note: The views only have to stay valid until this returns.
+    bool Init(const std::vector<AtlasImageView> &atlases);
+
+    // number of layers, and therefore the valid "layer" arguments to AddText(...)
+    unsigned int LayerCount() const;
+
+    // queues up a UTF-8 string that is drawn from the given layer
+    // Note: Position, scale, and color work the same as they do for
+    // FreeTypeAtlas::RenderText(...).  The color goes into the vertices, so every string can
+    // have its own and still go out in the same draw call.
+    void AddText(const unsigned int layer, const std::string &str, 
+        const float posPixels[2], const float userScale[2], const float color[4]);
+
+    // draws everything that was queued since the last call with one draw call and forgets it
+    void Render();
+
+    // how well the given layer's glyphs packed
+    const PackReport &GetPackReport(const unsigned int layer) const;
+
+private:
+    // same as FreeTypeAtlas' glyph info, plus the layer
+    struct GlyphInfo : GlyphQuadMetrics
+    {
+        float layer;
+    };
+
+    struct Layer
+    {
+        std::unordered_map<unsigned int, GlyphInfo> glyphs;
+
+        // most text is ASCII, so skip the hashing for those (see FreeTypeAtlas)
+        const GlyphInfo *asciiGlyphs[128];
+
+        // see FreeTypeAtlas::Kerning(...)
+        KerningTable kerning;
+
+        PackReport packReport;
+    };
+    std::vector<Layer> _layers;
+
+    // x and y in pixels, s and t in texture coordinates, the layer, and the color (see
+    // PackColor(...))
+    struct ArrayVertex
+    {
+        float x;
+        float y;
+        float s;
+        float t;
+        float layer;
+        unsigned int color;
+    };
+    std::vector<ArrayVertex> _vertices;
+
+    // actually GLuints and GLints (see FreeTypeAtlas.h)
+    unsigned int _textureId;
+    std::shared_ptr<StreamBuffer> _vertexStream;
+    std::shared_ptr<QuadIndexBuffer> _quadIndexBuffer;
+    int _textureSamplerId;
+    int _uniformTextSamplerLoc;
+
+    // actually a GLuint, and the stream generation that it was last set up for (see
+    // FreeTypeAtlas.h)
+    unsigned int _vaoId;
+    unsigned int _vaoStreamGeneration;
+
+    // texture dimensions (every layer) in pixels
+    unsigned int _layerWidth;
+    unsigned int _layerHeight;
+};
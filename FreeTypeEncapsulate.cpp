@@ -1,10 +1,19 @@
 #include "FreeTypeEncapsulate.h"
+#include "GlStateCache.h"
+#ifndef FREETYPE_ATLAS_BAKED_ONLY
+#include "AtlasBuilder.h"
+#include "GlyphRasterizer.h"
+#endif
 
 // the OpenGL version include also includes all previous versions
 // Build note: Do NOT mistakenly include _int_gl_4_4.h.  That one doesn't define OpenGL stuff 
 // first.
 #include "glload/include/glload/gl_4_4.h"
 
+#include <string.h>     // for memset(...)
+
+#include <algorithm>    // for std::max
+
 // for making program from shader collection
 #include <string>
 #include <fstream>
@@ -14,38 +23,59 @@
 FreeTypeEncapsulate::FreeTypeEncapsulate()
     :
     _haveInitialized(0),
+    _compressAtlases(false),
+#ifndef FREETYPE_ATLAS_BAKED_ONLY
+    _ftLib(0),
+    _ftFace(0),
+    _fontHash(0),
+    _atlasPadding(1),
+#endif
     _programId(0),
     _uniformTextSamplerLoc(0),
-    _uniformTextColorLoc(0)
+    _uniformPixelToNdcLoc(0),
+    _haveInitializedArrayProgram(false),
+    _arrayProgramId(0),
+    _arrayUniformTextSamplerLoc(0),
+    _arrayUniformPixelToNdcLoc(0),
+    _haveInitializedInstancedProgram(false),
+    _instancedProgramId(0),
+    _instancedUniformTextSamplerLoc(0),
+    _instancedUniformPixelToNdcLoc(0),
+    _haveInitializedComputeLayoutProgram(false),
+    _viewportWidth(0),
+    _viewportHeight(0)
 {
+#ifndef FREETYPE_ATLAS_BAKED_ONLY
+    // plain coverage atlases until told otherwise
+    _distanceField.spread = 0;
+    _distanceField.supersample = 0;
+#endif
+    memset(&_computeLayoutProgram, 0, sizeof(_computeLayoutProgram));
 }
 
 FreeTypeEncapsulate::~FreeTypeEncapsulate()
 {
     // cleanup
     glDeleteProgram(_programId);
-}
+    glDeleteProgram(_arrayProgramId);
+    glDeleteProgram(_instancedProgramId);
+    glDeleteProgram(_computeLayoutProgram.programId);
 
-int FreeTypeEncapsulate::Init(const std::string &trueTypeFontFilePath, 
-    const std::string &vertShaderPath, const std::string &fragShaderPath)
-{
-    // FreeType needs to load itself into particular variables
-    // Note: FT_Init_FreeType(...) returns something called an FT_Error, which VS can't find.
-    // Based on the useage, it is assumed that 0 is returned if something went wrong, otherwise
-    // non-zero is returned.  That is the only explanation for this kind of condition.
-    if (FT_Init_FreeType(&_ftLib))
-    {
-        fprintf(stderr, "Could not init freetype library\n");
-        return false;
-    }
+    // a new program could get one of these IDs, and it mustn't inherit their cached uniforms
+    GlStateCache::Current().Invalidate();
 
-    // Note: FT_New_Face(...) also returns an FT_Error.
-    if (FT_New_Face(_ftLib, trueTypeFontFilePath.c_str(), 0, &_ftFace))
+#ifndef FREETYPE_ATLAS_BAKED_ONLY
+    // Note: This also closes the face.
+    if (_ftLib != 0)
     {
-        fprintf(stderr, "Could not open font '%s'\n", trueTypeFontFilePath.c_str());
-        return false;
+        FT_Done_FreeType(_ftLib);
     }
+#endif
+}
 
+int FreeTypeEncapsulate::Init(const std::string &vertShaderPath, 
+    const std::string &fragShaderPath)
+{
     _programId = CreateFreeTypeProgram(vertShaderPath, fragShaderPath);
 
     // pick out the attributes and uniforms used in the FreeType GPU program
@@ -58,34 +88,590 @@ int FreeTypeEncapsulate::Init(const std::string &trueTypeFontFilePath,
         return false;
     }
 
-    //char textColorName[] = "color";
-    char textColorName[] = "textureColor";
-    _uniformTextColorLoc = glGetUniformLocation(_programId, textColorName);
-    if (_uniformTextColorLoc == -1)
+    // Note: There is no color uniform anymore.  The color is in the vertices (see
+    // PackColor(...)).
+
+    char pixelToNdcName[] = "pixelToNdc";
+    _uniformPixelToNdcLoc = glGetUniformLocation(_programId, pixelToNdcName);
+    if (_uniformPixelToNdcLoc == -1)
     {
-        fprintf(stderr, "Could not bind uniform '%s'\n", textColorName);
+        fprintf(stderr, "Could not bind uniform '%s'\n", pixelToNdcName);
         return false;
     }
+    ApplyViewportSize(_programId, _uniformPixelToNdcLoc);
 
     _haveInitialized = true;
     return _programId;
 }
 
-const std::shared_ptr<FreeTypeAtlas> FreeTypeEncapsulate::GenerateAtlas(const int fontSize)
+const std::shared_ptr<FreeTypeAtlas> FreeTypeEncapsulate::GenerateAtlas(
+    const AtlasImageView &bakedAtlas)
+{
+    if (!_haveInitialized)
+    {
+        fprintf(stderr, "FreeTypeEncapsulate object has not been initialized\n");
+        return nullptr;
+    }
+
+    std::shared_ptr<FreeTypeAtlas> newAtlasPtr = std::make_shared<FreeTypeAtlas>(
+        _uniformTextSamplerLoc);
+    if (!newAtlasPtr->Init(bakedAtlas, FreeTypeAtlas::GlyphSource(), _compressAtlases) ||
+        !InitInstanced(*newAtlasPtr) || !InitComputeLayout(*newAtlasPtr))
+    {
+        return nullptr;
+    }
+
+    TrackAtlas(newAtlasPtr);
+    return newAtlasPtr;
+}
+
+const std::shared_ptr<FreeTypeAtlas> FreeTypeEncapsulate::LoadAtlas(
+    const std::string &atlasFilePath)
+{
+    // Note: The atlas is on the GPU by the time that GenerateAtlas(...) returns, so the file 
+    // doesn't need to stay mapped any longer than this.
+    MappedFile atlasFile;
+    if (!atlasFile.Open(atlasFilePath))
+    {
+        fprintf(stderr, "Could not open atlas file '%s'\n", atlasFilePath.c_str());
+        return nullptr;
+    }
+
+    AtlasFileKey bakedKey;
+    AtlasImageView bakedAtlas;
+    if (!ReadAtlasFile(atlasFile.Data(), atlasFile.Size(), bakedKey, bakedAtlas))
+    {
+        fprintf(stderr, "'%s' is not an atlas file or is from a different version\n", 
+            atlasFilePath.c_str());
+        return nullptr;
+    }
+
+    return GenerateAtlas(bakedAtlas);
+}
+
+void FreeTypeEncapsulate::SetAtlasCompression(const bool compress)
+{
+    _compressAtlases = compress;
+}
+
+void FreeTypeEncapsulate::SetViewportSize(const int width, const int height)
+{
+    _viewportWidth = width;
+    _viewportHeight = height;
+    if (_haveInitialized)
+    {
+        ApplyViewportSize(_programId, _uniformPixelToNdcLoc);
+    }
+    if (_haveInitializedArrayProgram)
+    {
+        ApplyViewportSize(_arrayProgramId, _arrayUniformPixelToNdcLoc);
+    }
+    if (_haveInitializedInstancedProgram)
+    {
+        ApplyViewportSize(_instancedProgramId, _instancedUniformPixelToNdcLoc);
+    }
+
+    for (size_t atlasIndex = 0; atlasIndex < _atlases.size(); atlasIndex++)
+    {
+        std::shared_ptr<FreeTypeAtlas> atlas = _atlases[atlasIndex].lock();
+        if (atlas != nullptr)
+        {
+            atlas->SetViewportSize(width, height);
+        }
+    }
+}
+
+void FreeTypeEncapsulate::TrackAtlas(const std::shared_ptr<FreeTypeAtlas> &atlas)
+{
+    atlas->SetViewportSize(_viewportWidth, _viewportHeight);
+
+    // Note: The order doesn't matter, so an atlas that is gone is swapped with the last one.
+    size_t atlasIndex = 0;
+    while (atlasIndex < _atlases.size())
+    {
+        if (_atlases[atlasIndex].expired())
+        {
+            _atlases[atlasIndex] = _atlases.back();
+            _atlases.pop_back();
+        }
+        else
+        {
+            atlasIndex++;
+        }
+    }
+    _atlases.push_back(atlas);
+}
+
+void FreeTypeEncapsulate::ApplyViewportSize(const unsigned int programId,
+    const int uniformPixelToNdcLoc) const
+{
+    // a minimized window can be 0 pixels across
+    if (_viewportWidth <= 0 || _viewportHeight <= 0)
+    {
+        return;
+    }
+
+    // pixel 0 is the left (or bottom) edge at -1, and pixel "width" is the right (or top) edge
+    // at +1
+    // Note: glProgramUniform*(...) (OpenGL 4.1) sets the uniform without binding the program,
+    // so whatever the state cache thinks is bound stays true (see GlStateCache.h).
+    glProgramUniform4f(programId, uniformPixelToNdcLoc, 2.0f / _viewportWidth,
+        2.0f / _viewportHeight, -1.0f, -1.0f);
+}
+
+unsigned int FreeTypeEncapsulate::InitAtlasArrayProgram(const std::string &vertShaderPath, 
+    const std::string &fragShaderPath)
+{
+    _arrayProgramId = CreateFreeTypeProgram(vertShaderPath, fragShaderPath);
+
+    // same uniform names as the regular program
+    char textTextureName[] = "textureSamplerId";
+    _arrayUniformTextSamplerLoc = glGetUniformLocation(_arrayProgramId, textTextureName);
+    if (_arrayUniformTextSamplerLoc == -1)
+    {
+        fprintf(stderr, "Could not bind uniform '%s'\n", textTextureName);
+        return 0;
+    }
+
+    char pixelToNdcName[] = "pixelToNdc";
+    _arrayUniformPixelToNdcLoc = glGetUniformLocation(_arrayProgramId, pixelToNdcName);
+    if (_arrayUniformPixelToNdcLoc == -1)
+    {
+        fprintf(stderr, "Could not bind uniform '%s'\n", pixelToNdcName);
+        return 0;
+    }
+    ApplyViewportSize(_arrayProgramId, _arrayUniformPixelToNdcLoc);
+
+    _haveInitializedArrayProgram = true;
+    return _arrayProgramId;
+}
+
+unsigned int FreeTypeEncapsulate::InitInstancedProgram(const std::string &vertShaderPath, 
+    const std::string &fragShaderPath)
+{
+    _instancedProgramId = CreateFreeTypeProgram(vertShaderPath, fragShaderPath);
+
+    // same uniform names as the regular program
+    char textTextureName[] = "textureSamplerId";
+    _instancedUniformTextSamplerLoc = glGetUniformLocation(_instancedProgramId, textTextureName);
+    if (_instancedUniformTextSamplerLoc == -1)
+    {
+        fprintf(stderr, "Could not bind uniform '%s'\n", textTextureName);
+        return 0;
+    }
+
+    char pixelToNdcName[] = "pixelToNdc";
+    _instancedUniformPixelToNdcLoc = glGetUniformLocation(_instancedProgramId, pixelToNdcName);
+    if (_instancedUniformPixelToNdcLoc == -1)
+    {
+        fprintf(stderr, "Could not bind uniform '%s'\n", pixelToNdcName);
+        return 0;
+    }
+    ApplyViewportSize(_instancedProgramId, _instancedUniformPixelToNdcLoc);
+
+    _haveInitializedInstancedProgram = true;
+    return _instancedProgramId;
+}
+
+bool FreeTypeEncapsulate::InitInstanced(FreeTypeAtlas &atlas) const
+{
+    if (!_haveInitializedInstancedProgram)
+    {
+        // the atlas simply can't draw instanced
+        return true;
+    }
+
+    return atlas.InitInstanced(_instancedUniformTextSamplerLoc);
+}
+
+unsigned int FreeTypeEncapsulate::InitComputeLayoutProgram(const std::string &compShaderPath)
 {
+    // the quads are drawn with the regular program
     if (!_haveInitialized)
     {
         fprintf(stderr, "FreeTypeEncapsulate object has not been initialized\n");
+        return 0;
+    }
+
+    ComputeLayoutProgram program;
+    program.programId = CreateComputeProgram(compShaderPath);
+    program.drawProgramId = _programId;
+
+    char layoutPassName[] = "layoutPass";
+    program.uniformLayoutPassLoc = glGetUniformLocation(program.programId, layoutPassName);
+    if (program.uniformLayoutPassLoc == -1)
+    {
+        fprintf(stderr, "Could not bind uniform '%s'\n", layoutPassName);
+        glDeleteProgram(program.programId);
+        return 0;
+    }
+
+    char glyphCountName[] = "glyphCount";
+    program.uniformGlyphCountLoc = glGetUniformLocation(program.programId, glyphCountName);
+    if (program.uniformGlyphCountLoc == -1)
+    {
+        fprintf(stderr, "Could not bind uniform '%s'\n", glyphCountName);
+        glDeleteProgram(program.programId);
+        return 0;
+    }
+
+    char penStartName[] = "penStart";
+    program.uniformPenStartLoc = glGetUniformLocation(program.programId, penStartName);
+    if (program.uniformPenStartLoc == -1)
+    {
+        fprintf(stderr, "Could not bind uniform '%s'\n", penStartName);
+        glDeleteProgram(program.programId);
+        return 0;
+    }
+
+    char userScaleName[] = "userScale";
+    program.uniformUserScaleLoc = glGetUniformLocation(program.programId, userScaleName);
+    if (program.uniformUserScaleLoc == -1)
+    {
+        fprintf(stderr, "Could not bind uniform '%s'\n", userScaleName);
+        glDeleteProgram(program.programId);
+        return 0;
+    }
+
+    char atlasSizeName[] = "atlasSize";
+    program.uniformAtlasSizeLoc = glGetUniformLocation(program.programId, atlasSizeName);
+    if (program.uniformAtlasSizeLoc == -1)
+    {
+        fprintf(stderr, "Could not bind uniform '%s'\n", atlasSizeName);
+        glDeleteProgram(program.programId);
+        return 0;
+    }
+
+    // the quads come out with the color in every vertex, like the ones that the CPU makes
+    char textColorName[] = "textColor";
+    program.uniformTextColorLoc = glGetUniformLocation(program.programId, textColorName);
+    if (program.uniformTextColorLoc == -1)
+    {
+        fprintf(stderr, "Could not bind uniform '%s'\n", textColorName);
+        glDeleteProgram(program.programId);
+        return 0;
+    }
+
+    glDeleteProgram(_computeLayoutProgram.programId);
+    _computeLayoutProgram = program;
+    _haveInitializedComputeLayoutProgram = true;
+    return _computeLayoutProgram.programId;
+}
+
+bool FreeTypeEncapsulate::InitComputeLayout(FreeTypeAtlas &atlas) const
+{
+    if (!_haveInitializedComputeLayoutProgram)
+    {
+        // the atlas simply can't lay out on the GPU
+        return true;
+    }
+
+    return atlas.InitComputeLayout(_computeLayoutProgram);
+}
+
+const std::shared_ptr<FreeTypeAtlasArray> FreeTypeEncapsulate::GenerateAtlasArray(
+    const std::vector<AtlasImageView> &atlases)
+{
+    if (!_haveInitializedArrayProgram)
+    {
+        fprintf(stderr, "FreeTypeEncapsulate texture array program has not been initialized\n");
+        return nullptr;
+    }
+
+    std::shared_ptr<FreeTypeAtlasArray> newAtlasArrayPtr = std::make_shared<FreeTypeAtlasArray>(
+        _arrayUniformTextSamplerLoc);
+    if (!newAtlasArrayPtr->Init(atlases))
+    {
+        return nullptr;
+    }
+
+    return newAtlasArrayPtr;
+}
+
+#ifndef FREETYPE_ATLAS_BAKED_ONLY
+int FreeTypeEncapsulate::Init(const std::string &trueTypeFontFilePath, 
+    const std::string &vertShaderPath, const std::string &fragShaderPath)
+{
+    // map the font file rather than reading it so that a launch where every atlas comes out 
+    // of the disk cache only pays for hashing it
+    if (!_fontFile.Open(trueTypeFontFilePath))
+    {
+        fprintf(stderr, "Could not open font '%s'\n", trueTypeFontFilePath.c_str());
         return false;
     }
+    _fontHash = HashBytes(_fontFile.Data(), _fontFile.Size());
+
+    return Init(vertShaderPath, fragShaderPath);
+}
+
+const std::shared_ptr<FreeTypeAtlas> FreeTypeEncapsulate::GenerateAtlas(const int fontSize,
+    const PackingMethod packingMethod)
+{
+    return GenerateAtlas(fontSize, AsciiCodePoints(), packingMethod);
+}
+
+const std::shared_ptr<FreeTypeAtlas> FreeTypeEncapsulate::GenerateAtlas(const int fontSize,
+    const std::vector<unsigned int> &codePoints, const PackingMethod packingMethod)
+{
+    if (!_haveInitialized || _fontFile.Data() == 0)
+    {
+        fprintf(stderr, "FreeTypeEncapsulate object has not been initialized with a font\n");
+        return nullptr;
+    }
+
+    // Note: The atlas is on the GPU by the time that Init(...) returns, so the cache file 
+    // doesn't need to stay mapped any longer than this.
+    MappedFile cacheFile;
+    AtlasImage builtAtlas;
+    AtlasImageView atlasView;
+    if (!LoadOrBuildAtlas(fontSize, codePoints, packingMethod, cacheFile, builtAtlas, 
+        atlasView))
+    {
+        return nullptr;
+    }
+
+    // Note: The encapsulation outlives its atlases, so the atlas can hang on to "this".
+    // Also Note: The distance field settings are copied so that changing them later doesn't 
+    // change what this atlas' on-demand glyphs look like.
+    DistanceFieldSettings distanceField = _distanceField;
+    FreeTypeAtlas::GlyphSource glyphSource = 
+        [this, fontSize, distanceField](const unsigned int codePoint, GlyphArena &arena)
+    {
+        return RasterizeGlyph(fontSize, distanceField, codePoint, arena);
+    };
 
     std::shared_ptr<FreeTypeAtlas> newAtlasPtr = std::make_shared<FreeTypeAtlas>(
-        _uniformTextSamplerLoc, _uniformTextColorLoc);
-    newAtlasPtr->Init(_ftFace, fontSize);
+        _uniformTextSamplerLoc);
+    if (!newAtlasPtr->Init(atlasView, glyphSource, _compressAtlases) ||
+        !InitInstanced(*newAtlasPtr) || !InitComputeLayout(*newAtlasPtr))
+    {
+        return nullptr;
+    }
 
+    TrackAtlas(newAtlasPtr);
     return newAtlasPtr;
 }
 
+bool FreeTypeEncapsulate::LoadOrBuildAtlas(const int fontSize, 
+    const std::vector<unsigned int> &codePoints, const PackingMethod packingMethod, 
+    MappedFile &cacheFile, AtlasImage &builtAtlas, AtlasImageView &atlas)
+{
+    // everything that goes into the atlas' pixels and layout
+    AtlasFileKey cacheKey;
+    cacheKey.fontHash = _fontHash;
+    cacheKey.codePointHash = HashBytes(codePoints.data(), 
+        codePoints.size() * sizeof(unsigned int));
+    cacheKey.fontPixelHeightSize = (unsigned int)fontSize;
+    cacheKey.loadFlags = FT_LOAD_RENDER;
+    cacheKey.packingMethod = (unsigned int)packingMethod;
+    cacheKey.distanceFieldSpread = _distanceField.spread;
+    cacheKey.distanceFieldSupersample = _distanceField.supersample;
+    cacheKey.padding = _atlasPadding;
+
+    // a cache hit goes straight from the mapped file to the GPU; FreeType isn't touched
+    if (_atlasDiskCache.Load(cacheKey, cacheFile, atlas))
+    {
+        return true;
+    }
+
+    FT_Face face = LoadFace();
+    if (face == 0)
+    {
+        return false;
+    }
+
+    // for FreeType fonts under default rendering, 1 pixel == 1 byte
+    // Note: FreeType 2 (the header indicates that I am using 2.6.1 as of 3-29-2016) does not 
+    // provide RGB data for a texture, but it does provide monochrome (1-bit) or 8-bit greyscale 
+    // bitmaps.  
+    // http://www.freetype.org/freetype2/docs/ft2faq.html#general-donts
+    // Also Note: When loading a glyph, I use FT_LOAD_RENDER, which causes a character's glyph 
+    // to be loaded from the TrueType file into a small bitmap in the default render mode.  
+    // http://www.freetype.org/freetype2/docs/reference/ft2-base_interface.html#FT_LOAD_RENDER
+    // Also Also Note: The default render mode loads an 8-bit greyscale bitmap with 256 levels 
+    // of opacity (2^8) (implicitly, this means 256 levels of opacity per pixel).  "Use linear 
+    // alpha blending and gamma correction to correctly render non-monochrome glyph bitmaps onto 
+    // a surface." (alpha blending is activated in the "render text" method) This means that 
+    // there is one 8-bit byte per pixel.  Keep this in mind when calculating the texture size.  
+    // http://www.freetype.org/freetype2/docs/reference/ft2-base_interface.html#FT_Render_Mode
+
+    // before I begin...
+    // The atlas used to be built by loading every character twice: once to figure out how big 
+    // the texture needed to be and once more to send each glyph to its spot in the texture, one
+    // glTexSubImage2D(...) call per glyph.  Now every glyph is rendered exactly once into a 
+    // CPU-side arena, the builder lays them out and pastes them into a CPU-side copy of the 
+    // atlas, and then the whole atlas goes to the GPU in a single glTexImage2D(...) call.
+
+    // Starting up a worker thread costs a new FT_Library and a new FT_Face, which is about 
+    // what it costs to rasterize a few hundred small glyphs, so only bother with threads when 
+    // there is enough work to go around.  Basic ASCII is faster on this thread.
+    // Also Note: Distance fields always go to the worker threads.  The distance transform 
+    // costs a lot more than rasterizing, even for basic ASCII.
+    const size_t minCodePointsForThreads = 512;
+    GlyphArena glyphs;
+    if (_distanceField.spread != 0)
+    {
+        if (!RasterizeDistanceFieldsParallel(_fontFile.Data(), _fontFile.Size(), fontSize, 
+            codePoints, _distanceField, 0, glyphs))
+        {
+            fprintf(stderr, "Could not rasterize glyphs for font size %d\n", fontSize);
+            return false;
+        }
+    }
+    else if (codePoints.size() < minCodePointsForThreads)
+    {
+        RasterizeGlyphs(face, fontSize, codePoints, glyphs);
+    }
+    else if (!RasterizeGlyphsParallel(_fontFile.Data(), _fontFile.Size(), fontSize, codePoints,
+        0, glyphs))
+    {
+        fprintf(stderr, "Could not rasterize glyphs for font size %d\n", fontSize);
+        return false;
+    }
+
+    // The GL standard defines a maximum size (in bytes) for textures.  This affects 1D and 2D 
+    // textures (I've been told that 3D textures have their own max values).  1D is just a line, 
+    // so it only applies to that one dimension.  For 2D textures, the max size applies to both 
+    // width and height.  This value is determined by the graphics API.  I checked this program
+    // (on 3-29-2016), and at this time OpenGL is telling me that my max texture size is 16384 
+    // bytes.  But while the GL standard does not tell the graphics API an upper limit, it does 
+    // tell them a lower limit for this max value, which I believe is 1024 bytes.
+    GLint maxTextureSizeBytes;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSizeBytes);
+
+    // Note: The packer aims for a near-square atlas rather than one long row of glyphs, which 
+    // is much kinder to the texture cache.
+    AtlasBuilder builder;
+    builder.SetPackingMethod(packingMethod);
+    builder.SetPadding(_atlasPadding);
+    if (!builder.Build(glyphs, (unsigned int)maxTextureSizeBytes, builtAtlas))
+    {
+        fprintf(stderr, "Could not build atlas for font size %d\n", fontSize);
+        return false;
+    }
+    GlyphCellSize(face, fontSize, builtAtlas.cellWidth, builtAtlas.cellHeight);
+
+    // a distance field glyph is its bitmap plus the border on both sides
+    builtAtlas.cellWidth += 2 * _distanceField.spread;
+    builtAtlas.cellHeight += 2 * _distanceField.spread;
+
+    // looked up once here and saved with the atlas, so drawing never asks FreeType
+    ExtractKerning(face, fontSize, codePoints, builtAtlas.kerningPairs);
+
+    atlas = MakeAtlasImageView(builtAtlas);
+    if (_atlasDiskCache.IsEnabled())
+    {
+        // a failed save only costs the next launch some time, so carry on regardless
+        _atlasDiskCache.Save(cacheKey, atlas);
+    }
+
+    return true;
+}
+
+const std::shared_ptr<FreeTypeAtlasArray> FreeTypeEncapsulate::GenerateAtlasArray(
+    const std::vector<int> &fontSizes, const std::vector<unsigned int> &codePoints,
+    const PackingMethod packingMethod)
+{
+    if (_fontFile.Data() == 0)
+    {
+        fprintf(stderr, "FreeTypeEncapsulate object has not been initialized with a font\n");
+        return nullptr;
+    }
+
+    // every size's atlas has to stay alive until they have all been uploaded
+    // Note: MappedFile can't be copied, so hold them by pointer.
+    std::vector<std::unique_ptr<MappedFile>> cacheFiles(fontSizes.size());
+    std::vector<AtlasImage> builtAtlases(fontSizes.size());
+    std::vector<AtlasImageView> atlases(fontSizes.size());
+    for (size_t sizeIndex = 0; sizeIndex < fontSizes.size(); sizeIndex++)
+    {
+        cacheFiles[sizeIndex].reset(new MappedFile());
+        if (!LoadOrBuildAtlas(fontSizes[sizeIndex], codePoints, packingMethod, 
+            *cacheFiles[sizeIndex], builtAtlases[sizeIndex], atlases[sizeIndex]))
+        {
+            return nullptr;
+        }
+    }
+
+    return GenerateAtlasArray(atlases);
+}
+
+void FreeTypeEncapsulate::SetAtlasCacheDirectory(const std::string &directoryPath)
+{
+    _atlasDiskCache.SetDirectory(directoryPath);
+}
+
+void FreeTypeEncapsulate::SetDistanceField(const unsigned int spread, 
+    const unsigned int supersample)
+{
+    // a plain coverage atlas is keyed as all 0s no matter what supersample was asked for
+    _distanceField.spread = spread;
+    _distanceField.supersample = (spread == 0) ? 0 : std::max(supersample, 1u);
+}
+
+void FreeTypeEncapsulate::SetAtlasPadding(const unsigned int padding)
+{
+    // Note: Glyphs that touch would bleed into each other, so 0 is the same as 1 (and is keyed
+    // the same way).
+    _atlasPadding = std::max(padding, 1u);
+}
+
+FT_Face FreeTypeEncapsulate::LoadFace()
+{
+    if (_ftFace != 0)
+    {
+        return _ftFace;
+    }
+
+    // FreeType needs to load itself into particular variables
+    // Note: FT_Init_FreeType(...) returns something called an FT_Error, which VS can't find.
+    // Based on the useage, it is assumed that 0 is returned if something went wrong, otherwise
+    // non-zero is returned.  That is the only explanation for this kind of condition.
+    if (_ftLib == 0 && FT_Init_FreeType(&_ftLib))
+    {
+        fprintf(stderr, "Could not init freetype library\n");
+        _ftLib = 0;
+        return 0;
+    }
+
+    // Note: FT_New_Memory_Face(...) also returns an FT_Error.
+    if (FT_New_Memory_Face(_ftLib, _fontFile.Data(), (FT_Long)_fontFile.Size(), 0, &_ftFace))
+    {
+        fprintf(stderr, "Could not open font face\n");
+        _ftFace = 0;
+        return 0;
+    }
+
+    return _ftFace;
+}
+
+bool FreeTypeEncapsulate::RasterizeGlyph(const int fontSize, 
+    const DistanceFieldSettings &distanceField, const unsigned int codePoint, GlyphArena &arena)
+{
+    // Note: The face may be shared by atlases of several sizes, but RasterizeGlyphs(...) sets 
+    // the size every time.
+    FT_Face face = LoadFace();
+    if (face == 0)
+    {
+        return false;
+    }
+
+    std::vector<unsigned int> codePoints(1, codePoint);
+    if (distanceField.spread == 0)
+    {
+        RasterizeGlyphs(face, fontSize, codePoints, arena);
+        return true;
+    }
+
+    // one glyph isn't worth a thread
+    GlyphArena supersampledGlyph;
+    RasterizeGlyphs(face, fontSize * (int)distanceField.supersample, codePoints, 
+        supersampledGlyph);
+    MakeDistanceFields(supersampledGlyph, distanceField, 1, arena);
+    return true;
+}
+#endif
+
 /*-----------------------------------------------------------------------------------------------
 Description:
     Encapsulates the creation of an OpenGL GPU program, including the compilation and linking of
@@ -188,3 +774,47 @@ unsigned int FreeTypeEncapsulate::CreateFreeTypeProgram(const std::string &vertS
     return programId;
 }
 
+unsigned int FreeTypeEncapsulate::CreateComputeProgram(const std::string &compShaderPath)
+{
+    // see CreateFreeTypeProgram(...)
+    std::ifstream shaderFile(compShaderPath);
+    std::stringstream shaderData;
+    shaderData << shaderFile.rdbuf();
+    shaderFile.close();
+    std::string tempFileContents = shaderData.str();
+    GLuint compShaderId = glCreateShader(GL_COMPUTE_SHADER);
+    const GLchar *compShaderBytes[] = { tempFileContents.c_str() };
+    const GLint compShaderStrLengths[] = { (int)tempFileContents.length() };
+    glShaderSource(compShaderId, 1, compShaderBytes, compShaderStrLengths);
+    glCompileShader(compShaderId);
+
+    GLint isCompiled = 0;
+    glGetShaderiv(compShaderId, GL_COMPILE_STATUS, &isCompiled);
+    if (isCompiled == GL_FALSE)
+    {
+        GLchar errLog[128];
+        GLsizei *logLen = 0;
+        glGetShaderInfoLog(compShaderId, 128, logLen, errLog);
+        printf("compute shader failed: '%s'\n", errLog);
+        glDeleteShader(compShaderId);
+        return 0;
+    }
+
+    GLuint programId = glCreateProgram();
+    glAttachShader(programId, compShaderId);
+    glLinkProgram(programId);
+    glDetachShader(programId, compShaderId);
+    glDeleteShader(compShaderId);
+
+    GLint isLinked = 0;
+    glGetProgramiv(programId, GL_LINK_STATUS, &isLinked);
+    if (isLinked == GL_FALSE)
+    {
+        printf("program didn't compile\n");
+        glDeleteProgram(programId);
+        return 0;
+    }
+
+    return programId;
+}
+
@@ -1,16 +1,30 @@
 #pragma once
 
+// Build note: Define FREETYPE_ATLAS_BAKED_ONLY for a program that only draws atlases that were 
+// baked ahead of time (see AtlasBaker.cpp).  Everything that needs FreeType is left out, so 
+// FreeType doesn't need to be linked, and GlyphRasterizer.cpp compiles to nothing.
+#ifndef FREETYPE_ATLAS_BAKED_ONLY
 // there doesn't seem to be any way out of including all of FreeType without some shady forward 
 // declarations of FreeType interna structures
 // Note: FreeType has a single header for everything.  This is evil.
 #include <ft2build.h>
 #include FT_FREETYPE_H  // also defined relative to "freetype-2.6.1/include/"
+#endif
 
 // because the FreeType encapsulation contains info necessary to create the atlas
 #include "FreeTypeAtlas.h"
+#include "FreeTypeAtlasArray.h"
+
+// for keeping finished atlases around between launches and for mapping the font file
+#include "AtlasDiskCache.h"
+#include "MappedFile.h"
+
+// for the signed distance field atlas mode
+#include "DistanceField.h"
 
 #include <string>
 #include <memory>   // for the shared pointer
+#include <vector>
 
 class FreeTypeEncapsulate
 {
@@ -18,24 +32,162 @@ public:
     FreeTypeEncapsulate();
     ~FreeTypeEncapsulate();
 
+    // only builds the shader program, for programs that only draw baked atlases
+    // returns: shader program ID if initialization successful, otherwise 0
+    int Init(const std::string &vertShaderPath, const std::string &fragShaderPath);
+
+    // uploads an atlas that was baked ahead of time, such as one from a header that AtlasBaker 
+    // generated; FreeType is not involved
+    // Note: Only the baked glyphs can be drawn.
+    const std::shared_ptr<FreeTypeAtlas> GenerateAtlas(const AtlasImageView &bakedAtlas);
+
+    // same as above, but for a binary atlas file that AtlasBaker wrote
+    // Note: The file is memory-mapped and uploaded straight from the mapping.
+    const std::shared_ptr<FreeTypeAtlas> LoadAtlas(const std::string &atlasFilePath);
+
+    // atlases generated after this call are stored on the GPU as BC4 blocks (see 
+    // Bc4Encoder.h), which takes half of the video memory and half of the bandwidth
+    // Note: Compressed atlases can't add glyphs on demand, so only the prebuilt glyphs are 
+    // drawn.  Check FreeTypeAtlas::GetCompressionReport() to see whether the loss in quality 
+    // is acceptable for a particular font.
+    // Also Note: Atlas arrays are never compressed.  The default is uncompressed.
+    void SetAtlasCompression(const bool compress);
+
+    // tells every program that this made (and every one that it makes later) how big the
+    // window is, which is how text positions in pixels become screen coordinates
+    // Note: Call this from the window's reshape callback.  Nothing is laid out again; only the
+    // "pixelToNdc" uniform changes (see shader.vert).
+    // Also Note: Every atlas that this made (and every one that it makes later) is told too,
+    // so that glyphs outside of the window are skipped (see FreeTypeAtlas::SetClipRect(...)).
+    void SetViewportSize(const int width, const int height);
+
+    // builds the program for texture array atlases (see FreeTypeAtlasArray.h), which need 
+    // their own shaders (shader_array.vert and shader_array.frag)
+    // returns: shader program ID if initialization successful, otherwise 0
+    // Note: Use this program, not the one from Init(...), when rendering an atlas array.
+    unsigned int InitAtlasArrayProgram(const std::string &vertShaderPath, 
+        const std::string &fragShaderPath);
+
+    // builds the program for drawing one instance per glyph (see 
+    // FreeTypeAtlas::RenderTextInstanced(...)), which needs its own vertex shader 
+    // (shader_instanced.vert) but uses the regular fragment shader
+    // returns: shader program ID if initialization successful, otherwise 0
+    // Note: Only atlases that are generated after this call can draw instanced.
+    unsigned int InitInstancedProgram(const std::string &vertShaderPath, 
+        const std::string &fragShaderPath);
+
+    // builds the compute program that lays text out on the GPU (see
+    // FreeTypeAtlas::RenderTextCompute(...) and shader_layout.comp), which needs OpenGL 4.3
+    // returns: shader program ID if initialization successful, otherwise 0
+    // Note: Call after Init(...).  The quads are drawn with the regular program, so nothing
+    // else is needed.  Only atlases that are generated after this call can lay out on the
+    // GPU.
+    unsigned int InitComputeLayoutProgram(const std::string &compShaderPath);
+
+    // puts each atlas in its own layer of one texture array, in order, so the layer for 
+    // FreeTypeAtlasArray::AddText(...) is the atlas' index in the list
+    // Note: The atlases can come from any font (ex: views of baked atlases).
+    const std::shared_ptr<FreeTypeAtlasArray> GenerateAtlasArray(
+        const std::vector<AtlasImageView> &atlases);
+
+#ifndef FREETYPE_ATLAS_BAKED_ONLY
     // takes: file path relative to solution directory
     // returns: shader program ID if initialization successful, otherwise 0
+    // Note: This only maps the font file and builds the shader program.  FreeType itself isn't 
+    // started until an atlas actually needs it (see LoadFace()), which may be never if every 
+    // atlas comes out of the disk cache.
     int Init(const std::string &trueTypeFontFilePath, 
         const std::string &vertShaderPath, const std::string &fragShaderPath);
 
     // the shared pointer will encapsulate the atlas' pointer and clean up after it is 
     // unecessary, and it is const so that the user can't even try to re-initialize it
-    const std::shared_ptr<FreeTypeAtlas> GenerateAtlas(const int fontSize);
+    // Note: The packing method only changes the atlas' layout, not how the text looks.
+    const std::shared_ptr<FreeTypeAtlas> GenerateAtlas(const int fontSize,
+        const PackingMethod packingMethod = PackingMethod::Skyline);
+
+    // same as above, but prebuilds any set of code points (Latin-Extended, Cyrillic, etc.)
+    // Note: Large sets are rasterized on worker threads (see RasterizeGlyphsParallel(...)).
+    // Also Note: Characters outside of the set are still drawn; they are rasterized the first 
+    // time they show up and then cached in the atlas (see GlyphCache.h).
+    const std::shared_ptr<FreeTypeAtlas> GenerateAtlas(const int fontSize,
+        const std::vector<unsigned int> &codePoints,
+        const PackingMethod packingMethod = PackingMethod::Skyline);
+
+    // same as above, but with one layer per font size, in order
+    const std::shared_ptr<FreeTypeAtlasArray> GenerateAtlasArray(
+        const std::vector<int> &fontSizes, const std::vector<unsigned int> &codePoints,
+        const PackingMethod packingMethod = PackingMethod::Skyline);
+
+    // finished atlases are saved to this directory and loaded from it on later launches 
+    // instead of being rasterized again (see AtlasDiskCache.h)
+    // Note: The directory must already exist.  The cache is off by default.
+    void SetAtlasCacheDirectory(const std::string &directoryPath);
+
+    // atlases generated after this call hold signed distance fields instead of coverage (see 
+    // DistanceField.h), so one atlas looks sharp at any userScale
+    // Note: Draw them with shader_sdf.frag in place of shader.frag.  The atlas itself is used 
+    // exactly the same way.
+    // Also Note: A spread of 0 goes back to plain coverage atlases, which is the default.
+    void SetDistanceField(const unsigned int spread, const unsigned int supersample = 4);
+
+    // atlases generated after this call leave this many empty pixels between glyphs, which 
+    // buys them mipmaps for drawing text small (see AtlasMipmaps.h): 2 pixels gives 2 levels, 
+    // 4 gives 3, 8 gives 4, and so on
+    // Note: The default is 1, which is no mipmaps.  The atlas is sampled trilinearly whenever 
+    // it has more than 1 level.
+    void SetAtlasPadding(const unsigned int padding);
+#endif
 
 private:
     bool _haveInitialized;
 
+    // for the atlases that are generated from now on
+    bool _compressAtlases;
+
+#ifndef FREETYPE_ATLAS_BAKED_ONLY
+    // starts FreeType and opens the face the first time that it is called
+    // returns: the face, or null if FreeType couldn't open it
+    FT_Face LoadFace();
+
+    // loads the atlas from the disk cache if it is there, otherwise rasterizes and builds it 
+    // (and saves it to the cache)
+    // Note: The view points into either the cache file or the built atlas, so both must 
+    // outlive it.
+    bool LoadOrBuildAtlas(const int fontSize, const std::vector<unsigned int> &codePoints,
+        const PackingMethod packingMethod, MappedFile &cacheFile, AtlasImage &builtAtlas,
+        AtlasImageView &atlas);
+
+    // the atlas' glyph source (see FreeTypeAtlas::GlyphSource)
+    bool RasterizeGlyph(const int fontSize, const DistanceFieldSettings &distanceField, 
+        const unsigned int codePoint, GlyphArena &arena);
+
     FT_Library _ftLib;  // move to a "FreeTypeContainment" class
     FT_Face _ftFace;    // move to a "FreeTypeContainment" class
 
+    // the whole font file, mapped into memory so that worker threads can open their own faces 
+    // over it without going back to the disk and so that it can be hashed for the disk cache 
+    // without being copied
+    // Note: FT_New_Memory_Face(...) does not copy the bytes, so the file must stay mapped as 
+    // long as _ftFace is open.
+    MappedFile _fontFile;
+    unsigned long long _fontHash;
+
+    AtlasDiskCache _atlasDiskCache;
+
+    // for the atlases that are generated from now on
+    DistanceFieldSettings _distanceField;
+    unsigned int _atlasPadding;
+#endif
+
     unsigned int CreateFreeTypeProgram(const std::string &vertShaderPath, 
         const std::string &fragShaderPath);
 
+    // same as above, but for a program with only a compute shader
+    unsigned int CreateComputeProgram(const std::string &compShaderPath);
+
+    // sets a program's "pixelToNdc" uniform for the last viewport size, if there has been one
+    void ApplyViewportSize(const unsigned int programId, const int uniformPixelToNdcLoc) const;
+
     // these are actually GLuint and GLint values, but I didn't want to include all of OpenGL 
     // just for the typedefs, which is unfortunately necessary since only readily available 
     // header files for OpenGL include everything
@@ -48,5 +200,41 @@ private:
     
     unsigned int _programId;
     int _uniformTextSamplerLoc;   // uniform location within program
-    int _uniformTextColorLoc;     // uniform location within program
+    int _uniformPixelToNdcLoc;    // uniform location within program
+
+    // the same for the texture array program
+    bool _haveInitializedArrayProgram;
+    unsigned int _arrayProgramId;
+    int _arrayUniformTextSamplerLoc;
+    int _arrayUniformPixelToNdcLoc;
+
+    // the same for the instanced program
+    bool _haveInitializedInstancedProgram;
+    unsigned int _instancedProgramId;
+    int _instancedUniformTextSamplerLoc;
+    int _instancedUniformPixelToNdcLoc;
+
+    // the same for the compute layout program
+    // Note: Its output is in pixels already, so it doesn't need the viewport size.
+    bool _haveInitializedComputeLayoutProgram;
+    ComputeLayoutProgram _computeLayoutProgram;
+
+    // from SetViewportSize(...), or 0s until then
+    int _viewportWidth;
+    int _viewportHeight;
+
+    // every atlas that this made, so that they can be told when the window's size changes
+    // Note: Weak, because the atlases belong to whoever asked for them.  The ones that are
+    // gone are dropped whenever a new one is added.
+    std::vector<std::weak_ptr<FreeTypeAtlas>> _atlases;
+
+    // tells an atlas that was just made how big the window is and remembers it
+    void TrackAtlas(const std::shared_ptr<FreeTypeAtlas> &atlas);
+
+    // sets up the instanced path on an atlas that was just made, if the program exists
+    // returns: false if it was asked for and failed
+    bool InitInstanced(FreeTypeAtlas &atlas) const;
+
+    // same as above, but for the compute layout
+    bool InitComputeLayout(FreeTypeAtlas &atlas) const;
 };
\ No newline at end of file
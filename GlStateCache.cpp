@@ -0,0 +1,284 @@
+#include "GlStateCache.h"
+
+// the OpenGL version include also includes all previous versions
+// Build note: Do NOT mistakenly include _int_gl_4_4.h.  That one doesn't define OpenGL stuff
+// first.
+#include "glload/include/glload/gl_4_4.h"
+
+#include <string.h>     // for memset(...), memcmp(...), memcpy(...)
+
+GlStateCache &GlStateCache::Current()
+{
+    static GlStateCache cache;
+    return cache;
+}
+
+GlStateCache::GlStateCache()
+{
+    Invalidate();
+    ResetCounters();
+}
+
+void GlStateCache::UseProgram(const unsigned int programId)
+{
+    if (_programKnown && _programId == programId)
+    {
+        _counters.bindsElided++;
+        return;
+    }
+
+    glUseProgram(programId);
+    _programKnown = true;
+    _programId = programId;
+    _counters.bindsIssued++;
+}
+
+void GlStateCache::BindVertexArray(const unsigned int vertexArrayId)
+{
+    if (_vertexArrayKnown && _vertexArrayId == vertexArrayId)
+    {
+        _counters.bindsElided++;
+        return;
+    }
+
+    glBindVertexArray(vertexArrayId);
+    _vertexArrayKnown = true;
+    _vertexArrayId = vertexArrayId;
+    _counters.bindsIssued++;
+}
+
+void GlStateCache::BindTexture(const unsigned int target, const unsigned int textureId)
+{
+    bool *known = 0;
+    unsigned int *boundId = 0;
+    if (target == GL_TEXTURE_2D)
+    {
+        known = &_texture2dKnown;
+        boundId = &_texture2dId;
+    }
+    else if (target == GL_TEXTURE_2D_ARRAY)
+    {
+        known = &_texture2dArrayKnown;
+        boundId = &_texture2dArrayId;
+    }
+
+    if (known != 0 && *known && *boundId == textureId)
+    {
+        _counters.bindsElided++;
+        return;
+    }
+
+    glBindTexture(target, textureId);
+    if (known != 0)
+    {
+        *known = true;
+        *boundId = textureId;
+    }
+    _counters.bindsIssued++;
+}
+
+void GlStateCache::BindShaderStorageBuffer(const unsigned int index, const unsigned int bufferId)
+{
+    // Note: Only binding point 0 is remembered, since that is the only one that is used.
+    if (index == 0 && _storageBufferKnown && _storageBufferId == bufferId)
+    {
+        _counters.bindsElided++;
+        return;
+    }
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, index, bufferId);
+    if (index == 0)
+    {
+        _storageBufferKnown = true;
+        _storageBufferId = bufferId;
+    }
+    _counters.bindsIssued++;
+}
+
+void GlStateCache::EnableAlphaBlend()
+{
+    if (_blendKnown && _blendEnabled)
+    {
+        _counters.blendElided++;
+        return;
+    }
+
+    // the text will be drawn, in part, via a manipulation of pixel alpha values, and OpenGL's
+    // blending does this
+    // Note: Nothing else sets the blend function, so it only needs setting when blending is
+    // turned on.
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    _blendKnown = true;
+    _blendEnabled = true;
+    _counters.blendIssued++;
+}
+
+void GlStateCache::DisableBlend()
+{
+    if (_blendKnown && !_blendEnabled)
+    {
+        _counters.blendElided++;
+        return;
+    }
+
+    glDisable(GL_BLEND);
+    _blendKnown = true;
+    _blendEnabled = false;
+    _counters.blendIssued++;
+}
+
+void GlStateCache::EnableScissor(const int box[4])
+{
+    // Note: The box and the enable are separate state, but they are only ever changed
+    // together, so they are counted as one change.
+    bool boxChanged = !_scissorBoxKnown || memcmp(_scissorBox, box, sizeof(_scissorBox)) != 0;
+    bool enableChanged = !_scissorKnown || !_scissorEnabled;
+    if (!boxChanged && !enableChanged)
+    {
+        _counters.scissorElided++;
+        return;
+    }
+
+    if (boxChanged)
+    {
+        glScissor(box[0], box[1], box[2], box[3]);
+        _scissorBoxKnown = true;
+        memcpy(_scissorBox, box, sizeof(_scissorBox));
+    }
+    if (enableChanged)
+    {
+        glEnable(GL_SCISSOR_TEST);
+        _scissorKnown = true;
+        _scissorEnabled = true;
+    }
+    _counters.scissorIssued++;
+}
+
+void GlStateCache::DisableScissor()
+{
+    if (_scissorKnown && !_scissorEnabled)
+    {
+        _counters.scissorElided++;
+        return;
+    }
+
+    glDisable(GL_SCISSOR_TEST);
+    _scissorKnown = true;
+    _scissorEnabled = false;
+    _counters.scissorIssued++;
+}
+
+bool GlStateCache::UniformChanged(const int location, const float *value,
+    const unsigned int count)
+{
+    // a program that didn't come through UseProgram(...) could be anything
+    if (!_programKnown)
+    {
+        return true;
+    }
+
+    UniformValue newValue;
+    memset(&newValue, 0, sizeof(newValue));
+    memcpy(newValue.values, value, count * sizeof(float));
+
+    std::unordered_map<int, UniformValue> &programUniforms = _uniforms[_programId];
+    std::unordered_map<int, UniformValue>::iterator found = programUniforms.find(location);
+    if (found != programUniforms.end() &&
+        memcmp(found->second.values, newValue.values, sizeof(newValue.values)) == 0)
+    {
+        return false;
+    }
+
+    programUniforms[location] = newValue;
+    return true;
+}
+
+void GlStateCache::Uniform1i(const int location, const int value)
+{
+    float asFloat = (float)value;
+    if (!UniformChanged(location, &asFloat, 1))
+    {
+        _counters.uniformsElided++;
+        return;
+    }
+
+    glUniform1i(location, value);
+    _counters.uniformsIssued++;
+}
+
+void GlStateCache::Uniform2fv(const int location, const float value[2])
+{
+    if (!UniformChanged(location, value, 2))
+    {
+        _counters.uniformsElided++;
+        return;
+    }
+
+    glUniform2fv(location, 1, value);
+    _counters.uniformsIssued++;
+}
+
+void GlStateCache::Uniform4fv(const int location, const float value[4])
+{
+    if (!UniformChanged(location, value, 4))
+    {
+        _counters.uniformsElided++;
+        return;
+    }
+
+    glUniform4fv(location, 1, value);
+    _counters.uniformsIssued++;
+}
+
+void GlStateCache::Invalidate()
+{
+    _programKnown = false;
+    _programId = 0;
+    _vertexArrayKnown = false;
+    _vertexArrayId = 0;
+    _texture2dKnown = false;
+    _texture2dId = 0;
+    _texture2dArrayKnown = false;
+    _texture2dArrayId = 0;
+    _storageBufferKnown = false;
+    _storageBufferId = 0;
+    _blendKnown = false;
+    _blendEnabled = false;
+    _scissorKnown = false;
+    _scissorEnabled = false;
+    _scissorBoxKnown = false;
+    memset(_scissorBox, 0, sizeof(_scissorBox));
+    _uniforms.clear();
+}
+
+void GlStateCache::Forget(const unsigned int target, const unsigned int objectId)
+{
+    // Note: Deleting a bound object also unbinds it, so the binding is known to be 0 now.
+    if (target == GL_TEXTURE_2D && _texture2dId == objectId)
+    {
+        _texture2dId = 0;
+    }
+    else if (target == GL_TEXTURE_2D_ARRAY && _texture2dArrayId == objectId)
+    {
+        _texture2dArrayId = 0;
+    }
+    else if (target == GL_VERTEX_ARRAY && _vertexArrayId == objectId)
+    {
+        _vertexArrayId = 0;
+    }
+    else if (target == GL_SHADER_STORAGE_BUFFER && _storageBufferId == objectId)
+    {
+        _storageBufferId = 0;
+    }
+}
+
+const GlStateCounters &GlStateCache::Counters() const
+{
+    return _counters;
+}
+
+void GlStateCache::ResetCounters()
+{
+    memset(&_counters, 0, sizeof(_counters));
+}
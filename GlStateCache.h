@@ -0,0 +1,113 @@
+#pragma once
+
+#include <unordered_map>
+
+// how many state changes went to OpenGL and how many were skipped because OpenGL already had
+// that state
+struct GlStateCounters
+{
+    // program, vertex array, texture, and storage buffer bindings
+    unsigned int bindsIssued;
+    unsigned int bindsElided;
+
+    // glEnable/glDisable(GL_BLEND) and glBlendFunc(...)
+    unsigned int blendIssued;
+    unsigned int blendElided;
+
+    // glEnable/glDisable(GL_SCISSOR_TEST) and glScissor(...)
+    unsigned int scissorIssued;
+    unsigned int scissorElided;
+
+    // glUniform*(...)
+    unsigned int uniformsIssued;
+    unsigned int uniformsElided;
+};
+
+// remembers the OpenGL state that text drawing changes so that setting it to what it already
+// is costs nothing
+// Note: Every RenderText(...) used to enable blending, set the blend function, bind the
+// texture, set the sampler and color uniforms, and then undo all of it, even when the next
+// call was going to set it all right back.  Each of those is a trip into the driver, and for
+// short strings those trips cost more than the text.  Text drawing now goes through this
+// instead and leaves its state in place for the next draw.
+// Also Note: The cache only knows about changes that go through it.  Anything that changes
+// the same state directly (ex: glUseProgram(...) or glBindTexture(...) elsewhere in the
+// program) must call Invalidate() afterwards.  Uniforms are remembered per program, so a
+// program has to be bound with UseProgram(...) for its uniforms to be cached at all.
+// Also Also Note: Only texture unit 0 is tracked, since that is the only one that the atlases
+// use.
+class GlStateCache
+{
+public:
+    // the cache for the OpenGL context
+    // Note: The demo only ever has one context.
+    static GlStateCache &Current();
+
+    void UseProgram(const unsigned int programId);
+    void BindVertexArray(const unsigned int vertexArrayId);
+    void BindTexture(const unsigned int target, const unsigned int textureId);
+    void BindShaderStorageBuffer(const unsigned int index, const unsigned int bufferId);
+
+    // turns on blending with the alpha blend function that all text uses, or turns it off
+    void EnableAlphaBlend();
+    void DisableBlend();
+
+    // turns on the scissor test with the given box (x, y, width, and height in window pixels,
+    // like glScissor(...)), or turns it off
+    void EnableScissor(const int box[4]);
+    void DisableScissor();
+
+    // set a uniform of the bound program, unless it already has that value
+    void Uniform1i(const int location, const int value);
+    void Uniform2fv(const int location, const float value[2]);
+    void Uniform4fv(const int location, const float value[4]);
+
+    // forgets everything, so the next change of each kind goes to OpenGL no matter what
+    // Note: Call after changing the tracked state without the cache, and after deleting or
+    // relinking a program whose uniforms may be cached.
+    void Invalidate();
+
+    // called with a texture, buffer, or vertex array that is about to be deleted, so that a
+    // new one that gets the same ID isn't mistaken for it
+    void Forget(const unsigned int target, const unsigned int objectId);
+
+    const GlStateCounters &Counters() const;
+    void ResetCounters();
+
+private:
+    GlStateCache();
+    GlStateCache(const GlStateCache &) = delete;
+    GlStateCache &operator=(const GlStateCache &) = delete;
+
+    // returns: true if the value was new, in which case it is remembered
+    bool UniformChanged(const int location, const float *value, const unsigned int count);
+
+    // Note: "Known" is false until the first change goes through the cache, since OpenGL's
+    // state at that point could be anything.
+    bool _programKnown;
+    unsigned int _programId;
+    bool _vertexArrayKnown;
+    unsigned int _vertexArrayId;
+    bool _texture2dKnown;
+    unsigned int _texture2dId;
+    bool _texture2dArrayKnown;
+    unsigned int _texture2dArrayId;
+    bool _storageBufferKnown;
+    unsigned int _storageBufferId;
+    bool _blendKnown;
+    bool _blendEnabled;
+    bool _scissorKnown;
+    bool _scissorEnabled;
+    bool _scissorBoxKnown;
+    int _scissorBox[4];
+
+    // the last value of each uniform, by program and then location, padded out to 4 floats
+    // Note: An integer uniform is stored as a float, which is exact for sampler units.
+    struct UniformValue
+    {
+        float values[4];
+    };
+    std::unordered_map<unsigned int, std::unordered_map<int, UniformValue>> _uniforms;
+
+    GlStateCounters _counters;
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+// Note: Nothing in here needs FreeType, so code that only moves rasterized glyphs around (the 
+// atlas builder, the atlas itself) doesn't have to include it.
+#include <stddef.h>     // for size_t
+
+#include <vector>
+
+// everything that the atlas needs to know about a single glyph except for its bitmap, which
+// lives in the arena's shared pixel buffer
+// Note: The metric names match FreeTypeAtlas' glyph info so that the two are easy to compare.
+struct RasterizedGlyph
+{
+    unsigned int codePoint;
+
+    // advance X and Y, in pixels
+    float ax;
+    float ay;
+
+    // bitmap left and top, in pixels, relative to the glyph's origin
+    float bl;
+    float bt;
+
+    // bitmap dimensions in pixels (1 byte per pixel)
+    unsigned int width;
+    unsigned int rows;
+
+    // where this glyph's bitmap starts in the arena's pixel buffer; the bitmap is tightly
+    // packed (row length == width), unlike FreeType's bitmaps, which may have padded rows
+    size_t pixelOffset;
+};
+
+// a CPU-side staging area for glyph bitmaps
+// Note: FreeType renders each glyph into the face's single glyph slot, so the bitmap is gone
+// as soon as the next glyph is loaded.  Copying every bitmap into one contiguous buffer means
+// that each glyph only needs to be rendered once, and then the packer and the texture upload
+// can work from the copies without going back to FreeType.
+struct GlyphArena
+{
+    std::vector<RasterizedGlyph> glyphs;
+    std::vector<unsigned char> pixels;
+};
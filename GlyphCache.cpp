@@ -0,0 +1,113 @@
+#include "GlyphCache.h"
+
+GlyphCache::GlyphCache() :
+    _cellCount(0),
+    _evictionCount(0)
+{
+}
+
+void GlyphCache::Init(const unsigned int cellCount)
+{
+    _cellCount = cellCount;
+    _evictionCount = 0;
+    _glyphs.clear();
+    _lru.clear();
+
+    // hand out the lowest cells first (the back of the vector is the next one out)
+    _freeCells.resize(cellCount);
+    for (unsigned int cell = 0; cell < cellCount; cell++)
+    {
+        _freeCells[cell] = cellCount - 1 - cell;
+    }
+}
+
+void GlyphCache::Grow(const unsigned int cellCount)
+{
+    if (cellCount <= _cellCount)
+    {
+        return;
+    }
+
+    // the new cells go to the front of the line so that any lower cells that are still free 
+    // are handed out first
+    std::vector<unsigned int> newCells;
+    newCells.reserve(cellCount - _cellCount);
+    for (unsigned int cell = cellCount; cell > _cellCount; cell--)
+    {
+        newCells.push_back(cell - 1);
+    }
+    _freeCells.insert(_freeCells.begin(), newCells.begin(), newCells.end());
+    _cellCount = cellCount;
+}
+
+bool GlyphCache::Touch(const unsigned int codePoint, const unsigned int useStamp)
+{
+    std::unordered_map<unsigned int, CachedGlyph>::iterator found = _glyphs.find(codePoint);
+    if (found == _glyphs.end())
+    {
+        return false;
+    }
+
+    found->second.lastUseStamp = useStamp;
+    _lru.splice(_lru.begin(), _lru, found->second.lruPosition);
+    return true;
+}
+
+bool GlyphCache::Insert(const unsigned int codePoint, const unsigned int useStamp,
+    unsigned int &cell, bool &evicted, unsigned int &evictedCodePoint)
+{
+    evicted = false;
+
+    if (!_freeCells.empty())
+    {
+        cell = _freeCells.back();
+        _freeCells.pop_back();
+    }
+    else
+    {
+        if (_lru.empty())
+        {
+            // no cells at all
+            return false;
+        }
+
+        // the least recently used glyph is at the back
+        std::unordered_map<unsigned int, CachedGlyph>::iterator oldest =
+            _glyphs.find(_lru.back());
+        if (oldest->second.lastUseStamp == useStamp)
+        {
+            // every glyph in the cache is needed by the current draw call
+            return false;
+        }
+
+        cell = oldest->second.cell;
+        evicted = true;
+        evictedCodePoint = oldest->first;
+        _evictionCount++;
+        _lru.pop_back();
+        _glyphs.erase(oldest);
+    }
+
+    _lru.push_front(codePoint);
+    CachedGlyph newGlyph;
+    newGlyph.cell = cell;
+    newGlyph.lastUseStamp = useStamp;
+    newGlyph.lruPosition = _lru.begin();
+    _glyphs[codePoint] = newGlyph;
+    return true;
+}
+
+unsigned int GlyphCache::CellCount() const
+{
+    return _cellCount;
+}
+
+unsigned int GlyphCache::FreeCellCount() const
+{
+    return (unsigned int)_freeCells.size();
+}
+
+unsigned int GlyphCache::EvictionCount() const
+{
+    return _evictionCount;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+// bookkeeping for the part of the atlas that holds glyphs that were rasterized on demand
+// Note: That part of the atlas is a grid of equally sized cells, each big enough for any glyph
+// in the face, so any cell can hold any glyph and a glyph can be swapped out for another
+// without repacking anything.  This class only decides which cell a glyph goes in and which
+// glyph gets kicked out when the cells run out.  It knows nothing about OpenGL or FreeType.
+class GlyphCache
+{
+public:
+    GlyphCache();
+
+    // forgets every glyph and starts over with this many empty cells
+    void Init(const unsigned int cellCount);
+
+    // adds empty cells, numbered after the existing ones, without forgetting anything
+    // Note: The atlas calls this after it makes room for more cells.
+    void Grow(const unsigned int cellCount);
+
+    // marks the glyph as used during the given "use stamp" (a counter that the atlas bumps on
+    // every draw call) and moves it to the front of the line
+    // returns: true if the glyph is in the cache, otherwise false
+    bool Touch(const unsigned int codePoint, const unsigned int useStamp);
+
+    // finds a cell for a glyph that isn't in the cache yet
+    // Note: If there are no empty cells, the least recently used glyph is evicted, unless it
+    // was used during the current use stamp, in which case it is still needed by the draw call
+    // that is being assembled and so is everything more recent than it.
+    // returns: true and the cell if there was room, otherwise false
+    // Also returns: whether a glyph was evicted and, if so, which one
+    bool Insert(const unsigned int codePoint, const unsigned int useStamp,
+        unsigned int &cell, bool &evicted, unsigned int &evictedCodePoint);
+
+    // number of cells, used or not
+    unsigned int CellCount() const;
+
+    // number of cells that don't hold a glyph
+    unsigned int FreeCellCount() const;
+
+    // number of glyphs that were kicked out to make room for others since Init(...)
+    unsigned int EvictionCount() const;
+
+private:
+    struct CachedGlyph
+    {
+        unsigned int cell;
+        unsigned int lastUseStamp;
+
+        // where the glyph sits in the LRU list so that it can be moved in O(1)
+        std::list<unsigned int>::iterator lruPosition;
+    };
+
+    unsigned int _cellCount;
+    unsigned int _evictionCount;
+    std::vector<unsigned int> _freeCells;
+    std::unordered_map<unsigned int, CachedGlyph> _glyphs;
+
+    // code points, most recently used first
+    std::list<unsigned int> _lru;
+};
@@ -0,0 +1,496 @@
+#include "GlyphPacker.h"
+
+#include <algorithm>    // for std::max, std::min, std::sort
+#include <math.h>       // for sqrt(...)
+
+namespace
+{
+    // the original layout: glyphs go left to right, and a new row ("shelf") starts when the
+    // next glyph won't fit on the current one
+    class ShelfPacker : public GlyphPacker
+    {
+    public:
+        virtual void Reset(const unsigned int binWidth, const unsigned int binHeight)
+        {
+            _binWidth = binWidth;
+            _binHeight = binHeight;
+            _shelfX = 0;
+            _shelfY = 0;
+            _shelfHeight = 0;
+        }
+
+        virtual bool Insert(const unsigned int width, const unsigned int height,
+            unsigned int &x, unsigned int &y)
+        {
+            if (width > _binWidth)
+            {
+                return false;
+            }
+
+            if (_shelfX + width > _binWidth)
+            {
+                // start a new shelf on top of the current one
+                _shelfY += _shelfHeight;
+                _shelfX = 0;
+                _shelfHeight = 0;
+            }
+
+            if (_shelfY + height > _binHeight)
+            {
+                return false;
+            }
+
+            x = _shelfX;
+            y = _shelfY;
+            _shelfX += width;
+            _shelfHeight = std::max(_shelfHeight, height);
+            return true;
+        }
+
+    private:
+        unsigned int _binWidth;
+        unsigned int _binHeight;
+        unsigned int _shelfX;
+        unsigned int _shelfY;
+        unsigned int _shelfHeight;
+    };
+
+    // keeps track of the outline ("skyline") of everything placed so far as a list of
+    // horizontal segments that span the whole bin width
+    // Note: Y grows downwards from the top of the atlas, so "lowest" here means the smallest Y.
+    class SkylinePacker : public GlyphPacker
+    {
+    public:
+        virtual void Reset(const unsigned int binWidth, const unsigned int binHeight)
+        {
+            _binWidth = binWidth;
+            _binHeight = binHeight;
+            _segments.clear();
+
+            Segment floor = { 0, 0, binWidth };
+            _segments.push_back(floor);
+        }
+
+        virtual bool Insert(const unsigned int width, const unsigned int height,
+            unsigned int &x, unsigned int &y)
+        {
+            // bottom-left heuristic: pick the segment where the rectangle's far edge would end
+            // up closest to the atlas origin, and on a tie, the one further to the left
+            size_t bestIndex = _segments.size();
+            unsigned int bestY = 0;
+            unsigned int bestEdge = 0;
+            for (size_t segmentIndex = 0; segmentIndex < _segments.size(); segmentIndex++)
+            {
+                unsigned int fitY = 0;
+                if (!Fits(segmentIndex, width, height, fitY))
+                {
+                    continue;
+                }
+
+                unsigned int edge = fitY + height;
+                if (bestIndex == _segments.size() || edge < bestEdge)
+                {
+                    bestIndex = segmentIndex;
+                    bestY = fitY;
+                    bestEdge = edge;
+                }
+            }
+
+            if (bestIndex == _segments.size())
+            {
+                return false;
+            }
+
+            x = _segments[bestIndex].x;
+            y = bestY;
+            Place(bestIndex, width, height, bestY);
+            return true;
+        }
+
+    private:
+        struct Segment
+        {
+            unsigned int x;
+            unsigned int y;
+            unsigned int width;
+        };
+
+        // a rectangle that starts at this segment rests on the highest segment underneath it
+        bool Fits(const size_t segmentIndex, const unsigned int width,
+            const unsigned int height, unsigned int &fitY) const
+        {
+            const Segment &first = _segments[segmentIndex];
+            if (first.x + width > _binWidth)
+            {
+                return false;
+            }
+
+            fitY = first.y;
+            unsigned int widthLeft = width;
+            size_t index = segmentIndex;
+            while (widthLeft > 0)
+            {
+                fitY = std::max(fitY, _segments[index].y);
+                if (fitY + height > _binHeight)
+                {
+                    return false;
+                }
+
+                widthLeft -= std::min(widthLeft, _segments[index].width);
+                index++;
+            }
+
+            return true;
+        }
+
+        void Place(const size_t segmentIndex, const unsigned int width,
+            const unsigned int height, const unsigned int y)
+        {
+            Segment top = { _segments[segmentIndex].x, y + height, width };
+            _segments.insert(_segments.begin() + segmentIndex, top);
+
+            // the new segment covers up some or all of the segments to its right
+            size_t index = segmentIndex + 1;
+            while (index < _segments.size())
+            {
+                const Segment &previous = _segments[index - 1];
+                unsigned int previousEnd = previous.x + previous.width;
+                Segment &current = _segments[index];
+                if (current.x >= previousEnd)
+                {
+                    break;
+                }
+
+                unsigned int overlap = previousEnd - current.x;
+                if (current.width <= overlap)
+                {
+                    _segments.erase(_segments.begin() + index);
+                    continue;
+                }
+
+                current.x += overlap;
+                current.width -= overlap;
+                break;
+            }
+
+            // neighbors at the same height are really one segment
+            for (size_t mergeIndex = 0; mergeIndex + 1 < _segments.size(); )
+            {
+                if (_segments[mergeIndex].y == _segments[mergeIndex + 1].y)
+                {
+                    _segments[mergeIndex].width += _segments[mergeIndex + 1].width;
+                    _segments.erase(_segments.begin() + mergeIndex + 1);
+                }
+                else
+                {
+                    mergeIndex++;
+                }
+            }
+        }
+
+        unsigned int _binWidth;
+        unsigned int _binHeight;
+        std::vector<Segment> _segments;
+    };
+
+    // keeps a list of every maximal free rectangle, which may overlap each other, and splits
+    // them whenever something is placed
+    class MaxRectsPacker : public GlyphPacker
+    {
+    public:
+        virtual void Reset(const unsigned int binWidth, const unsigned int binHeight)
+        {
+            _freeRects.clear();
+
+            Rect everything = { 0, 0, binWidth, binHeight };
+            _freeRects.push_back(everything);
+        }
+
+        virtual bool Insert(const unsigned int width, const unsigned int height,
+            unsigned int &x, unsigned int &y)
+        {
+            // best short side fit: the free rectangle that leaves the smallest leftover along
+            // its shorter side, and on a tie, along its longer side
+            size_t bestIndex = _freeRects.size();
+            unsigned int bestShortSide = 0;
+            unsigned int bestLongSide = 0;
+            for (size_t rectIndex = 0; rectIndex < _freeRects.size(); rectIndex++)
+            {
+                const Rect &free = _freeRects[rectIndex];
+                if (width > free.width || height > free.height)
+                {
+                    continue;
+                }
+
+                unsigned int leftoverX = free.width - width;
+                unsigned int leftoverY = free.height - height;
+                unsigned int shortSide = std::min(leftoverX, leftoverY);
+                unsigned int longSide = std::max(leftoverX, leftoverY);
+                if (bestIndex == _freeRects.size() || shortSide < bestShortSide ||
+                    (shortSide == bestShortSide && longSide < bestLongSide))
+                {
+                    bestIndex = rectIndex;
+                    bestShortSide = shortSide;
+                    bestLongSide = longSide;
+                }
+            }
+
+            if (bestIndex == _freeRects.size())
+            {
+                return false;
+            }
+
+            Rect used = { _freeRects[bestIndex].x, _freeRects[bestIndex].y, width, height };
+            x = used.x;
+            y = used.y;
+
+            // carve the placed rectangle out of every free rectangle that it overlaps
+            std::vector<Rect> newRects;
+            for (size_t rectIndex = 0; rectIndex < _freeRects.size(); )
+            {
+                if (Split(_freeRects[rectIndex], used, newRects))
+                {
+                    _freeRects.erase(_freeRects.begin() + rectIndex);
+                }
+                else
+                {
+                    rectIndex++;
+                }
+            }
+            _freeRects.insert(_freeRects.end(), newRects.begin(), newRects.end());
+            Prune();
+            return true;
+        }
+
+    private:
+        struct Rect
+        {
+            unsigned int x;
+            unsigned int y;
+            unsigned int width;
+            unsigned int height;
+        };
+
+        // returns: true if "used" overlapped "free", in which case the up to 4 leftover pieces
+        // of "free" were added to "pieces"
+        static bool Split(const Rect &free, const Rect &used, std::vector<Rect> &pieces)
+        {
+            if (used.x >= free.x + free.width || used.x + used.width <= free.x ||
+                used.y >= free.y + free.height || used.y + used.height <= free.y)
+            {
+                return false;
+            }
+
+            if (used.y > free.y)
+            {
+                Rect above = { free.x, free.y, free.width, used.y - free.y };
+                pieces.push_back(above);
+            }
+
+            if (used.y + used.height < free.y + free.height)
+            {
+                Rect below = { free.x, used.y + used.height, free.width,
+                    (free.y + free.height) - (used.y + used.height) };
+                pieces.push_back(below);
+            }
+
+            if (used.x > free.x)
+            {
+                Rect left = { free.x, free.y, used.x - free.x, free.height };
+                pieces.push_back(left);
+            }
+
+            if (used.x + used.width < free.x + free.width)
+            {
+                Rect right = { used.x + used.width, free.y,
+                    (free.x + free.width) - (used.x + used.width), free.height };
+                pieces.push_back(right);
+            }
+
+            return true;
+        }
+
+        static bool Contains(const Rect &outer, const Rect &inner)
+        {
+            return inner.x >= outer.x && inner.y >= outer.y &&
+                inner.x + inner.width <= outer.x + outer.width &&
+                inner.y + inner.height <= outer.y + outer.height;
+        }
+
+        // a free rectangle that is completely inside another one is redundant
+        void Prune()
+        {
+            for (size_t i = 0; i < _freeRects.size(); i++)
+            {
+                for (size_t j = i + 1; j < _freeRects.size(); )
+                {
+                    if (Contains(_freeRects[i], _freeRects[j]))
+                    {
+                        _freeRects.erase(_freeRects.begin() + j);
+                    }
+                    else if (Contains(_freeRects[j], _freeRects[i]))
+                    {
+                        _freeRects.erase(_freeRects.begin() + i);
+                        i--;
+                        break;
+                    }
+                    else
+                    {
+                        j++;
+                    }
+                }
+            }
+        }
+
+        std::vector<Rect> _freeRects;
+    };
+
+    unsigned int NextPowerOfTwo(const unsigned int value)
+    {
+        unsigned int result = 1;
+        while (result < value)
+        {
+            result <<= 1;
+        }
+
+        return result;
+    }
+
+    // tallest first, then widest first, which gives every one of the packers a better result
+    // than the order the glyphs happen to come in
+    struct TallestFirst
+    {
+        const std::vector<PackRect> *rects;
+        bool operator()(const size_t a, const size_t b) const
+        {
+            const PackRect &rectA = (*rects)[a];
+            const PackRect &rectB = (*rects)[b];
+            if (rectA.height != rectB.height)
+            {
+                return rectA.height > rectB.height;
+            }
+
+            if (rectA.width != rectB.width)
+            {
+                return rectA.width > rectB.width;
+            }
+
+            // keeps the order (and therefore the layout) deterministic
+            return a < b;
+        }
+    };
+}
+
+std::unique_ptr<GlyphPacker> GlyphPacker::Create(const PackingMethod method)
+{
+    switch (method)
+    {
+    case PackingMethod::Shelf: return std::unique_ptr<GlyphPacker>(new ShelfPacker());
+    case PackingMethod::MaxRects: return std::unique_ptr<GlyphPacker>(new MaxRectsPacker());
+    case PackingMethod::Skyline:
+    default:
+        return std::unique_ptr<GlyphPacker>(new SkylinePacker());
+    }
+}
+
+bool PackRects(const PackingMethod method, const bool powerOfTwo,
+    const unsigned int maxTextureSize, std::vector<PackRect> &rects, PackReport &report)
+{
+    report.method = method;
+    report.atlasWidth = 0;
+    report.atlasHeight = 0;
+    report.usedPixels = 0;
+    report.occupancy = 0.0f;
+    report.wastedBytes = 0;
+    report.sharedGlyphs = 0;
+    report.sharedBytes = 0;
+
+    unsigned int widest = 1;
+    unsigned int tallest = 1;
+    for (size_t rectIndex = 0; rectIndex < rects.size(); rectIndex++)
+    {
+        widest = std::max(widest, rects[rectIndex].width);
+        tallest = std::max(tallest, rects[rectIndex].height);
+        report.usedPixels += (size_t)rects[rectIndex].width * rects[rectIndex].height;
+    }
+
+    if (widest > maxTextureSize || tallest > maxTextureSize)
+    {
+        return false;
+    }
+
+    std::vector<size_t> order(rects.size());
+    for (size_t rectIndex = 0; rectIndex < order.size(); rectIndex++)
+    {
+        order[rectIndex] = rectIndex;
+    }
+    TallestFirst tallestFirst = { &rects };
+    std::sort(order.begin(), order.end(), tallestFirst);
+
+    // start with the smallest near-square atlas that could possibly hold everything
+    // Note: Nothing packs perfectly, so the first attempt will often fail, but growing from
+    // below is what keeps the atlas small.
+    unsigned int side = (unsigned int)ceil(sqrt((double)report.usedPixels));
+    unsigned int width = std::max(side, widest);
+    unsigned int height = std::max((unsigned int)((report.usedPixels + width - 1) / width),
+        tallest);
+    if (powerOfTwo)
+    {
+        width = NextPowerOfTwo(width);
+        height = NextPowerOfTwo(std::max((unsigned int)(report.usedPixels / width), tallest));
+    }
+    width = std::min(width, maxTextureSize);
+    height = std::min(height, maxTextureSize);
+
+    std::unique_ptr<GlyphPacker> packer = GlyphPacker::Create(method);
+    while (true)
+    {
+        packer->Reset(width, height);
+
+        bool allFit = true;
+        for (size_t orderIndex = 0; orderIndex < order.size() && allFit; orderIndex++)
+        {
+            PackRect &rect = rects[order[orderIndex]];
+            allFit = packer->Insert(rect.width, rect.height, rect.x, rect.y);
+        }
+
+        if (allFit)
+        {
+            break;
+        }
+
+        if (width == maxTextureSize && height == maxTextureSize)
+        {
+            // out of room
+            return false;
+        }
+
+        // grow the shorter side (or the height on a tie) so that the atlas stays close to
+        // square
+        bool growWidth = (width < height && width < maxTextureSize) || height == maxTextureSize;
+        unsigned int &grow = growWidth ? width : height;
+        grow = powerOfTwo ? (grow * 2) : (grow + std::max(grow / 8, 1u));
+        grow = std::min(grow, maxTextureSize);
+    }
+
+    if (!powerOfTwo)
+    {
+        // the last attempt was likely taller and wider than it needed to be, so trim the atlas
+        // down to what the rectangles actually use
+        unsigned int usedWidth = 0;
+        unsigned int usedHeight = 0;
+        for (size_t rectIndex = 0; rectIndex < rects.size(); rectIndex++)
+        {
+            usedWidth = std::max(usedWidth, rects[rectIndex].x + rects[rectIndex].width);
+            usedHeight = std::max(usedHeight, rects[rectIndex].y + rects[rectIndex].height);
+        }
+        width = std::max(usedWidth, 1u);
+        height = std::max(usedHeight, 1u);
+    }
+
+    report.atlasWidth = width;
+    report.atlasHeight = height;
+    report.occupancy = (float)report.usedPixels / ((float)width * (float)height);
+    report.wastedBytes = ((size_t)width * height) - report.usedPixels;
+    return true;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <memory>   // for the unique pointer that the factory returns
+#include <vector>
+
+// the available strategies for deciding where each glyph goes in the atlas
+// - Shelf: left to right in rows that are as tall as their tallest glyph (the original)
+// - Skyline: tracks the top edge of everything placed so far and drops each glyph into the
+// lowest spot it fits (bottom-left heuristic); fast and packs glyphs well
+// - MaxRects: tracks every maximal free rectangle and picks the one that leaves the shortest
+// leftover side (best short side fit); tightest, but slower as the glyph count grows
+enum class PackingMethod
+{
+    Shelf,
+    Skyline,
+    MaxRects
+};
+
+// one rectangle to pack; the packer fills in x and y
+// Note: Dimensions include any gutter that the caller wants between glyphs.
+struct PackRect
+{
+    unsigned int width;
+    unsigned int height;
+    unsigned int x;
+    unsigned int y;
+};
+
+// how well a set of rectangles fit into the atlas
+struct PackReport
+{
+    PackingMethod method;
+    unsigned int atlasWidth;
+    unsigned int atlasHeight;
+
+    // pixels covered by the rectangles (including gutters) and the percentage of the atlas
+    // that they occupy
+    size_t usedPixels;
+    float occupancy;
+
+    // atlas bytes that hold nothing (1 byte per pixel)
+    size_t wastedBytes;
+
+    // glyphs whose bitmaps were identical to another glyph's and so share its spot in the 
+    // atlas instead of getting their own, and the atlas bytes (gutters included) that they 
+    // would have taken up (see AtlasBuilder)
+    // Note: PackRects(...) sets these to 0 since it only sees rectangles.
+    size_t sharedGlyphs;
+    size_t sharedBytes;
+};
+
+// packs rectangles into a single fixed-size bin, one at a time
+// Note: Rectangles are never rotated because glyph quads assume upright glyphs.
+class GlyphPacker
+{
+public:
+    virtual ~GlyphPacker() {}
+
+    // throws away anything that was placed and starts over with an empty bin
+    virtual void Reset(const unsigned int binWidth, const unsigned int binHeight) = 0;
+
+    // returns: true and the top left corner of the rectangle if there was room, otherwise false
+    virtual bool Insert(const unsigned int width, const unsigned int height, unsigned int &x,
+        unsigned int &y) = 0;
+
+    static std::unique_ptr<GlyphPacker> Create(const PackingMethod method);
+};
+
+// packs all of the rectangles into the smallest atlas that it can find, starting from a square
+// that is just big enough for the rectangles' total area and growing the shorter side until
+// everything fits
+// Note: If "powerOfTwo" is true, then both atlas dimensions are powers of two.  Otherwise the
+// atlas height is trimmed to the lowest rectangle.
+// returns: true if everything fits in maxTextureSize x maxTextureSize, otherwise false
+bool PackRects(const PackingMethod method, const bool powerOfTwo,
+    const unsigned int maxTextureSize, std::vector<PackRect> &rects, PackReport &report);
@@ -0,0 +1,106 @@
+#include "GlyphQuads.h"
+
+#include <algorithm>    // for std::min, std::max
+
+unsigned int PackColor(const float color[4])
+{
+    // round to the nearest of the 256 levels and clamp to what fits
+    unsigned int packed = 0;
+    for (unsigned int channel = 0; channel < 4; channel++)
+    {
+        float level = std::min(std::max(color[channel], 0.0f), 1.0f) * 255.0f;
+        packed |= (unsigned int)(level + 0.5f) << (channel * 8);
+    }
+    return packed;
+}
+
+void MakeGlyphQuad(const GlyphQuadMetrics &glyph, const float userScale[2],
+    const unsigned int color, float pen[2], TextVertex corners[VerticesPerQuad])
+{
+    // figure out where the texture needs to start drawing in pixels
+    // Note: A glyph has a formal origin point that we (humans) usually think of as being where
+    // the character "starts".  But as far as OpenGL is concerned, I have a 2D rectangle of pixel
+    // data, and that's it.  If I drew that texture at the pen, then the character would likely
+    // look like it isn't centered.  The TrueType format provides info that FreeType extracts so
+    // that I can figure out where to draw the texture so that it LOOKS like the glyph ('g', c,
+    // ';', etc.) "starts" at the pen.
+    float scaledGlyphLeft = glyph.bl * userScale[0];
+    float scaledGlyphWidth = glyph.bw * userScale[0];
+    float scaledGlyphTop = glyph.bt * userScale[1];
+    float scaledGlyphHeight = glyph.bh * userScale[1];
+    float pixelLeft = pen[0] - scaledGlyphLeft;
+    float pixelRight = pixelLeft + scaledGlyphWidth;
+    float pixelTop = pen[1] + scaledGlyphTop;
+    float pixelBottom = pixelTop - scaledGlyphHeight;
+
+    // Note: Remember that textures use their own 2D coordinate system (S,T) to avoid confusion
+    // with pixel coordinates (X,Y).
+    float sLeft = glyph.tx;
+    float sRight = glyph.tx + glyph.nbw;
+    float tBottom = glyph.ty;
+    float tTop = glyph.ty + glyph.nbh;
+
+    // Note: Bitmap standards (and most other rectangle standards in programming, such as for
+    // GUIs) understand the top left as the origin, and therefore the texture's pixels are
+    // provided in a rectangle that goes from top left to bottom right.  OpenGL draws textures
+    // from lower left ([S=0,T=0]) to upper right ([S=1,T=1]).  This means that the texture,
+    // from OpenGL's perspective, is "upside down", so the bottom of the quad gets the larger T.
+    TextVertex bottomLeft = { pixelLeft, pixelBottom, sLeft, tTop, color };
+    TextVertex bottomRight = { pixelRight, pixelBottom, sRight, tTop, color };
+    TextVertex topLeft = { pixelLeft, pixelTop, sLeft, tBottom, color };
+    TextVertex topRight = { pixelRight, pixelTop, sRight, tBottom, color };
+    corners[0] = bottomLeft;
+    corners[1] = bottomRight;
+    corners[2] = topLeft;
+    corners[3] = topRight;
+
+    // advance the pen for the next character
+    // Note: The Y advance is only used in fonts that are meant to be written vertically.
+    pen[0] += glyph.ax * userScale[0];
+    pen[1] += glyph.ay * userScale[1];
+}
+
+bool GlyphQuadOverlaps(const GlyphQuadMetrics &glyph, const float userScale[2],
+    const float pen[2], const PixelRect &rect)
+{
+    if (glyph.bw == 0.0f || glyph.bh == 0.0f)
+    {
+        return false;
+    }
+
+    // the same corners as MakeGlyphQuad(...)
+    // Note: A negative scale mirrors the quad, so its edges can be either way around.
+    float pixelLeft = pen[0] - (glyph.bl * userScale[0]);
+    float pixelRight = pixelLeft + (glyph.bw * userScale[0]);
+    float pixelTop = pen[1] + (glyph.bt * userScale[1]);
+    float pixelBottom = pixelTop - (glyph.bh * userScale[1]);
+    return std::min(pixelLeft, pixelRight) < rect.right &&
+        std::max(pixelLeft, pixelRight) > rect.left &&
+        std::min(pixelBottom, pixelTop) < rect.top &&
+        std::max(pixelBottom, pixelTop) > rect.bottom;
+}
+
+void MakeQuadIndices(const unsigned int quadCount, std::vector<unsigned short> &indices)
+{
+    indices.resize(quadCount * IndicesPerQuad);
+    for (unsigned int quadIndex = 0; quadIndex < quadCount; quadIndex++)
+    {
+        unsigned short firstVertex = (unsigned short)(quadIndex * VerticesPerQuad);
+        unsigned short *quadIndices = indices.data() + (quadIndex * IndicesPerQuad);
+
+        // bottom left, bottom right, top left, and then top left, bottom right, top right
+        quadIndices[0] = firstVertex;
+        quadIndices[1] = firstVertex + 1;
+        quadIndices[2] = firstVertex + 2;
+        quadIndices[3] = firstVertex + 2;
+        quadIndices[4] = firstVertex + 1;
+        quadIndices[5] = firstVertex + 3;
+    }
+}
+
+unsigned short GlyphScaleToFixed(const float scale)
+{
+    // round to the nearest 1/256 and clamp to what fits
+    float fixedScale = (scale * 256.0f) + 0.5f;
+    return (unsigned short)std::min(std::max(fixedScale, 1.0f), 65535.0f);
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <vector>
+
+// Every glyph is drawn as a quad: 4 vertices (bottom left, bottom right, top left, top right)
+// and 6 indices (two triangles, 0-1-2 and 2-1-3, both counterclockwise) that pick them.  The
+// vertices are the only thing that changes from string to string, so they are the only thing
+// that is uploaded per draw; the indices are the same pattern for every quad and live in one
+// buffer that every atlas shares (see QuadIndexBuffer.h).
+// Note: Nothing in here needs OpenGL, so the vertex and index streams can be checked without
+// a window or a context.
+
+// one corner of a glyph's quad: pixels, then texture coordinates, then color
+// Note: Pixels are counted from the window's bottom left corner.  The vertex shader turns them
+// into OpenGL's [-1,+1] screen coordinates with a uniform (see
+// FreeTypeEncapsulate::SetViewportSize(...)), so resizing the window doesn't change any
+// vertices.
+// Also Note: The color used to be a uniform, so text in every color was its own draw call.
+// Now it is in every vertex (see PackColor(...)), and text in any number of colors can go out
+// in one draw call.  It costs 4 bytes per vertex.
+struct TextVertex
+{
+    float x;
+    float y;
+    float s;
+    float t;
+    unsigned int color;
+};
+
+// everything needed to place a glyph's quad, in pixels and texture coordinates
+struct GlyphQuadMetrics
+{
+    // advance X and Y in pixels
+    float ax;
+    float ay;
+
+    // bitmap left and top in pixels
+    float bl;
+    float bt;
+
+    // glyph bitmap width and height in pixels
+    float bw;
+    float bh;
+
+    // glyph bitmap width and height normalized to [0.0,1.0] for texture coordinate calculations
+    // Note: It is better for performance to do the normalization (a division) at startup.
+    float nbw;
+    float nbh;
+
+    // TODO: change to "texture S" and "texture T" to be clear
+    float tx;	// x offset of glyph in texture coordinates (S on range [0.0,1.0])
+    float ty;	// y offset of glyph in texture coordinates (T on range [0.0,1.0])
+};
+
+// how many vertices and indices a quad takes
+const unsigned int VerticesPerQuad = 4;
+const unsigned int IndicesPerQuad = 6;
+
+// packs a color on the range [0.0,1.0] into 8 bits per channel
+// returns: red in the lowest byte and alpha in the highest, which on a little-endian CPU (x86,
+// ARM) puts the bytes in memory in R, G, B, A order, which is how the vertex shaders read them
+unsigned int PackColor(const float color[4]);
+
+// takes: the glyph, the user's scale, the packed color, and the pen (the glyph's origin in
+// pixels)
+// writes the glyph's 4 corners in the order above and then moves the pen by the advance
+// Note: The advance is scaled along with the glyph so that scaled text doesn't overlap
+// itself.
+void MakeGlyphQuad(const GlyphQuadMetrics &glyph, const float userScale[2],
+    const unsigned int color, float pen[2], TextVertex corners[VerticesPerQuad]);
+
+// a rectangle in pixels, counted from the window's bottom left corner like the vertices
+struct PixelRect
+{
+    float left;
+    float bottom;
+    float right;
+    float top;
+};
+
+// returns: true if any part of the quad that MakeGlyphQuad(...) would make at the pen is
+// inside the rectangle
+// Note: Nothing is written and the pen doesn't move, so a glyph that can't be seen can be
+// skipped before any of its vertices go up (see FreeTypeAtlas::SetClipRect(...)).  A glyph
+// with no pixels (whitespace) is never inside.
+bool GlyphQuadOverlaps(const GlyphQuadMetrics &glyph, const float userScale[2],
+    const float pen[2], const PixelRect &rect);
+
+// The instanced path (see FreeTypeAtlas::RenderTextInstanced(...)) sends one of these per
+// glyph instead of 4 vertices, 20 bytes instead of 80, and shader_instanced.vert makes the
+// quad from the glyph's entry in a table that the atlas keeps on the GPU.
+struct GlyphInstance
+{
+    // the glyph's origin in pixels
+    float penX;
+    float penY;
+
+    // the glyph's entry in the table
+    unsigned int glyphIndex;
+
+    // the user's scale in 8.8 fixed point (see GlyphScaleToFixed(...))
+    unsigned short scaleX;
+    unsigned short scaleY;
+
+    // see PackColor(...)
+    unsigned int color;
+};
+
+// a glyph's entry in the table that the instanced path and the compute layout (see
+// shader_layout.comp) make quads from, all in pixels
+// Note: The texture coordinates are in texels rather than [0.0,1.0] so that nothing in the
+// table has to change when the atlas' texture grows (the shader divides by the texture's
+// size).  The table is an std430 array, so every entry is a multiple of 16 bytes.
+struct GlyphTableEntry
+{
+    // bitmap left, bitmap top, width, and height
+    float bl;
+    float bt;
+    float bw;
+    float bh;
+
+    // the bitmap's top left corner in the texture
+    float x;
+    float y;
+
+    // advance X and Y, for the compute layout's pen positions
+    // Note: These used to be padding.
+    float ax;
+    float ay;
+};
+
+// 8.8 fixed point, so scales from 1/256 up to just under 256
+unsigned short GlyphScaleToFixed(const float scale);
+
+// fills in the indices for the given number of quads, with quad N using vertices 4N to 4N + 3
+// Note: The indices are 16 bits, so quadCount can be at most 16384 (65536 vertices).  Longer
+// runs of quads are drawn in pieces with a base vertex (see QuadIndexBuffer::DrawQuads(...)).
+void MakeQuadIndices(const unsigned int quadCount, std::vector<unsigned short> &indices);
@@ -0,0 +1,236 @@
+// GlyphQuadsTest: a command-line test of the vertex and index streams that every glyph quad is
+// drawn from (see GlyphQuads.h).  Nothing in there needs OpenGL, so neither does this, and it
+// runs without a window.
+//
+// usage: GlyphQuadsTest
+//
+// A short string is laid out with made-up glyph metrics, so that every corner's pixels,
+// texture coordinates, and color can be worked out by hand, and then the indices are checked
+// against the 0, 1, 2, 2, 1, 3 pattern.  Each failure is printed, and the exit code is 1 if
+// there were any.
+//
+// Build note: This is its own project (glyph_quads_test.vcxproj) because it has its own
+// main(...), and the project runs it after every build, so a broken quad fails the build.
+
+#include "GlyphQuads.h"
+
+#include <stdio.h>
+#include <string.h>     // for memcpy(...), strlen(...)
+
+#include <string>
+#include <vector>
+
+static unsigned int gFailureCount = 0;
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Prints what was expected and what came out if they aren't the same.
+Parameters:
+    what        What is being checked, for the message.
+    expected    What it should be.
+    actual      What it is.
+Returns:    None
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static void CheckFloat(const char *what, const float expected, const float actual)
+{
+    // Note: Every value in here is a small multiple of a power of 2, so the math is exact.
+    if (expected != actual)
+    {
+        fprintf(stderr, "%s: expected %g, got %g\n", what, expected, actual);
+        gFailureCount++;
+    }
+}
+
+static void CheckUnsigned(const char *what, const unsigned int expected,
+    const unsigned int actual)
+{
+    if (expected != actual)
+    {
+        fprintf(stderr, "%s: expected %u (0x%08X), got %u (0x%08X)\n", what, expected,
+            expected, actual, actual);
+        gFailureCount++;
+    }
+}
+
+// made-up metrics for the characters in the test string
+// Note: The texture coordinates are eighths and sixteenths so that they add up exactly.
+static GlyphQuadMetrics MetricsFor(const char c)
+{
+    GlyphQuadMetrics metrics;
+    memset(&metrics, 0, sizeof(metrics));
+    switch (c)
+    {
+    case 'A':
+        // ax, ay, bl, bt, bw, bh, nbw, nbh, tx, ty
+        metrics = { 10.0f, 0.0f, 1.0f, 12.0f, 8.0f, 12.0f, 0.125f, 0.25f, 0.0f, 0.0f };
+        break;
+    case 'g':
+        // hangs below the baseline
+        metrics = { 7.0f, 0.0f, -1.0f, 6.0f, 6.0f, 10.0f, 0.0625f, 0.125f, 0.5f, 0.25f };
+        break;
+    default:
+        // whitespace: an advance and no bitmap
+        metrics.ax = 4.0f;
+        break;
+    }
+    return metrics;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Lays out "Ag g" with a scale and a color the same way that FreeTypeAtlas::AppendText(...)
+    does and checks every vertex.
+Parameters:     None
+Returns:        None
+Exception:      Safe
+-----------------------------------------------------------------------------------------------*/
+static void TestVertices()
+{
+    const char *str = "Ag g";
+    const float userScale[2] = { 2.0f, 0.5f };
+    const float color[4] = { 1.0f, 0.5f, 0.0f, 0.25f };
+    const unsigned int packedColor = PackColor(color);
+
+    // red in the lowest byte, and 0.5 and 0.25 round to the nearest of 256 levels
+    CheckUnsigned("packed color", 0x400080FF, packedColor);
+
+    size_t glyphCount = strlen(str);
+    std::vector<TextVertex> vertices(glyphCount * VerticesPerQuad);
+    float pen[2] = { 100.0f, 50.0f };
+    for (size_t glyphIndex = 0; glyphIndex < glyphCount; glyphIndex++)
+    {
+        const GlyphQuadMetrics metrics = MetricsFor(str[glyphIndex]);
+        float glyphPen[2] = { pen[0], pen[1] };
+        TextVertex *corners = vertices.data() + (glyphIndex * VerticesPerQuad);
+        MakeGlyphQuad(metrics, userScale, packedColor, pen, corners);
+
+        // bottom left, bottom right, top left, top right, worked out by hand from the pen that
+        // the glyph started at
+        float left = glyphPen[0] - (metrics.bl * userScale[0]);
+        float right = left + (metrics.bw * userScale[0]);
+        float top = glyphPen[1] + (metrics.bt * userScale[1]);
+        float bottom = top - (metrics.bh * userScale[1]);
+        const float expectedX[VerticesPerQuad] = { left, right, left, right };
+        const float expectedY[VerticesPerQuad] = { bottom, bottom, top, top };
+
+        // the bitmap is upside down as far as OpenGL is concerned, so the bottom of the quad
+        // gets the bigger T (see MakeGlyphQuad(...))
+        float sLeft = metrics.tx;
+        float sRight = metrics.tx + metrics.nbw;
+        float tTop = metrics.ty;
+        float tBottom = metrics.ty + metrics.nbh;
+        const float expectedS[VerticesPerQuad] = { sLeft, sRight, sLeft, sRight };
+        const float expectedT[VerticesPerQuad] = { tBottom, tBottom, tTop, tTop };
+
+        for (unsigned int corner = 0; corner < VerticesPerQuad; corner++)
+        {
+            char what[64];
+            snprintf(what, sizeof(what), "glyph %u corner %u", (unsigned int)glyphIndex, corner);
+            std::string prefix = what;
+            CheckFloat((prefix + " x").c_str(), expectedX[corner], corners[corner].x);
+            CheckFloat((prefix + " y").c_str(), expectedY[corner], corners[corner].y);
+            CheckFloat((prefix + " s").c_str(), expectedS[corner], corners[corner].s);
+            CheckFloat((prefix + " t").c_str(), expectedT[corner], corners[corner].t);
+            CheckUnsigned((prefix + " color").c_str(), packedColor, corners[corner].color);
+        }
+
+        // the pen moves by the scaled advance
+        CheckFloat("pen x", glyphPen[0] + (metrics.ax * userScale[0]), pen[0]);
+        CheckFloat("pen y", glyphPen[1] + (metrics.ay * userScale[1]), pen[1]);
+    }
+
+    // a few corners by their actual numbers, in case the hand math above has the same mistake
+    // as MakeGlyphQuad(...)
+    // 'A' at (100, 50): left 100 - 2, right 98 + 16, top 50 + 6, bottom 56 - 6
+    CheckFloat("'A' bottom left x", 98.0f, vertices[0].x);
+    CheckFloat("'A' bottom left y", 50.0f, vertices[0].y);
+    CheckFloat("'A' top right x", 114.0f, vertices[3].x);
+    CheckFloat("'A' top right y", 56.0f, vertices[3].y);
+    CheckFloat("'A' bottom left t", 0.25f, vertices[0].t);
+    CheckFloat("'A' top right s", 0.125f, vertices[3].s);
+
+    // 'g' at (120, 50): left 120 + 2, top 50 + 3, bottom 53 - 5, so it hangs below the line
+    CheckFloat("'g' bottom left x", 122.0f, vertices[4].x);
+    CheckFloat("'g' bottom left y", 48.0f, vertices[4].y);
+
+    // the space is a quad with no area at its pen, (134, 50)
+    for (unsigned int corner = 0; corner < VerticesPerQuad; corner++)
+    {
+        CheckFloat("space x", 134.0f, vertices[8 + corner].x);
+        CheckFloat("space y", 50.0f, vertices[8 + corner].y);
+    }
+
+    // the pen ends after 10 + 7 + 4 + 7 advance pixels, times 2
+    CheckFloat("final pen x", 156.0f, pen[0]);
+
+    // the vertex shaders read the color as 4 normalized bytes in R, G, B, A order
+    unsigned char colorBytes[4];
+    memcpy(colorBytes, &vertices[0].color, sizeof(colorBytes));
+    CheckUnsigned("color byte R", 255, colorBytes[0]);
+    CheckUnsigned("color byte G", 128, colorBytes[1]);
+    CheckUnsigned("color byte B", 0, colorBytes[2]);
+    CheckUnsigned("color byte A", 64, colorBytes[3]);
+
+    // the compute layout writes the vertices 5 words at a time (see shader_layout.comp)
+    CheckUnsigned("vertex size", 20, (unsigned int)sizeof(TextVertex));
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Checks that every quad's indices are 0, 1, 2, 2, 1, 3 plus 4 times the quad's number, for
+    a few quads and for the most that 16-bit indices can reach.
+Parameters:     None
+Returns:        None
+Exception:      Safe
+-----------------------------------------------------------------------------------------------*/
+static void TestIndices()
+{
+    const unsigned short pattern[IndicesPerQuad] = { 0, 1, 2, 2, 1, 3 };
+    const unsigned int quadCounts[] = { 0, 1, 3, 16384 };
+    for (size_t countIndex = 0; countIndex < sizeof(quadCounts) / sizeof(quadCounts[0]);
+        countIndex++)
+    {
+        unsigned int quadCount = quadCounts[countIndex];
+        std::vector<unsigned short> indices(7, 0xFFFF);
+        MakeQuadIndices(quadCount, indices);
+        CheckUnsigned("index count", quadCount * IndicesPerQuad, (unsigned int)indices.size());
+        if (indices.size() != quadCount * IndicesPerQuad)
+        {
+            continue;
+        }
+        for (unsigned int quadIndex = 0; quadIndex < quadCount; quadIndex++)
+        {
+            for (unsigned int index = 0; index < IndicesPerQuad; index++)
+            {
+                unsigned int expected = pattern[index] + (quadIndex * VerticesPerQuad);
+                unsigned int actual = indices[(quadIndex * IndicesPerQuad) + index];
+                if (expected != actual)
+                {
+                    char what[64];
+                    snprintf(what, sizeof(what), "quad %u of %u index %u", quadIndex,
+                        quadCount, index);
+                    CheckUnsigned(what, expected, actual);
+                }
+            }
+        }
+    }
+
+    // the last quad that 16-bit indices can reach uses the last 4 of them
+    std::vector<unsigned short> indices;
+    MakeQuadIndices(16384, indices);
+    CheckUnsigned("last index", 65535, indices.back());
+}
+
+int main()
+{
+    TestVertices();
+    TestIndices();
+    if (gFailureCount != 0)
+    {
+        fprintf(stderr, "GlyphQuadsTest: %u checks failed\n", gFailureCount);
+        return 1;
+    }
+    printf("GlyphQuadsTest: all checks passed\n");
+    return 0;
+}
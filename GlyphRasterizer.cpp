@@ -0,0 +1,423 @@
+// Note: Programs that only draw baked atlases don't link FreeType (see FreeTypeEncapsulate.h), 
+// so there is nothing to compile in here for them.
+#ifndef FREETYPE_ATLAS_BAKED_ONLY
+#include "GlyphRasterizer.h"
+
+#include FT_TRUETYPE_TABLES_H   // for FT_Load_Sfnt_Table(...)
+#include FT_TRUETYPE_TAGS_H     // for TTAG_kern
+
+#include <stdio.h>      // for fprintf(...)
+#include <string.h>     // for memcpy(...)
+
+#include <algorithm>    // for std::min, std::max
+#include <atomic>       // for handing out ranges of code points to the worker threads
+#include <thread>
+#include <unordered_map>
+#include <utility>      // for std::pair
+
+std::vector<unsigned int> AsciiCodePoints()
+{
+    // the basic set is 2^7 = 128 items, and the first 32 are non-printable, so skip them
+    return CodePointRange(32, 127);
+}
+
+std::vector<unsigned int> CodePointRange(const unsigned int first, const unsigned int last)
+{
+    std::vector<unsigned int> codePoints;
+    if (last < first)
+    {
+        return codePoints;
+    }
+
+    codePoints.reserve(last - first + 1);
+    for (unsigned int charCode = first; charCode <= last; charCode++)
+    {
+        codePoints.push_back(charCode);
+    }
+
+    return codePoints;
+}
+
+void RasterizeGlyphs(const FT_Face face, const int fontPixelHeightSize,
+    const std::vector<unsigned int> &codePoints, GlyphArena &arena)
+{
+    // configure the font's size
+    // Note: Setting the pixel width (middle argument) to 0 lets FreeType determine font width 
+    // based on the provided height.
+    // http://learnopengl.com/#!In-Practice/Text-Rendering
+    FT_Set_Pixel_Sizes(face, 0, fontPixelHeightSize);
+
+    // save some dereferencing
+    FT_GlyphSlot glyph = face->glyph;
+
+    arena.glyphs.reserve(arena.glyphs.size() + codePoints.size());
+
+    for (size_t codePointIndex = 0; codePointIndex < codePoints.size(); codePointIndex++)
+    {
+        unsigned int charCode = codePoints[codePointIndex];
+        if (FT_Load_Char(face, charCode, FT_LOAD_RENDER))
+        {
+            fprintf(stderr, "Loading character '%u' failed\n", charCode);
+            continue;
+        }
+
+        // because "advance" is stored, for reasons only the FreeType creator knows, in 1/64
+        // pixels, and dividing by 2^6 (64) will generate it in pixels
+        RasterizedGlyph info;
+        info.codePoint = charCode;
+        info.ax = (float)(glyph->advance.x >> 6);
+        info.ay = (float)(glyph->advance.y >> 6);
+        info.bl = (float)(glyph->bitmap_left);
+        info.bt = (float)(glyph->bitmap_top);
+        info.width = glyph->bitmap.width;
+        info.rows = glyph->bitmap.rows;
+        info.pixelOffset = arena.pixels.size();
+
+        // copy the bitmap one row at a time
+        // Note: FreeType's "pitch" is the number of bytes between the start of one row and the
+        // start of the next.  It is usually the same as the width for 8-bit greyscale bitmaps,
+        // but FreeType is allowed to pad the rows, and a negative pitch means that the rows are
+        // stored bottom-up.  Copying row by row deals with both and leaves the arena's copy
+        // tightly packed.
+        arena.pixels.resize(arena.pixels.size() + (info.width * info.rows));
+        unsigned char *dest = arena.pixels.data() + info.pixelOffset;
+        for (unsigned int row = 0; row < info.rows; row++)
+        {
+            const unsigned char *src = glyph->bitmap.buffer;
+            if (glyph->bitmap.pitch >= 0)
+            {
+                src += row * glyph->bitmap.pitch;
+            }
+            else
+            {
+                src += (info.rows - 1 - row) * (-glyph->bitmap.pitch);
+            }
+
+            memcpy(dest + (row * info.width), src, info.width);
+        }
+
+        arena.glyphs.push_back(info);
+    }
+}
+
+bool RasterizeGlyphsParallel(const unsigned char *fontFileBytes, const size_t fontFileSize,
+    const int fontPixelHeightSize, const std::vector<unsigned int> &codePoints,
+    const unsigned int threadCount, GlyphArena &arena)
+{
+    unsigned int workerCount = threadCount;
+    if (workerCount == 0)
+    {
+        // hardware_concurrency() is allowed to return 0 if it can't tell
+        workerCount = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    // Hand out the work in ranges of a fixed size instead of one range per thread.  Glyphs in
+    // different parts of a font can take very different amounts of time (CJK ideographs vs. 
+    // Latin letters, for example), and small ranges let a thread that finishes early pick up 
+    // more work instead of sitting around.
+    const size_t codePointsPerRange = 64;
+    size_t rangeCount = (codePoints.size() + codePointsPerRange - 1) / codePointsPerRange;
+    workerCount = (unsigned int)std::min((size_t)workerCount, rangeCount);
+    if (workerCount == 0)
+    {
+        // nothing to do
+        return true;
+    }
+
+    // each range gets its own arena so that the workers never touch the same memory
+    std::vector<GlyphArena> rangeArenas(rangeCount);
+    std::atomic<size_t> nextRange(0);
+    std::atomic<bool> fontOpened(true);
+
+    auto worker = [&]()
+    {
+        FT_Library library;
+        if (FT_Init_FreeType(&library))
+        {
+            fprintf(stderr, "Could not init freetype library for worker thread\n");
+            fontOpened = false;
+            return;
+        }
+
+        // Note: FT_New_Memory_Face(...) does not copy the bytes, so they must outlive the face,
+        // which they do because the caller owns them until this function returns.
+        FT_Face face;
+        if (FT_New_Memory_Face(library, fontFileBytes, (FT_Long)fontFileSize, 0, &face))
+        {
+            fprintf(stderr, "Could not open font for worker thread\n");
+            FT_Done_FreeType(library);
+            fontOpened = false;
+            return;
+        }
+
+        std::vector<unsigned int> rangeCodePoints;
+        for (size_t range = nextRange++; range < rangeCount; range = nextRange++)
+        {
+            size_t first = range * codePointsPerRange;
+            size_t last = std::min(first + codePointsPerRange, codePoints.size());
+            rangeCodePoints.assign(codePoints.begin() + first, codePoints.begin() + last);
+            RasterizeGlyphs(face, fontPixelHeightSize, rangeCodePoints, rangeArenas[range]);
+        }
+
+        // FT_Done_FreeType(...) also cleans up any faces that the library opened
+        FT_Done_FreeType(library);
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(workerCount);
+    for (unsigned int workerIndex = 0; workerIndex < workerCount; workerIndex++)
+    {
+        workers.push_back(std::thread(worker));
+    }
+    for (size_t workerIndex = 0; workerIndex < workers.size(); workerIndex++)
+    {
+        workers[workerIndex].join();
+    }
+
+    if (!fontOpened)
+    {
+        return false;
+    }
+
+    // stitch the ranges back together in order
+    // Note: Each range's pixel offsets are relative to its own arena, so shift them by however
+    // many pixels came before it.
+    size_t totalGlyphs = 0;
+    size_t totalPixels = 0;
+    for (size_t range = 0; range < rangeCount; range++)
+    {
+        totalGlyphs += rangeArenas[range].glyphs.size();
+        totalPixels += rangeArenas[range].pixels.size();
+    }
+    arena.glyphs.reserve(arena.glyphs.size() + totalGlyphs);
+    arena.pixels.reserve(arena.pixels.size() + totalPixels);
+
+    for (size_t range = 0; range < rangeCount; range++)
+    {
+        const GlyphArena &rangeArena = rangeArenas[range];
+        size_t pixelShift = arena.pixels.size();
+        for (size_t glyphIndex = 0; glyphIndex < rangeArena.glyphs.size(); glyphIndex++)
+        {
+            RasterizedGlyph glyph = rangeArena.glyphs[glyphIndex];
+            glyph.pixelOffset += pixelShift;
+            arena.glyphs.push_back(glyph);
+        }
+        arena.pixels.insert(arena.pixels.end(), rangeArena.pixels.begin(),
+            rangeArena.pixels.end());
+    }
+
+    return true;
+}
+
+bool RasterizeDistanceFieldsParallel(const unsigned char *fontFileBytes, 
+    const size_t fontFileSize, const int fontPixelHeightSize, 
+    const std::vector<unsigned int> &codePoints, const DistanceFieldSettings &settings, 
+    const unsigned int threadCount, GlyphArena &arena)
+{
+    GlyphArena supersampledGlyphs;
+    int supersampledSize = fontPixelHeightSize * (int)settings.supersample;
+    if (!RasterizeGlyphsParallel(fontFileBytes, fontFileSize, supersampledSize, codePoints, 
+        threadCount, supersampledGlyphs))
+    {
+        return false;
+    }
+
+    MakeDistanceFields(supersampledGlyphs, settings, threadCount, arena);
+    return true;
+}
+
+void GlyphCellSize(const FT_Face face, const int fontPixelHeightSize, unsigned int &cellWidth, 
+    unsigned int &cellHeight)
+{
+    FT_Set_Pixel_Sizes(face, 0, fontPixelHeightSize);
+
+    // the face's bounding box is big enough for every glyph in the face
+    // Note: The box is in font units, so scale it to 26.6 fixed point pixels (1/64 pixels, 
+    // hence the ">> 6") with the same scale that the face's current size uses.
+    unsigned int width = (unsigned int)fontPixelHeightSize;
+    unsigned int height = (unsigned int)fontPixelHeightSize;
+    if (FT_IS_SCALABLE(face))
+    {
+        FT_Pos bboxWidth = FT_MulFix(face->bbox.xMax - face->bbox.xMin, 
+            face->size->metrics.x_scale);
+        FT_Pos bboxHeight = FT_MulFix(face->bbox.yMax - face->bbox.yMin, 
+            face->size->metrics.y_scale);
+        width = (unsigned int)((bboxWidth + 63) >> 6);
+        height = (unsigned int)((bboxHeight + 63) >> 6);
+    }
+
+    // A few fonts have one or two enormous glyphs that blow up the bounding box for everyone 
+    // else, so cap the cells at twice the font size.  Anything bigger won't be cached.
+    // Also Note: The "+1" is the same 1-pixel gutter that the prebuilt glyphs get.
+    unsigned int maxCellSize = 2 * (unsigned int)fontPixelHeightSize;
+    cellWidth = std::max(std::min(width, maxCellSize), 1u) + 1;
+    cellHeight = std::max(std::min(height, maxCellSize), 1u) + 1;
+}
+
+// big-endian, which is how every number in a TrueType table is stored
+static unsigned int ReadUint16(const unsigned char *bytes)
+{
+    return ((unsigned int)bytes[0] << 8) | bytes[1];
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Reads which pairs of glyphs the face's 'kern' table has anything for, without the values,
+    from the same subtables that FT_Get_Kerning(...) reads: version 0 (Microsoft) tables,
+    format 0, horizontal, and neither minimums nor cross-stream.
+Parameters:
+    face        The font.
+    glyphPairs  Cleared, and then the left and right glyph indices of every pair, sorted, with
+                no pair twice.
+Returns:
+    True if the face has a 'kern' table that could be read, otherwise false.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static bool ReadKernTablePairs(const FT_Face face,
+    std::vector<std::pair<FT_UInt, FT_UInt> > &glyphPairs)
+{
+    glyphPairs.clear();
+    FT_ULong tableSize = 0;
+    if (!FT_IS_SFNT(face) || FT_Load_Sfnt_Table(face, TTAG_kern, 0, 0, &tableSize) != 0 ||
+        tableSize < 4)
+    {
+        return false;
+    }
+    std::vector<unsigned char> table(tableSize);
+    if (FT_Load_Sfnt_Table(face, TTAG_kern, 0, table.data(), &tableSize) != 0)
+    {
+        return false;
+    }
+
+    // a version 1 (Apple) table starts with a 32-bit version, and FreeType doesn't read those
+    const unsigned char *tableEnd = table.data() + table.size();
+    const unsigned char *bytes = table.data();
+    if (ReadUint16(bytes) != 0)
+    {
+        return false;
+    }
+    unsigned int subtableCount = ReadUint16(bytes + 2);
+    bytes += 4;
+
+    // Note: The checks on the lengths and counts are FreeType's (see ttkern.c), which puts up
+    // with fonts whose subtables are longer than their 16-bit length can say.
+    for (unsigned int subtable = 0; subtable < subtableCount && bytes + 6 <= tableEnd;
+        subtable++)
+    {
+        unsigned int length = ReadUint16(bytes + 2);
+        unsigned int coverage = ReadUint16(bytes + 4);
+        if (length <= 6 + 8)
+        {
+            break;
+        }
+        const unsigned char *subtableEnd =
+            (length < (size_t)(tableEnd - bytes)) ? bytes + length : tableEnd;
+
+        // the override bit (8) only says how the values add up, which FT_Get_Kerning(...)
+        // takes care of
+        const unsigned char *body = bytes + 6;
+        if ((coverage & ~8u) == 0x0001 && body + 8 <= subtableEnd)
+        {
+            size_t pairCount = ReadUint16(body);
+            const unsigned char *pairBytes = body + 8;
+            pairCount = std::min(pairCount, (size_t)(subtableEnd - pairBytes) / 6);
+            for (size_t pairIndex = 0; pairIndex < pairCount; pairIndex++)
+            {
+                const unsigned char *pair = pairBytes + (pairIndex * 6);
+                glyphPairs.push_back(std::make_pair(ReadUint16(pair), ReadUint16(pair + 2)));
+            }
+        }
+        bytes = subtableEnd;
+    }
+
+    // a pair can be in more than one subtable, and FT_Get_Kerning(...) adds them all up
+    std::sort(glyphPairs.begin(), glyphPairs.end());
+    glyphPairs.erase(std::unique(glyphPairs.begin(), glyphPairs.end()), glyphPairs.end());
+    return true;
+}
+
+void ExtractKerning(const FT_Face face, const int fontPixelHeightSize,
+    const std::vector<unsigned int> &codePoints, std::vector<AtlasKerningPair> &pairs)
+{
+    if (!FT_HAS_KERNING(face))
+    {
+        return;
+    }
+    FT_Set_Pixel_Sizes(face, 0, fontPixelHeightSize);
+
+    // kerning is between glyphs, not characters, so find each one's glyph once, and keep
+    // every code point that shares it
+    // Note: Glyph 0 is the "missing glyph" glyph, which has no kerning.
+    std::unordered_multimap<FT_UInt, unsigned int> codePointsByGlyph;
+    std::vector<FT_UInt> glyphs;
+    codePointsByGlyph.reserve(codePoints.size());
+    for (size_t codePointIndex = 0; codePointIndex < codePoints.size(); codePointIndex++)
+    {
+        FT_UInt glyph = FT_Get_Char_Index(face, codePoints[codePointIndex]);
+        if (glyph != 0)
+        {
+            codePointsByGlyph.insert(std::make_pair(glyph, codePoints[codePointIndex]));
+            glyphs.push_back(glyph);
+        }
+    }
+    std::sort(glyphs.begin(), glyphs.end());
+    glyphs.erase(std::unique(glyphs.begin(), glyphs.end()), glyphs.end());
+
+    // Note: FT_KERNING_DEFAULT rounds to whole pixels, like the advances (see
+    // RasterizeGlyphs(...)), and it comes back in 26.6 fixed point (1/64 pixels).
+    size_t firstNewPair = pairs.size();
+    auto addGlyphPair = [&](const FT_UInt leftGlyph, const FT_UInt rightGlyph)
+    {
+        auto lefts = codePointsByGlyph.equal_range(leftGlyph);
+        auto rights = codePointsByGlyph.equal_range(rightGlyph);
+        FT_Vector kerning;
+        if (lefts.first == lefts.second || rights.first == rights.second ||
+            FT_Get_Kerning(face, leftGlyph, rightGlyph, FT_KERNING_DEFAULT, &kerning) != 0 ||
+            kerning.x == 0)
+        {
+            return;
+        }
+        for (auto left = lefts.first; left != lefts.second; ++left)
+        {
+            for (auto right = rights.first; right != rights.second; ++right)
+            {
+                AtlasKerningPair pair = { left->second, right->second,
+                    (float)kerning.x / 64.0f };
+                pairs.push_back(pair);
+            }
+        }
+    };
+
+    // Asking FreeType about every pair is quadratic, which is tens of millions of calls for a
+    // few thousand CJK glyphs, so the pairs come from the 'kern' table itself, and FreeType is
+    // only asked for the values of the ones that are in the set.
+    std::vector<std::pair<FT_UInt, FT_UInt> > glyphPairs;
+    if (ReadKernTablePairs(face, glyphPairs))
+    {
+        for (size_t pairIndex = 0; pairIndex < glyphPairs.size(); pairIndex++)
+        {
+            addGlyphPair(glyphPairs[pairIndex].first, glyphPairs[pairIndex].second);
+        }
+    }
+    else
+    {
+        // not a TrueType or OpenType font (a Type 1 font with an AFM file, for one), so there
+        // is no table to read, and every pair of distinct glyphs has to be asked about
+        for (size_t leftIndex = 0; leftIndex < glyphs.size(); leftIndex++)
+        {
+            for (size_t rightIndex = 0; rightIndex < glyphs.size(); rightIndex++)
+            {
+                addGlyphPair(glyphs[leftIndex], glyphs[rightIndex]);
+            }
+        }
+    }
+
+    // the same order no matter which way the pairs were found, so that the same font always
+    // makes the same atlas file
+    std::sort(pairs.begin() + firstNewPair, pairs.end(),
+        [](const AtlasKerningPair &a, const AtlasKerningPair &b)
+        {
+            return (a.left != b.left) ? (a.left < b.left) : (a.right < b.right);
+        });
+}
+#endif
@@ -0,0 +1,76 @@
+#pragma once
+
+// there doesn't seem to be any way out of including all of FreeType without some shady forward
+// declarations of FreeType internal structures
+#include <ft2build.h>
+#include FT_FREETYPE_H  // also defined relative to "freetype-2.6.1/include/"
+
+// for the arena that the glyphs are rasterized into
+#include "GlyphArena.h"
+
+// for turning glyphs into distance fields
+#include "DistanceField.h"
+
+// for the kerning pairs that go with an atlas
+#include "AtlasImage.h"
+
+#include <vector>
+
+// the visible characters of the basic ASCII set (32 - 127)
+std::vector<unsigned int> AsciiCodePoints();
+
+// every code point from first to last, inclusive (ex: 0x0400 - 0x04FF for Cyrillic)
+std::vector<unsigned int> CodePointRange(const unsigned int first, const unsigned int last);
+
+// sets the face's pixel size, renders each requested code point once with FT_LOAD_RENDER, and
+// appends the results to the arena in the same order as the code points were provided
+// Note: Glyphs that fail to load are reported and skipped.
+void RasterizeGlyphs(const FT_Face face, const int fontPixelHeightSize,
+    const std::vector<unsigned int> &codePoints, GlyphArena &arena);
+
+// same as RasterizeGlyphs(...), but the code points are split into ranges that are handed out 
+// to a pool of worker threads
+// Note: Neither FT_Library nor FT_Face is thread-safe, so each worker opens its own library 
+// and its own face over the same in-memory font file.  The font bytes are only read, so they 
+// can be shared.
+// Also Note: The ranges are stitched back together in their original order, so the arena is 
+// byte-for-byte the same as what the single-threaded version makes, no matter how the threads 
+// were scheduled.  The atlas layout is therefore deterministic too.
+// Also Also Note: A thread count of 0 means "one per hardware thread".
+// returns: false if a worker could not open the font, otherwise true
+bool RasterizeGlyphsParallel(const unsigned char *fontFileBytes, const size_t fontFileSize,
+    const int fontPixelHeightSize, const std::vector<unsigned int> &codePoints,
+    const unsigned int threadCount, GlyphArena &arena);
+
+// same as RasterizeGlyphsParallel(...), but the glyphs are rasterized at "supersample" times 
+// the size and then turned into distance fields of the requested size (see DistanceField.h)
+// Note: FreeType 2.6.1 can't render distance fields from the outlines itself, so the field 
+// comes from a bigger bitmap instead.  The distance transform is exact, so the only error is 
+// the supersampled bitmap's, which is a fraction of an atlas pixel.
+// Also Note: The distance fields are always made on worker threads because the transform is 
+// much more work than the rasterizing.
+// returns: false if a worker could not open the font, otherwise true
+bool RasterizeDistanceFieldsParallel(const unsigned char *fontFileBytes, 
+    const size_t fontFileSize, const int fontPixelHeightSize, 
+    const std::vector<unsigned int> &codePoints, const DistanceFieldSettings &settings, 
+    const unsigned int threadCount, GlyphArena &arena);
+
+// works out how big a cell in the glyph cache (see GlyphCache.h) needs to be to hold any glyph 
+// in the face at the given size, including the 1-pixel gutter
+// Note: This sets the face's pixel size.
+void GlyphCellSize(const FT_Face face, const int fontPixelHeightSize, unsigned int &cellWidth, 
+    unsigned int &cellHeight);
+
+// looks up the kerning between every pair of the code points at the given size and appends
+// the pairs that move the pen to the list
+// Note: This sets the face's pixel size.  A face without a kerning table has no pairs, and
+// nothing is looked up.
+// Also Note: The pairs come from the font's 'kern' table, and FreeType is only asked for the
+// values of the ones that are in the set, so a big set with little kerning costs little.  A
+// font that isn't TrueType or OpenType has no table to read, and then every pair is asked
+// about, which is quadratic.  Either way it only happens when an atlas is built, and the
+// pairs are saved with it (see AtlasFile.h).  Drawing never calls FreeType for kerning (see
+// KerningTable.h).
+// Also Also Note: The pairs are sorted by the left code point and then the right one.
+void ExtractKerning(const FT_Face face, const int fontPixelHeightSize,
+    const std::vector<unsigned int> &codePoints, std::vector<AtlasKerningPair> &pairs);
@@ -0,0 +1,68 @@
+#include "KerningTable.h"
+
+#include <algorithm>    // for std::min
+
+// both of a pair's code points must be below this to go in the dense grid
+static const unsigned int AsciiCount = 128;
+
+// the hash map's key for a pair
+static unsigned long long PairKey(const unsigned int left, const unsigned int right)
+{
+    return ((unsigned long long)left << 32) | right;
+}
+
+KerningTable::KerningTable() :
+    _mostNegative(0.0f)
+{
+}
+
+void KerningTable::Init(const AtlasKerningPair *pairs, const size_t pairCount)
+{
+    _asciiPairs.clear();
+    _pairs.clear();
+    _mostNegative = 0.0f;
+    for (size_t pairIndex = 0; pairIndex < pairCount; pairIndex++)
+    {
+        const AtlasKerningPair &pair = pairs[pairIndex];
+        _mostNegative = std::min(_mostNegative, pair.x);
+        if (pair.left < AsciiCount && pair.right < AsciiCount)
+        {
+            // the grid is 64KB, so it is only made for fonts that kern ASCII at all
+            if (_asciiPairs.empty())
+            {
+                _asciiPairs.assign(AsciiCount * AsciiCount, 0.0f);
+            }
+            _asciiPairs[(pair.left * AsciiCount) + pair.right] = pair.x;
+        }
+        else
+        {
+            _pairs[PairKey(pair.left, pair.right)] = pair.x;
+        }
+    }
+}
+
+float KerningTable::Find(const unsigned int left, const unsigned int right) const
+{
+    if (left < AsciiCount && right < AsciiCount)
+    {
+        return _asciiPairs.empty() ? 0.0f : _asciiPairs[(left * AsciiCount) + right];
+    }
+    if (_pairs.empty())
+    {
+        return 0.0f;
+    }
+
+    std::unordered_map<unsigned long long, float>::const_iterator found =
+        _pairs.find(PairKey(left, right));
+    return (found == _pairs.end()) ? 0.0f : found->second;
+}
+
+bool KerningTable::IsEmpty() const
+{
+    return _asciiPairs.empty() && _pairs.empty();
+}
+
+float KerningTable::MostNegative() const
+{
+    return _mostNegative;
+}
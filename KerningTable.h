@@ -0,0 +1,44 @@
+#pragma once
+
+// for the pairs that the table is made from
+#include "AtlasImage.h"
+
+#include <unordered_map>
+#include <vector>
+
+// the kerning pairs of an atlas (see AtlasKerningPair), arranged so that the layout loops can
+// look one up per glyph without calling FreeType
+// Note: Most text is ASCII, so pairs of ASCII characters go in a dense 128 x 128 grid that is
+// looked up by index, like FreeTypeAtlas' ASCII glyphs.  Every other pair goes in a hash map
+// keyed by both code points.  A font without kerning costs one check per glyph.
+// Also Note: Like GlyphCache, this knows nothing about OpenGL or FreeType.
+class KerningTable
+{
+public:
+    KerningTable();
+
+    // forgets every pair and starts over with these
+    void Init(const AtlasKerningPair *pairs, const size_t pairCount);
+
+    // returns: how far the pen moves between the two glyphs, on top of the left one's advance,
+    // in unscaled pixels, or 0 if the pair isn't kerned
+    float Find(const unsigned int left, const unsigned int right) const;
+
+    // returns: true if there are no pairs at all
+    bool IsEmpty() const;
+
+    // returns: the most that any pair pulls the pen back to the left, as a negative number,
+    // or 0 if none of them do
+    // Note: The atlas widens its glyph extents by this so that the rest of a string isn't
+    // skipped too early (see FreeTypeAtlas::PastCullRect(...)).
+    float MostNegative() const;
+
+private:
+    // 128 x 128, left code point major, or empty if no pair is all ASCII
+    std::vector<float> _asciiPairs;
+
+    // keyed by the left code point in the high 32 bits and the right one in the low 32
+    std::unordered_map<unsigned long long, float> _pairs;
+
+    float _mostNegative;
+};
@@ -0,0 +1,156 @@
+#include "LineIndex.h"
+
+#include <string.h>     // for memchr(...)
+
+#include <algorithm>    // for std::min, std::max
+#include <atomic>       // for handing out chunks to the worker threads
+#include <thread>
+
+// Note: MSVC doesn't define __SSE2__, so check its own macros too (see Bc4Encoder.cpp).
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LINE_INDEX_USE_SSE2
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>     // for _BitScanForward(...)
+#endif
+#endif
+
+// a chunk is only worth a thread of its own if it is at least this big (a thread costs about
+// as much to start as it takes to scan this many bytes)
+static const size_t MinBytesPerChunk = 1 << 20;
+
+#ifdef LINE_INDEX_USE_SSE2
+// returns: the index of the lowest bit that is set
+// Note: The mask must not be 0.
+static unsigned int LowestSetBit(const unsigned int mask)
+{
+#ifdef _MSC_VER
+    unsigned long index = 0;
+    _BitScanForward(&index, mask);
+    return (unsigned int)index;
+#else
+    return (unsigned int)__builtin_ctz(mask);
+#endif
+}
+#endif
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Appends the offset of the byte after every '\n' in [begin, end) to the list.
+Parameters:
+    data        The whole text.
+    begin       The first byte of the chunk.
+    end         One past the chunk's last byte.
+    lineStarts  What the offsets are appended to.
+Returns:    None
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static void ScanChunk(const unsigned char *data, const size_t begin, const size_t end,
+    std::vector<size_t> &lineStarts)
+{
+    size_t offset = begin;
+#ifdef LINE_INDEX_USE_SSE2
+    // 16 bytes become 16 bits, one per byte that is a '\n', and most chunks of a log have
+    // none or one, so the loop over the bits is short
+    // Note: The loads are unaligned because a mapped file's chunks start wherever they start.
+    const __m128i newlines = _mm_set1_epi8('\n');
+    for (; offset + 16 <= end; offset += 16)
+    {
+        __m128i bytes = _mm_loadu_si128((const __m128i *)(data + offset));
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, newlines));
+        while (mask != 0)
+        {
+            lineStarts.push_back(offset + LowestSetBit(mask) + 1);
+
+            // clear the lowest bit
+            mask &= mask - 1;
+        }
+    }
+#endif
+
+    // whatever is left over, or all of it without SSE2
+    // Note: memchr(...) is usually vectorized by the C library anyway.
+    while (offset < end)
+    {
+        const void *found = memchr(data + offset, '\n', end - offset);
+        if (found == 0)
+        {
+            break;
+        }
+        offset = ((const unsigned char *)found - data) + 1;
+        lineStarts.push_back(offset);
+    }
+}
+
+void BuildLineIndex(const unsigned char *data, const size_t size,
+    const unsigned int threadCount, std::vector<size_t> &lineStarts)
+{
+    lineStarts.clear();
+    if (data == 0 || size == 0)
+    {
+        return;
+    }
+
+    unsigned int workerCount = threadCount;
+    if (workerCount == 0)
+    {
+        // hardware_concurrency() is allowed to return 0 if it can't tell
+        workerCount = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    size_t chunkCount = std::max(std::min((size_t)workerCount, size / MinBytesPerChunk),
+        (size_t)1);
+    size_t bytesPerChunk = (size + chunkCount - 1) / chunkCount;
+
+    // each chunk's line starts go in a list of their own so that the workers never share one
+    std::vector<std::vector<size_t> > chunkLineStarts(chunkCount);
+    std::atomic<size_t> nextChunk(0);
+    auto worker = [&]()
+    {
+        for (size_t chunk = nextChunk++; chunk < chunkCount; chunk = nextChunk++)
+        {
+            size_t begin = chunk * bytesPerChunk;
+            size_t end = std::min(begin + bytesPerChunk, size);
+            ScanChunk(data, begin, end, chunkLineStarts[chunk]);
+        }
+    };
+
+    if (chunkCount <= 1)
+    {
+        // a small file doesn't need a thread
+        worker();
+    }
+    else
+    {
+        std::vector<std::thread> workers;
+        workers.reserve(chunkCount);
+        for (size_t workerIndex = 0; workerIndex < chunkCount; workerIndex++)
+        {
+            workers.push_back(std::thread(worker));
+        }
+        for (size_t workerIndex = 0; workerIndex < workers.size(); workerIndex++)
+        {
+            workers[workerIndex].join();
+        }
+    }
+
+    // the chunks are in file order, so putting them one after the other puts every line in
+    // order
+    size_t lineCount = 1;
+    for (size_t chunk = 0; chunk < chunkCount; chunk++)
+    {
+        lineCount += chunkLineStarts[chunk].size();
+    }
+    lineStarts.reserve(lineCount);
+    lineStarts.push_back(0);
+    for (size_t chunk = 0; chunk < chunkCount; chunk++)
+    {
+        lineStarts.insert(lineStarts.end(), chunkLineStarts[chunk].begin(),
+            chunkLineStarts[chunk].end());
+    }
+
+    // a '\n' at the very end ends the last line instead of starting an empty one
+    if (lineStarts.size() > 1 && lineStarts.back() == size)
+    {
+        lineStarts.pop_back();
+    }
+}
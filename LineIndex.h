@@ -0,0 +1,22 @@
+#pragma once
+
+#include <stddef.h>     // for size_t
+
+#include <vector>
+
+// finds where every line of a block of text starts, so that any line can be found without
+// reading everything before it (see TextFileView.h)
+// lineStarts: cleared, and then the offset of the first byte of every line, in order
+// Note: The first line starts at 0, and every '\n' starts another one after it, except for a
+// '\n' that is the very last byte, since a file that ends with one doesn't have an empty line
+// after it.  A line ends where the next one starts, minus the '\n'.  A '\r' before it is left
+// in the line (see TextFileView.cpp).
+// Also Note: This touches every byte, so it is the one thing about a huge file that costs in
+// proportion to its size.  The bytes are checked 16 at a time with SSE2 (one compare and one
+// mask per 16, and only the bits that are set are looked at), and the text is split into
+// chunks that worker threads scan at the same time.  Each chunk's lines are kept on their own
+// and put together in order afterwards, so the index is the same no matter how the threads
+// were scheduled.
+// Also Also Note: A thread count of 0 means "one per hardware thread".
+void BuildLineIndex(const unsigned char *data, const size_t size,
+    const unsigned int threadCount, std::vector<size_t> &lineStarts);
@@ -0,0 +1,136 @@
+#include "MappedFile.h"
+
+#include <stdio.h>      // for fprintf(...)
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <fcntl.h>      // for open(...)
+#include <sys/mman.h>   // for mmap(...)
+#include <sys/stat.h>   // for fstat(...)
+#include <unistd.h>     // for close(...)
+#endif
+
+MappedFile::MappedFile() :
+    _data(0),
+    _size(0)
+#ifdef _WIN32
+    ,
+    _fileHandle(INVALID_HANDLE_VALUE),
+    _mappingHandle(0)
+#endif
+{
+}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+bool MappedFile::Open(const std::string &filePath)
+{
+    Close();
+
+#ifdef _WIN32
+    _fileHandle = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, 
+        FILE_ATTRIBUTE_NORMAL, 0);
+    if (_fileHandle == INVALID_HANDLE_VALUE)
+    {
+        // a missing file is not unusual (ex: a cache file that hasn't been made yet), so let 
+        // the caller decide whether to complain
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(_fileHandle, &fileSize) || fileSize.QuadPart == 0)
+    {
+        Close();
+        return false;
+    }
+
+    _mappingHandle = CreateFileMappingA(_fileHandle, 0, PAGE_READONLY, 0, 0, 0);
+    if (_mappingHandle == 0)
+    {
+        fprintf(stderr, "Could not map file '%s'\n", filePath.c_str());
+        Close();
+        return false;
+    }
+
+    _data = (const unsigned char *)MapViewOfFile(_mappingHandle, FILE_MAP_READ, 0, 0, 0);
+    if (_data == 0)
+    {
+        fprintf(stderr, "Could not map view of file '%s'\n", filePath.c_str());
+        Close();
+        return false;
+    }
+    _size = (size_t)fileSize.QuadPart;
+#else
+    int fileDescriptor = open(filePath.c_str(), O_RDONLY);
+    if (fileDescriptor == -1)
+    {
+        return false;
+    }
+
+    struct stat fileStats;
+    if (fstat(fileDescriptor, &fileStats) != 0 || fileStats.st_size == 0)
+    {
+        close(fileDescriptor);
+        return false;
+    }
+
+    // Note: The mapping keeps its own reference to the file, so the descriptor can be closed 
+    // right away.
+    void *mapping = mmap(0, (size_t)fileStats.st_size, PROT_READ, MAP_PRIVATE, fileDescriptor, 
+        0);
+    close(fileDescriptor);
+    if (mapping == MAP_FAILED)
+    {
+        fprintf(stderr, "Could not map file '%s'\n", filePath.c_str());
+        return false;
+    }
+
+    _data = (const unsigned char *)mapping;
+    _size = (size_t)fileStats.st_size;
+#endif
+
+    return true;
+}
+
+void MappedFile::Close()
+{
+#ifdef _WIN32
+    if (_data != 0)
+    {
+        UnmapViewOfFile(_data);
+    }
+    if (_mappingHandle != 0)
+    {
+        CloseHandle(_mappingHandle);
+        _mappingHandle = 0;
+    }
+    if (_fileHandle != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(_fileHandle);
+        _fileHandle = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (_data != 0)
+    {
+        munmap((void *)_data, _size);
+    }
+#endif
+
+    _data = 0;
+    _size = 0;
+}
+
+const unsigned char *MappedFile::Data() const
+{
+    return _data;
+}
+
+size_t MappedFile::Size() const
+{
+    return _size;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <string>
+
+// a read-only view of a whole file that the OS pages in on demand
+// Note: Nothing is copied when the file is opened, so opening a large file costs about the same 
+// as opening a small one, and only the parts that are actually touched are ever read from the 
+// disk.  The data is only valid until Close() is called or the object goes away.
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    // takes: file path relative to the working directory
+    // returns: true if the file was mapped, otherwise false
+    // Note: An empty file can't be mapped, so it is reported as a failure.
+    bool Open(const std::string &filePath);
+
+    // unmaps the file; safe to call when nothing is open
+    void Close();
+
+    // returns: the file's bytes, or null if nothing is open
+    const unsigned char *Data() const;
+
+    // returns: the file's size in bytes, or 0 if nothing is open
+    size_t Size() const;
+
+private:
+    // the mapping can't be shared, so don't let it be copied
+    MappedFile(const MappedFile &);
+    MappedFile &operator=(const MappedFile &);
+
+    const unsigned char *_data;
+    size_t _size;
+
+#ifdef _WIN32
+    // actually HANDLEs, but I don't want to include Windows.h in a header file
+    void *_fileHandle;
+    void *_mappingHandle;
+#endif
+};
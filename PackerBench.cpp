@@ -0,0 +1,228 @@
+// PackerBench: a command-line tool that packs a real font's glyphs with each of the packers
+// (see GlyphPacker.h) and prints how big the atlas came out, how much of it the glyphs cover,
+// how many bytes are wasted, and how long the packing took, so that the packers can be
+// compared on something other than made-up rectangles.
+//
+// usage: PackerBench [font file] [pixel sizes]
+//  - font file: default FreeSans.ttf
+//  - pixel sizes: comma separated (default 16,24,48,96)
+//
+// Each size is packed twice, once with ASCII and once with a bigger set (Latin-1, Latin
+// Extended-A and B, Greek, and Cyrillic), and both with and without power-of-two dimensions.
+// The glyphs are padded by 1 pixel like AtlasBuilder pads them by default.
+// Note: Every packing is also checked: every rectangle has to be inside the atlas and none of
+// them may overlap.  The exit code is 1 if any packing failed or was wrong, so this doubles
+// as a test.
+//
+// Build note: This is its own project (packer_bench.vcxproj) because it has its own main(...),
+// like AtlasBaker.cpp.  It only needs FreeType, not OpenGL or freeglut.
+
+#include "GlyphRasterizer.h"
+#include "GlyphPacker.h"
+
+#include <stdio.h>
+#include <stdlib.h>     // for strtoul(...)
+
+#include <chrono>       // for timing the packers
+#include <string>
+#include <vector>
+
+// apparently the FreeType lib also needs a companion file, "freetype261d.pdb"
+#pragma comment (lib, "freetype-2.6.1/objs/vc2010/Win32/freetype261d.lib")
+
+// the same as AtlasBaker's default
+static const unsigned int MaxTextureSize = 16384;
+
+// the gutter between glyphs (see AtlasBuilder::SetPadding(...))
+static const unsigned int Padding = 1;
+
+// each packing is run this many times and the fastest is reported, so that one slow run (a
+// page fault, another process) doesn't decide the comparison
+static const int TimedRuns = 5;
+
+static const char *PackingMethodName(const PackingMethod method)
+{
+    switch (method)
+    {
+    case PackingMethod::Shelf:
+        return "Shelf";
+    case PackingMethod::MaxRects:
+        return "MaxRects";
+    default:
+        return "Skyline";
+    }
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Checks that every rectangle is inside the atlas and that no two of them overlap.
+Parameters:
+    rects   What PackRects(...) placed.
+    report  What PackRects(...) said the atlas size is.
+Returns:
+    True if the packing is good, otherwise false.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static bool CheckPacking(const std::vector<PackRect> &rects, const PackReport &report)
+{
+    for (size_t rectIndex = 0; rectIndex < rects.size(); rectIndex++)
+    {
+        const PackRect &rect = rects[rectIndex];
+        if (rect.x + rect.width > report.atlasWidth || rect.y + rect.height > report.atlasHeight)
+        {
+            fprintf(stderr, "    rectangle %u is outside of the atlas\n", (unsigned int)rectIndex);
+            return false;
+        }
+
+        // Note: This is quadratic, but even the bigger set is only a thousand or so glyphs.
+        for (size_t otherIndex = rectIndex + 1; otherIndex < rects.size(); otherIndex++)
+        {
+            const PackRect &other = rects[otherIndex];
+            bool apart = rect.x + rect.width <= other.x || other.x + other.width <= rect.x ||
+                rect.y + rect.height <= other.y || other.y + other.height <= rect.y;
+            if (!apart)
+            {
+                fprintf(stderr, "    rectangles %u and %u overlap\n", (unsigned int)rectIndex,
+                    (unsigned int)otherIndex);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Rasterizes the code points at the given size and packs their bitmaps with every packer,
+    with and without power-of-two dimensions, printing one line per packing.
+Parameters:
+    face            The font.
+    fontSize        In pixels.
+    setName         What to call the code points in the output.
+    codePoints      What to rasterize.
+Returns:
+    True if every packing fit and was checked, otherwise false.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static bool BenchSet(const FT_Face face, const int fontSize, const char *setName,
+    const std::vector<unsigned int> &codePoints)
+{
+    GlyphArena arena;
+    RasterizeGlyphs(face, fontSize, codePoints, arena);
+
+    // the same rectangles that AtlasBuilder would pack, minus the glyphs that it would share
+    // (see AtlasBuilder::Pack(...)), which only makes every packer's job a little smaller
+    std::vector<PackRect> glyphRects(arena.glyphs.size());
+    for (size_t glyphIndex = 0; glyphIndex < arena.glyphs.size(); glyphIndex++)
+    {
+        glyphRects[glyphIndex].width = arena.glyphs[glyphIndex].width + Padding;
+        glyphRects[glyphIndex].height = arena.glyphs[glyphIndex].rows + Padding;
+        glyphRects[glyphIndex].x = 0;
+        glyphRects[glyphIndex].y = 0;
+    }
+
+    const PackingMethod methods[] =
+        { PackingMethod::Shelf, PackingMethod::Skyline, PackingMethod::MaxRects };
+    bool allGood = true;
+    for (int powerOfTwo = 0; powerOfTwo < 2; powerOfTwo++)
+    {
+        for (size_t methodIndex = 0; methodIndex < sizeof(methods) / sizeof(methods[0]);
+            methodIndex++)
+        {
+            std::vector<PackRect> rects;
+            PackReport report;
+            bool fits = false;
+            double fastestMs = 0.0;
+            for (int run = 0; run < TimedRuns; run++)
+            {
+                // the packer writes the positions into the rectangles, so start over each time
+                rects = glyphRects;
+                auto start = std::chrono::steady_clock::now();
+                fits = PackRects(methods[methodIndex], powerOfTwo != 0, MaxTextureSize, rects,
+                    report);
+                std::chrono::duration<double, std::milli> elapsed =
+                    std::chrono::steady_clock::now() - start;
+                if (run == 0 || elapsed.count() < fastestMs)
+                {
+                    fastestMs = elapsed.count();
+                }
+            }
+
+            printf("%-6s %4dpx %5u glyphs  %-8s %-5s ", setName, fontSize,
+                (unsigned int)rects.size(), PackingMethodName(methods[methodIndex]),
+                powerOfTwo ? "pow2" : "any");
+            if (!fits)
+            {
+                printf("does not fit in %u x %u\n", MaxTextureSize, MaxTextureSize);
+                allGood = false;
+                continue;
+            }
+            printf("%5u x %-5u  %5.1f%% occupied  %9llu bytes wasted  %8.3f ms\n",
+                report.atlasWidth, report.atlasHeight, report.occupancy * 100.0f,
+                (unsigned long long)report.wastedBytes, fastestMs);
+            if (!CheckPacking(rects, report))
+            {
+                allGood = false;
+            }
+        }
+    }
+    return allGood;
+}
+
+int main(int argc, char *argv[])
+{
+    std::string fontFilePath = (argc > 1) ? argv[1] : "FreeSans.ttf";
+    std::string sizeList = (argc > 2) ? argv[2] : "16,24,48,96";
+
+    std::vector<int> fontSizes;
+    size_t start = 0;
+    while (start < sizeList.length())
+    {
+        size_t end = sizeList.find(',', start);
+        if (end == std::string::npos)
+        {
+            end = sizeList.length();
+        }
+        int size = (int)strtoul(sizeList.substr(start, end - start).c_str(), 0, 10);
+        if (size <= 0)
+        {
+            fprintf(stderr, "Bad pixel size list '%s'\n", sizeList.c_str());
+            return 1;
+        }
+        fontSizes.push_back(size);
+        start = end + 1;
+    }
+
+    FT_Library library;
+    FT_Face face;
+    if (FT_Init_FreeType(&library))
+    {
+        fprintf(stderr, "Could not init freetype library\n");
+        return 1;
+    }
+    if (FT_New_Face(library, fontFilePath.c_str(), 0, &face))
+    {
+        fprintf(stderr, "Could not open font '%s'\n", fontFilePath.c_str());
+        FT_Done_FreeType(library);
+        return 1;
+    }
+
+    std::vector<unsigned int> ascii = AsciiCodePoints();
+    std::vector<unsigned int> bigSet = CodePointRange(32, 0x24F);
+    std::vector<unsigned int> greek = CodePointRange(0x370, 0x3FF);
+    std::vector<unsigned int> cyrillic = CodePointRange(0x400, 0x4FF);
+    bigSet.insert(bigSet.end(), greek.begin(), greek.end());
+    bigSet.insert(bigSet.end(), cyrillic.begin(), cyrillic.end());
+
+    bool allGood = true;
+    for (size_t sizeIndex = 0; sizeIndex < fontSizes.size(); sizeIndex++)
+    {
+        // Note: Don't stop at the first failure so that every line is printed.
+        allGood = BenchSet(face, fontSizes[sizeIndex], "ASCII", ascii) && allGood;
+        allGood = BenchSet(face, fontSizes[sizeIndex], "Big", bigSet) && allGood;
+    }
+
+    FT_Done_Face(face);
+    FT_Done_FreeType(library);
+    return allGood ? 0 : 1;
+}
@@ -0,0 +1,69 @@
+#include "QuadIndexBuffer.h"
+
+// for the index pattern
+#include "GlyphQuads.h"
+
+// the OpenGL version include also includes all previous versions
+// Build note: Do NOT mistakenly include _int_gl_4_4.h.  That one doesn't define OpenGL stuff
+// first.
+#include "glload/include/glload/gl_4_4.h"
+
+#include <algorithm>    // for std::min
+#include <vector>
+
+std::shared_ptr<QuadIndexBuffer> QuadIndexBuffer::Shared()
+{
+    // Note: Only a weak pointer is kept here so that the buffer goes away with the last atlas
+    // instead of outliving the OpenGL context.
+    static std::weak_ptr<QuadIndexBuffer> sharedBuffer;
+    std::shared_ptr<QuadIndexBuffer> buffer = sharedBuffer.lock();
+    if (buffer == nullptr)
+    {
+        buffer.reset(new QuadIndexBuffer());
+        sharedBuffer = buffer;
+    }
+    return buffer;
+}
+
+QuadIndexBuffer::QuadIndexBuffer() :
+    _iboId(0)
+{
+    std::vector<unsigned short> indices;
+    MakeQuadIndices(MaxQuadsPerDraw, indices);
+
+    // Note: The element buffer binding belongs to whatever vertex array is bound, so the
+    // indices go up through a binding point that doesn't.
+    glGenBuffers(1, &_iboId);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, _iboId);
+    glBufferData(GL_COPY_WRITE_BUFFER, indices.size() * sizeof(unsigned short),
+        indices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+QuadIndexBuffer::~QuadIndexBuffer()
+{
+    glDeleteBuffers(1, &_iboId);
+}
+
+unsigned int QuadIndexBuffer::BufferId() const
+{
+    return _iboId;
+}
+
+void QuadIndexBuffer::DrawQuads(const size_t firstVertex, const size_t quadCount) const
+{
+    for (size_t quadsDrawn = 0; quadsDrawn < quadCount; quadsDrawn += MaxQuadsPerDraw)
+    {
+        size_t pieceQuads = std::min(quadCount - quadsDrawn, (size_t)MaxQuadsPerDraw);
+        GLint baseVertex = (GLint)(firstVertex + (quadsDrawn * VerticesPerQuad));
+        glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)(pieceQuads * IndicesPerQuad),
+            GL_UNSIGNED_SHORT, 0, baseVertex);
+    }
+}
+
+void QuadIndexBuffer::DrawQuadInstances(const size_t firstInstance,
+    const size_t instanceCount) const
+{
+    glDrawElementsInstancedBaseInstance(GL_TRIANGLES, IndicesPerQuad, GL_UNSIGNED_SHORT, 0,
+        (GLsizei)instanceCount, (GLuint)firstInstance);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <stddef.h>     // for size_t
+
+#include <memory>       // for the shared pointer
+
+// the one GL_ELEMENT_ARRAY_BUFFER that every atlas draws its glyph quads with
+// Note: The indices for N quads are the same no matter what the quads are (see GlyphQuads.h),
+// so they are made once, sized for the most quads that 16-bit indices can reach, and never
+// touched again.  Each glyph then only uploads its 4 vertices instead of 6, and there are no
+// stray triangles between glyphs like there are when a whole string is one triangle strip.
+class QuadIndexBuffer
+{
+public:
+    // the buffer that all atlases share; it is made on the first call and deleted when its
+    // last user lets go of it
+    // Note: There must be an OpenGL context.
+    static std::shared_ptr<QuadIndexBuffer> Shared();
+
+    ~QuadIndexBuffer();
+
+    // the most quads that one glDrawElements(...) can cover
+    static const unsigned int MaxQuadsPerDraw = 16384;
+
+    // actually a GLuint (see FreeTypeAtlas.h)
+    // Note: The element buffer binding belongs to the vertex array object, so each vertex
+    // array that draws quads binds this once when it is set up, and the draws below don't
+    // bind anything.
+    unsigned int BufferId() const;
+
+    // draws quadCount quads whose vertices start at firstVertex in whatever vertex array is
+    // bound
+    // Note: More than MaxQuadsPerDraw quads are drawn in pieces, each one moved to its own
+    // vertices with a base vertex (glDrawElementsBaseVertex(...) is OpenGL 3.2).
+    void DrawQuads(const size_t firstVertex, const size_t quadCount) const;
+
+    // draws one quad per instance with the first quad's indices (0 through 3), starting at
+    // the given instance in the instance attributes
+    // Note: The instanced path has no per-vertex data at all; the vertex shader picks the
+    // corner from gl_VertexID and everything else comes from the instance (see
+    // shader_instanced.vert).
+    // Also Note: The base instance (glDrawElementsInstancedBaseInstance(...) is OpenGL 4.2)
+    // lets the instance attributes stay pointed at the start of the buffer.
+    void DrawQuadInstances(const size_t firstInstance, const size_t instanceCount) const;
+
+private:
+    // use Shared()
+    QuadIndexBuffer();
+    QuadIndexBuffer(const QuadIndexBuffer &) = delete;
+    QuadIndexBuffer &operator=(const QuadIndexBuffer &) = delete;
+
+    // actually a GLuint (see FreeTypeAtlas.h)
+    unsigned int _iboId;
+};
@@ -0,0 +1,209 @@
+#include "StreamBuffer.h"
+
+// the OpenGL version include also includes all previous versions
+// Build note: Do NOT mistakenly include _int_gl_4_4.h.  That one doesn't define OpenGL stuff
+// first.
+#include "glload/include/glload/gl_4_4.h"
+
+#include <stdio.h>      // for fprintf(...)
+
+// how long to wait on a fence before asking again, in nanoseconds
+static const GLuint64 FenceWaitTimeout = 1000000;
+
+// write-only, and it stays mapped while the GPU reads from it
+static const GLbitfield StreamBufferFlags =
+    GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+std::shared_ptr<StreamBuffer> StreamBuffer::Shared()
+{
+    // see QuadIndexBuffer::Shared()
+    static std::weak_ptr<StreamBuffer> sharedBuffer;
+    std::shared_ptr<StreamBuffer> buffer = sharedBuffer.lock();
+    if (buffer == nullptr)
+    {
+        buffer.reset(new StreamBuffer());
+        sharedBuffer = buffer;
+    }
+    return buffer;
+}
+
+StreamBuffer::StreamBuffer() :
+    _bufferId(0),
+    _generation(0),
+    _mapped(0),
+    _capacity(0),
+    _head(0),
+    _reservedOffset(0),
+    _fencedHead(0)
+{
+    Allocate(InitialCapacity);
+}
+
+StreamBuffer::~StreamBuffer()
+{
+    for (size_t fenceIndex = 0; fenceIndex < _fences.size(); fenceIndex++)
+    {
+        glDeleteSync((GLsync)_fences[fenceIndex].sync);
+    }
+
+    // Note: Deleting a mapped buffer unmaps it.
+    glDeleteBuffers(1, &_bufferId);
+}
+
+bool StreamBuffer::Allocate(const size_t capacity)
+{
+    // nothing in the old buffer matters to the new one
+    for (size_t fenceIndex = 0; fenceIndex < _fences.size(); fenceIndex++)
+    {
+        glDeleteSync((GLsync)_fences[fenceIndex].sync);
+    }
+    _fences.clear();
+    glDeleteBuffers(1, &_bufferId);
+    _bufferId = 0;
+    _mapped = 0;
+    _capacity = 0;
+    _head = 0;
+    _reservedOffset = 0;
+    _fencedHead = 0;
+
+    // Note: Unlike glBufferData(...), the storage can never be resized or reallocated, which
+    // is what lets it stay mapped.
+    glGenBuffers(1, &_bufferId);
+    _generation++;
+    glBindBuffer(GL_ARRAY_BUFFER, _bufferId);
+    glBufferStorage(GL_ARRAY_BUFFER, (GLsizeiptr)capacity, 0, StreamBufferFlags);
+    _mapped = (unsigned char *)glMapBufferRange(GL_ARRAY_BUFFER, 0, (GLsizeiptr)capacity,
+        StreamBufferFlags);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    if (_mapped == 0)
+    {
+        fprintf(stderr, "could not map a %u byte stream buffer\n", (unsigned int)capacity);
+        return false;
+    }
+
+    _capacity = capacity;
+    return true;
+}
+
+void *StreamBuffer::Reserve(const size_t bytes, const size_t stride, size_t &offset)
+{
+    // keep at least two reservations' worth of room so that one draw can be written while
+    // the GPU reads the last one
+    if (bytes > (_capacity / 2))
+    {
+        size_t newCapacity = (_capacity == 0) ? InitialCapacity : _capacity;
+        while (bytes > (newCapacity / 2))
+        {
+            newCapacity *= 2;
+        }
+        if (!Allocate(newCapacity))
+        {
+            return 0;
+        }
+    }
+
+    // every vertex in the reservation must line up with the start of the buffer so that
+    // the draw can start at a whole vertex, and if it doesn't fit before the end, then go
+    // back around to the start
+    // Note: The bytes that are skipped at the end are wasted until the next lap.
+    size_t begin = ((_head + stride - 1) / stride) * stride;
+    if (begin + bytes > _capacity)
+    {
+        begin = 0;
+    }
+
+    WaitForRange(begin, begin + bytes);
+    _reservedOffset = begin;
+    offset = begin;
+    return _mapped + begin;
+}
+
+void StreamBuffer::Commit(const size_t bytes)
+{
+    _head = _reservedOffset + bytes;
+}
+
+void StreamBuffer::Fence()
+{
+    if (_head == _fencedHead)
+    {
+        return;
+    }
+
+    FencedRange range;
+    range.begin = _fencedHead;
+    range.end = _head;
+    range.sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    _fences.push_back(range);
+    _fencedHead = _head;
+}
+
+unsigned int StreamBuffer::BufferId() const
+{
+    return _bufferId;
+}
+
+unsigned int StreamBuffer::Generation() const
+{
+    return _generation;
+}
+
+void StreamBuffer::RetireFinishedFences()
+{
+    // the GPU finishes commands in order, so stop at the first fence that it hasn't passed
+    while (!_fences.empty())
+    {
+        GLenum result = glClientWaitSync((GLsync)_fences.front().sync, 0, 0);
+        if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED)
+        {
+            break;
+        }
+        glDeleteSync((GLsync)_fences.front().sync);
+        _fences.pop_front();
+    }
+}
+
+void StreamBuffer::WaitForRange(const size_t begin, const size_t end)
+{
+    // In a steady state, the GPU is a frame or two behind, so most fences have already been
+    // passed by the time that the ring comes back around to them.  Dropping those first keeps
+    // the list (and the search below) short.
+    RetireFinishedFences();
+
+    while (!_fences.empty())
+    {
+        bool overlaps = false;
+        for (size_t fenceIndex = 0; fenceIndex < _fences.size() && !overlaps; fenceIndex++)
+        {
+            const FencedRange &range = _fences[fenceIndex];
+            if (range.begin < range.end)
+            {
+                overlaps = (begin < range.end) && (range.begin < end);
+            }
+            else
+            {
+                // wrapped: [range.begin, capacity) and [0, range.end)
+                overlaps = (end > range.begin) || (begin < range.end);
+            }
+        }
+        if (!overlaps)
+        {
+            break;
+        }
+
+        // the oldest fence is the first one that the GPU will get to, so waiting on them in
+        // order never waits any longer than waiting on the overlapping one directly
+        GLenum result = GL_TIMEOUT_EXPIRED;
+        while (result == GL_TIMEOUT_EXPIRED)
+        {
+            result = glClientWaitSync((GLsync)_fences.front().sync,
+                GL_SYNC_FLUSH_COMMANDS_BIT, FenceWaitTimeout);
+        }
+        if (result == GL_WAIT_FAILED)
+        {
+            fprintf(stderr, "stream buffer fence wait failed\n");
+        }
+        glDeleteSync((GLsync)_fences.front().sync);
+        _fences.pop_front();
+    }
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <stddef.h>     // for size_t
+
+#include <deque>
+#include <memory>       // for the shared pointer
+
+// one GL_ARRAY_BUFFER that stays mapped for as long as it exists, which every atlas writes its
+// vertices straight into
+// Note: glBufferData(...) on every draw makes the driver hand out fresh memory each time (or
+// wait for the GPU to finish with the old memory), and the vertices were first assembled in a
+// std::vector and then copied.  Here the buffer is made once with glBufferStorage(...) (OpenGL
+// 4.4), mapped persistently and coherently, and used as a ring: each draw reserves the next
+// stretch, writes its vertices right into it, and then fences it.  A stretch is only written
+// again after its fence says that the GPU is done reading it, which almost never means waiting
+// because by then the ring has gone all the way around.
+// Also Note: Coherent mapping means that the writes are visible to the GPU without flushing,
+// but the memory is usually write-combined, so it should be written in order and not read.
+class StreamBuffer
+{
+public:
+    // the buffer that all atlases share; it is made on the first call and deleted when its
+    // last user lets go of it
+    // Note: There must be an OpenGL context.
+    static std::shared_ptr<StreamBuffer> Shared();
+
+    ~StreamBuffer();
+
+    // the ring starts at this many bytes (65536 glyph vertices) and doubles whenever a single
+    // reservation would take more than half of it
+    static const size_t InitialCapacity = 1 << 20;
+
+    // returns: where to write up to "bytes" bytes, or null if the buffer couldn't be made
+    // offset: where that is in the buffer, a multiple of stride so that it is a whole number
+    // of vertices in
+    // Note: Nothing is used up until Commit(...), so reserve as much as the draw could
+    // possibly need and then commit what it actually wrote.
+    // Also Note: Growing makes a new buffer, so get BufferId() after this, not before.
+    void *Reserve(const size_t bytes, const size_t stride, size_t &offset);
+
+    // the last reservation's first "bytes" bytes are in use
+    void Commit(const size_t bytes);
+
+    // call after the draw calls that read everything committed since the last fence
+    // Note: Until then, the committed bytes could be handed out again on the next lap.
+    void Fence();
+
+    // actually a GLuint (see FreeTypeAtlas.h)
+    unsigned int BufferId() const;
+
+    // goes up by 1 every time that the buffer is made anew
+    // Note: Vertex arrays hold on to the buffer that their attributes were pointed at, so
+    // they need pointing at the new one.  The ID alone can't tell, since OpenGL may give the
+    // new buffer the old one's ID.
+    unsigned int Generation() const;
+
+private:
+    // use Shared()
+    StreamBuffer();
+    StreamBuffer(const StreamBuffer &) = delete;
+    StreamBuffer &operator=(const StreamBuffer &) = delete;
+
+    // makes, and maps, a new buffer of the given size and forgets the old one
+    // Note: OpenGL doesn't actually free the old buffer until the GPU is done with it.
+    bool Allocate(const size_t capacity);
+
+    // waits on the fences of everything that the GPU might still be reading in [begin, end)
+    void WaitForRange(const size_t begin, const size_t end);
+
+    // forgets the fences that the GPU has already passed without waiting on any
+    void RetireFinishedFences();
+
+    // actually a GLuint
+    unsigned int _bufferId;
+    unsigned int _generation;
+    unsigned char *_mapped;
+    size_t _capacity;
+
+    // the next free byte, where the current reservation starts, and where the last fence was
+    size_t _head;
+    size_t _reservedOffset;
+    size_t _fencedHead;
+
+    // the bytes from one fence to the next, oldest first
+    // Note: A range that went around the end of the ring has begin > end.
+    // Also Note: The sync is actually a GLsync, which is a pointer to an opaque struct.
+    struct FencedRange
+    {
+        size_t begin;
+        size_t end;
+        void *sync;
+    };
+    std::deque<FencedRange> _fences;
+};
@@ -0,0 +1,179 @@
+#include "TextBatch.h"
+#include "GlStateCache.h"
+
+// the OpenGL version include also includes all previous versions
+// Build note: Do NOT mistakenly include _int_gl_4_4.h.  That one doesn't define OpenGL stuff
+// first.
+#include "glload/include/glload/gl_4_4.h"
+
+#include <stddef.h>     // for offsetof(...)
+
+TextBatch::TextBatch() :
+    _runCount(0),
+    _vaoId(0),
+    _vaoStreamGeneration(0),
+    _lastDrawCallCount(0)
+{
+}
+
+TextBatch::~TextBatch()
+{
+    // Note: A batch that never flushed may not have had an OpenGL context to delete with.
+    if (_vaoId != 0)
+    {
+        GlStateCache::Current().Forget(GL_VERTEX_ARRAY, _vaoId);
+        glDeleteVertexArrays(1, &_vaoId);
+    }
+}
+
+void TextBatch::AddText(const std::shared_ptr<FreeTypeAtlas> &atlas, const std::string &str,
+    const float posPixels[2], const float userScale[2], const float color[4])
+{
+    if (atlas == nullptr || str.empty())
+    {
+        return;
+    }
+
+    // a frame rarely has more than a handful of atlases, so a linear search beats hashing them
+    size_t runIndex = 0;
+    for (; runIndex < _runCount; runIndex++)
+    {
+        if (_runs[runIndex].atlas == atlas)
+        {
+            break;
+        }
+    }
+    if (runIndex == _runCount)
+    {
+        if (_runCount == _runs.size())
+        {
+            _runs.push_back(TextRun());
+        }
+        TextRun &newRun = _runs[_runCount++];
+        newRun.atlas = atlas;
+        newRun.text.clear();
+        newRun.firstVertex = 0;
+        newRun.vertexCount = 0;
+    }
+
+    TextRun &run = _runs[runIndex];
+    run.text.push_back(QueuedText());
+    QueuedText &queued = run.text.back();
+    queued.str = str;
+    queued.posPixels[0] = posPixels[0];
+    queued.posPixels[1] = posPixels[1];
+    queued.userScale[0] = userScale[0];
+    queued.userScale[1] = userScale[1];
+    queued.color = PackColor(color);
+}
+
+void TextBatch::Flush()
+{
+    _lastDrawCallCount = 0;
+    if (_runCount == 0)
+    {
+        return;
+    }
+
+    if (_vertexStream == nullptr)
+    {
+        _vertexStream = StreamBuffer::Shared();
+        _quadIndexBuffer = QuadIndexBuffer::Shared();
+        glGenVertexArrays(1, &_vaoId);
+    }
+
+    // room for 4 vertices per byte of every string, which is the most that they could need
+    size_t maxVertexCount = 0;
+    for (size_t runIndex = 0; runIndex < _runCount; runIndex++)
+    {
+        const TextRun &run = _runs[runIndex];
+        for (size_t textIndex = 0; textIndex < run.text.size(); textIndex++)
+        {
+            maxVertexCount += VerticesPerQuad * run.text[textIndex].str.length();
+        }
+    }
+    size_t byteOffset = 0;
+    TextVertex *vertices = (TextVertex *)_vertexStream->Reserve(
+        maxVertexCount * sizeof(TextVertex), sizeof(TextVertex), byteOffset);
+    size_t vertexCount = 0;
+
+    // Make every quad before drawing any of them.  The quads are made one atlas at a time
+    // because adding a glyph can make the atlas grow, which moves the T coordinates of every
+    // quad that the atlas has already made (see FreeTypeAtlas::AppendText(...)).
+    for (size_t runIndex = 0; runIndex < _runCount && vertices != 0; runIndex++)
+    {
+        TextRun &run = _runs[runIndex];
+        run.atlas->BeginBatch();
+        run.firstVertex = vertexCount;
+        for (size_t textIndex = 0; textIndex < run.text.size(); textIndex++)
+        {
+            const QueuedText &queued = run.text[textIndex];
+            vertexCount = run.atlas->AppendText(queued.str, queued.posPixels,
+                queued.userScale, queued.color, vertices, run.firstVertex, vertexCount);
+        }
+        run.vertexCount = vertexCount - run.firstVertex;
+    }
+
+    if (vertexCount != 0)
+    {
+        // see FreeTypeAtlas::RenderText(...) for the details
+        GlStateCache &glState = GlStateCache::Current();
+        glState.EnableAlphaBlend();
+
+        // the whole frame's text is already in the buffer, and the vertex array only needs
+        // setting up again when the stream is made anew (see
+        // FreeTypeAtlas::BindTextVertexArray())
+        _vertexStream->Commit(vertexCount * sizeof(TextVertex));
+        glState.BindVertexArray(_vaoId);
+        if (_vaoStreamGeneration != _vertexStream->Generation())
+        {
+            _vaoStreamGeneration = _vertexStream->Generation();
+            glBindBuffer(GL_ARRAY_BUFFER, _vertexStream->BufferId());
+            GLint bytesPerVertex = sizeof(TextVertex);
+            glEnableVertexAttribArray(0);
+            glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, bytesPerVertex,
+                (void *)offsetof(TextVertex, x));
+            glEnableVertexAttribArray(1);
+            glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, bytesPerVertex,
+                (void *)offsetof(TextVertex, s));
+            glEnableVertexAttribArray(2);
+            glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, bytesPerVertex,
+                (void *)offsetof(TextVertex, color));
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _quadIndexBuffer->BufferId());
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        }
+
+        // one draw call per atlas, each over its own stretch of the buffer
+        size_t streamFirstVertex = byteOffset / sizeof(TextVertex);
+        for (size_t runIndex = 0; runIndex < _runCount; runIndex++)
+        {
+            const TextRun &run = _runs[runIndex];
+            if (run.vertexCount == 0)
+            {
+                continue;
+            }
+
+            run.atlas->BindForBatch();
+            size_t quadCount = run.vertexCount / VerticesPerQuad;
+            _quadIndexBuffer->DrawQuads(streamFirstVertex + run.firstVertex, quadCount);
+            _lastDrawCallCount += (unsigned int)
+                ((quadCount + QuadIndexBuffer::MaxQuadsPerDraw - 1) / 
+                QuadIndexBuffer::MaxQuadsPerDraw);
+        }
+
+        _vertexStream->Fence();
+    }
+
+    // let go of the atlases, but keep the memory for the next frame
+    for (size_t runIndex = 0; runIndex < _runCount; runIndex++)
+    {
+        _runs[runIndex].atlas.reset();
+        _runs[runIndex].text.clear();
+    }
+    _runCount = 0;
+}
+
+unsigned int TextBatch::LastDrawCallCount() const
+{
+    return _lastDrawCallCount;
+}
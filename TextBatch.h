@@ -0,0 +1,85 @@
+#pragma once
+
+// for the atlases that the text is drawn from and the vertices that they make
+#include "FreeTypeAtlas.h"
+
+// for drawing the quads and for the buffer that their vertices are written into
+#include "QuadIndexBuffer.h"
+#include "StreamBuffer.h"
+
+#include <memory>       // for the shared pointer
+#include <string>
+#include <vector>
+
+// collects the text for a whole frame and draws it all at once
+// Note: Every FreeTypeAtlas::RenderText(...) call enables blending, binds the texture, sets
+// the uniforms, sets up the vertex attributes, uploads its own vertices, and draws, so a
+// screen with hundreds of labels makes hundreds of draw calls.  Here the strings are only
+// queued up by AddText(...), and Flush() writes every quad for the frame into one stretch of
+// the mapped vertex stream (see StreamBuffer.h), and then makes one draw call for each atlas,
+// in the order that they first showed up.  The color is in the vertices (see PackColor(...)),
+// so text in any number of colors still goes out in the same call.
+// Also Note: Text that is drawn with the same atlas is drawn in the same call, even if text in
+// another atlas was queued between them, so overlapping text from different atlases might not
+// stack in the order that it was queued.
+// Also Also Note: Like RenderText(...), this draws with whatever program is bound, which
+// should be the one from FreeTypeEncapsulate::Init(...).
+class TextBatch
+{
+public:
+    TextBatch();
+    ~TextBatch();
+
+    // queues a UTF-8 string for the next Flush()
+    // Note: Position and scale work the same as they do for FreeTypeAtlas::RenderText(...).
+    // The batch holds on to the atlas until then.
+    void AddText(const std::shared_ptr<FreeTypeAtlas> &atlas, const std::string &str,
+        const float posPixels[2], const float userScale[2], const float color[4]);
+
+    // draws everything that was queued since the last call and forgets it
+    void Flush();
+
+    // how many draw calls the last Flush() made, to see how well the text batched
+    unsigned int LastDrawCallCount() const;
+
+private:
+    struct QueuedText
+    {
+        std::string str;
+        float posPixels[2];
+        float userScale[2];
+
+        // see PackColor(...)
+        unsigned int color;
+    };
+
+    // everything that is drawn with one atlas, which is what a draw call can cover
+    // Note: This used to be one atlas in one color, back when the color was a uniform.
+    struct TextRun
+    {
+        std::shared_ptr<FreeTypeAtlas> atlas;
+        std::vector<QueuedText> text;
+
+        // where the run's vertices ended up in the frame's stretch of the vertex stream
+        size_t firstVertex;
+        size_t vertexCount;
+    };
+    std::vector<TextRun> _runs;
+
+    // how many of the runs the current frame is using
+    // Note: Runs are kept between frames rather than thrown out so that their lists keep 
+    // their memory.
+    size_t _runCount;
+
+    // Note: Picked up on the first Flush() rather than in the constructor so that a batch can 
+    // be made before there is an OpenGL context.
+    std::shared_ptr<StreamBuffer> _vertexStream;
+    std::shared_ptr<QuadIndexBuffer> _quadIndexBuffer;
+
+    // actually a GLuint, and the stream generation that it was last set up for (see
+    // FreeTypeAtlas.h)
+    unsigned int _vaoId;
+    unsigned int _vaoStreamGeneration;
+
+    unsigned int _lastDrawCallCount;
+};
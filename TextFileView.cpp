@@ -0,0 +1,337 @@
+#include "TextFileView.h"
+#include "LineIndex.h"
+#include "QuadIndexBuffer.h"
+#include "GlStateCache.h"
+#include "Utf8.h"
+
+// the OpenGL version include also includes all previous versions
+// Build note: Do NOT mistakenly include _int_gl_4_4.h.  That one doesn't define OpenGL stuff
+// first.
+#include "glload/include/glload/gl_4_4.h"
+
+#include <math.h>       // for floor(...), ceil(...), floorf(...), ceilf(...)
+#include <stddef.h>     // for offsetof(...)
+
+#include <algorithm>    // for std::min, std::max
+
+// how much of each row is below the baseline, for the glyphs that hang down (g, j, p, q, y)
+static const float DescentFraction = 0.25f;
+
+// the attribute that moves every vertex (see shader.vert)
+static const unsigned int PixelOffsetAttribute = 3;
+
+TextFileView::TextFileView(const std::shared_ptr<FreeTypeAtlas> &atlas,
+    const float rectPixels[4], const float lineHeight, const float userScale[2]) :
+    _atlas(atlas),
+    _lineHeight(lineHeight),
+    _firstLine(0.0),
+    _color(0),
+    _layoutNeeded(true),
+    _atlasLayoutGeneration(0),
+    _windowFirstLine(0),
+    _windowEndLine(0),
+    _quadCount(0),
+    _vboId(0),
+    _vaoId(0),
+    _vboCapacityVertices(0),
+    _layoutCount(0),
+    _quadUploadCount(0)
+{
+    for (int side = 0; side < 4; side++)
+    {
+        _rectPixels[side] = rectPixels[side];
+    }
+    _userScale[0] = userScale[0];
+    _userScale[1] = userScale[1];
+
+    // set up the same way as a TextMesh's (see TextMesh's constructor)
+    _quadIndexBuffer = QuadIndexBuffer::Shared();
+    glGenBuffers(1, &_vboId);
+    glGenVertexArrays(1, &_vaoId);
+    GlStateCache::Current().BindVertexArray(_vaoId);
+    glBindBuffer(GL_ARRAY_BUFFER, _vboId);
+    GLint bytesPerVertex = sizeof(TextVertex);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, bytesPerVertex,
+        (void *)offsetof(TextVertex, x));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, bytesPerVertex,
+        (void *)offsetof(TextVertex, s));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, bytesPerVertex,
+        (void *)offsetof(TextVertex, color));
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _quadIndexBuffer->BufferId());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+TextFileView::~TextFileView()
+{
+    GlStateCache::Current().Forget(GL_VERTEX_ARRAY, _vaoId);
+    glDeleteVertexArrays(1, &_vaoId);
+    glDeleteBuffers(1, &_vboId);
+}
+
+bool TextFileView::Open(const std::string &filePath)
+{
+    Close();
+    if (!_file.Open(filePath))
+    {
+        return false;
+    }
+
+    BuildLineIndex(_file.Data(), _file.Size(), 0, _lineStarts);
+    _firstLine = 0.0;
+    _layoutNeeded = true;
+    return true;
+}
+
+void TextFileView::Close()
+{
+    _file.Close();
+
+    // Note: Swapping actually frees the memory, which clear() doesn't, and a big file's index
+    // is big.
+    std::vector<size_t>().swap(_lineStarts);
+    _firstLine = 0.0;
+    _layoutNeeded = true;
+}
+
+size_t TextFileView::LineCount() const
+{
+    return _lineStarts.size();
+}
+
+void TextFileView::SetRect(const float rectPixels[4])
+{
+    for (int side = 0; side < 4; side++)
+    {
+        if (rectPixels[side] != _rectPixels[side])
+        {
+            _rectPixels[side] = rectPixels[side];
+            _layoutNeeded = true;
+        }
+    }
+}
+
+void TextFileView::SetLineHeight(const float lineHeight)
+{
+    if (lineHeight != _lineHeight)
+    {
+        _lineHeight = lineHeight;
+        _layoutNeeded = true;
+    }
+}
+
+void TextFileView::SetScale(const float userScale[2])
+{
+    if (userScale[0] != _userScale[0] || userScale[1] != _userScale[1])
+    {
+        _userScale[0] = userScale[0];
+        _userScale[1] = userScale[1];
+        _layoutNeeded = true;
+    }
+}
+
+void TextFileView::ScrollTo(const double firstLine)
+{
+    // the last line can go no higher than the bottom of the panel
+    double lastFirstLine = std::max((double)LineCount() - VisibleLines(), 0.0);
+    _firstLine = std::min(std::max(firstLine, 0.0), lastFirstLine);
+}
+
+double TextFileView::FirstLine() const
+{
+    return _firstLine;
+}
+
+void TextFileView::Draw(const float color[4])
+{
+    unsigned int packedColor = PackColor(color);
+    if (packedColor != _color)
+    {
+        _color = packedColor;
+        _layoutNeeded = true;
+    }
+    if (_atlas->LayoutGeneration() != _atlasLayoutGeneration)
+    {
+        _layoutNeeded = true;
+    }
+
+    // the lines that are at least partly in the panel
+    size_t firstLine = (size_t)_firstLine;
+    size_t endLine = std::min((size_t)ceil(_firstLine + VisibleLines()), LineCount());
+    if (firstLine < _windowFirstLine || endLine > _windowEndLine)
+    {
+        _layoutNeeded = true;
+    }
+    if (_layoutNeeded)
+    {
+        Layout(firstLine, endLine);
+    }
+    if (_quadCount == 0)
+    {
+        return;
+    }
+
+    // see TextMesh::Draw(...), only cut off at the panel's edges
+    // Note: BindForBatch() sets the scissor test up for the atlas' own clip rectangle, so the
+    // panel's comes after it.
+    GlStateCache &glState = GlStateCache::Current();
+    glState.EnableAlphaBlend();
+    _atlas->BindForBatch();
+    int left = (int)floorf(_rectPixels[0]);
+    int bottom = (int)floorf(_rectPixels[1]);
+    int right = std::max((int)ceilf(_rectPixels[2]), left);
+    int top = std::max((int)ceilf(_rectPixels[3]), bottom);
+    int box[4] = { left, bottom, right - left, top - bottom };
+    glState.EnableScissor(box);
+    glState.BindVertexArray(_vaoId);
+
+    // the quads were laid out with _windowFirstLine at the top, so the lines move up by however
+    // many lines the view has scrolled past it
+    // Note: The offset is only a few panels' worth of pixels at most, so a float is plenty
+    // even when the line number itself is in the millions.
+    // Also Note: The value is global rather than part of the vertex array, so it goes back to
+    // 0 for everything else that draws with the program.
+    float offsetPixels = (float)((_firstLine - (double)_windowFirstLine) * _lineHeight);
+    glVertexAttrib2f(PixelOffsetAttribute, 0.0f, offsetPixels);
+    _quadIndexBuffer->DrawQuads(0, _quadCount);
+    glVertexAttrib2f(PixelOffsetAttribute, 0.0f, 0.0f);
+    glState.DisableScissor();
+}
+
+unsigned int TextFileView::LayoutCount() const
+{
+    return _layoutCount;
+}
+
+unsigned int TextFileView::QuadUploadCount() const
+{
+    return _quadUploadCount;
+}
+
+double TextFileView::VisibleLines() const
+{
+    if (_lineHeight <= 0.0f)
+    {
+        return 0.0;
+    }
+    return std::max((double)(_rectPixels[3] - _rectPixels[1]) / (double)_lineHeight, 0.0);
+}
+
+void TextFileView::Layout(const size_t firstLine, const size_t endLine)
+{
+    _layoutNeeded = false;
+    _layoutCount++;
+    _windowFirstLine = (firstLine > OverscanLines) ? firstLine - OverscanLines : 0;
+    _windowEndLine = std::min(endLine + OverscanLines, LineCount());
+
+    // see TextMesh::Layout()
+    _atlas->BeginBatch();
+    unsigned int atlasLayoutGeneration = 0;
+    do
+    {
+        atlasLayoutGeneration = _atlas->LayoutGeneration();
+        _quadCount = 0;
+        for (size_t line = _windowFirstLine; line < _windowEndLine; line++)
+        {
+            // each line's baseline is one row down from the one before it, starting from the
+            // panel's top edge
+            float row = (float)(line - _windowFirstLine);
+            float pen[2] = { _rectPixels[0],
+                _rectPixels[3] - ((row + 1.0f - DescentFraction) * _lineHeight) };
+            LayoutLine(line, pen);
+        }
+    } while (_atlas->LayoutGeneration() != atlasLayoutGeneration);
+    _atlasLayoutGeneration = atlasLayoutGeneration;
+    if (_quadCount == 0)
+    {
+        return;
+    }
+
+    size_t vertexCount = _quadCount * VerticesPerQuad;
+    if (vertexCount > _vboCapacityVertices)
+    {
+        // at least double it so that a panel of longer lines doesn't reallocate on every
+        // layout
+        _vboCapacityVertices = std::max(vertexCount, _vboCapacityVertices * 2);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, _vboId);
+        glBufferData(GL_COPY_WRITE_BUFFER, _vboCapacityVertices * sizeof(TextVertex), 0,
+            GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+
+    // Note: The copy binding point is used so that nothing else's GL_ARRAY_BUFFER binding is
+    // disturbed (see QuadIndexBuffer's constructor).
+    glBindBuffer(GL_COPY_WRITE_BUFFER, _vboId);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, 0, vertexCount * sizeof(TextVertex),
+        _vertices.data());
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    _quadUploadCount += (unsigned int)_quadCount;
+}
+
+void TextFileView::LayoutLine(const size_t line, float pen[2])
+{
+    // the line ends where the next one starts, without the line break
+    // Note: The last line ends at the end of the file, which may or may not be a '\n' (see
+    // BuildLineIndex(...)).
+    const char *text = (const char *)_file.Data();
+    size_t begin = _lineStarts[line];
+    size_t end = (line + 1 < LineCount()) ? _lineStarts[line + 1] : _file.Size();
+    if (end > begin && text[end - 1] == '\n')
+    {
+        end--;
+    }
+    if (end > begin && text[end - 1] == '\r')
+    {
+        end--;
+    }
+
+    // A glyph can reach back to the left of its pen (see MakeGlyphQuad(...)), so the line
+    // goes on for a row's height past the right edge before it is cut off.  A line that is
+    // megabytes long costs no more than one that is as wide as the panel.
+    float rightLimit = _rectPixels[2] + _lineHeight;
+    size_t column = 0;
+    size_t byteIndex = 0;
+    size_t length = end - begin;
+    unsigned int previousCodePoint = 0;
+    while (byteIndex < length && pen[0] < rightLimit)
+    {
+        unsigned int codePoint = DecodeUtf8(text + begin, length, byteIndex);
+        if (codePoint == '\t')
+        {
+            // spaces up to the next tab stop
+            do
+            {
+                AppendQuad(previousCodePoint, ' ', pen);
+                previousCodePoint = ' ';
+                column++;
+            } while ((column % TabWidth) != 0);
+            continue;
+        }
+        AppendQuad(previousCodePoint, codePoint, pen);
+        previousCodePoint = codePoint;
+        column++;
+    }
+}
+
+void TextFileView::AppendQuad(const unsigned int previousCodePoint,
+    const unsigned int codePoint, float pen[2])
+{
+    // see FreeTypeAtlas::Kerning(...)
+    pen[0] += _atlas->Kerning(previousCodePoint, codePoint) * _userScale[0];
+
+    size_t firstVertex = _quadCount * VerticesPerQuad;
+    if (firstVertex + VerticesPerQuad > _vertices.size())
+    {
+        _vertices.resize(std::max(firstVertex + VerticesPerQuad, _vertices.size() * 2));
+    }
+
+    // a quad with no width or no height draws nothing, so the next glyph can have its spot
+    TextVertex *corners = _vertices.data() + firstVertex;
+    _atlas->AppendGlyph(codePoint, _userScale, _color, pen, corners);
+    if (corners[0].x != corners[1].x && corners[0].y != corners[2].y)
+    {
+        _quadCount++;
+    }
+}
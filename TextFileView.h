@@ -0,0 +1,140 @@
+#pragma once
+
+// for the atlas that the text is drawn from and the vertices that it makes
+#include "FreeTypeAtlas.h"
+
+// for the file, which is never read into memory as a whole
+#include "MappedFile.h"
+
+#include <memory>       // for the shared pointers
+#include <string>
+#include <vector>
+
+// every quad is drawn with the shared index buffer (see QuadIndexBuffer.h)
+class QuadIndexBuffer;
+
+// a scrolling panel that shows a text file one line per row, for files that are far too big
+// to lay out (or even to hold in a std::string), like production logs that are gigabytes long
+// Note: The file is memory-mapped (see MappedFile.h), so opening it copies nothing, and the
+// only pass over all of it is the one that finds where the lines start (see LineIndex.h).
+// After that, only the lines that are in the panel, plus OverscanLines more above and below
+// them, are ever decoded, laid out, or sent up, and a line that is wider than the panel stops
+// being laid out once it is past the right edge.  The work for a frame is proportional to the
+// size of the panel, not of the file, wherever it is scrolled to.
+// Also Note: Like TextMesh, the quads are kept on the GPU between frames.  They are laid out
+// relative to the first line of the window that was laid out, and scrolling only changes how
+// far they are moved when they are drawn (see the pixelOffset attribute in shader.vert), so
+// scrolling within the overscan costs one draw call and nothing else.  Scrolling past it lays
+// out the lines around the new position, which is the same amount of work no matter how far
+// the scroll went.
+// Also Also Note: Like RenderText(...), this draws with whatever program is bound, which
+// should be the one from FreeTypeEncapsulate::Init(...).  The panel is its own scissor box,
+// so nothing is drawn outside of it.
+class TextFileView
+{
+public:
+    // Note: There must be an OpenGL context, which there is if there is an atlas.
+    // Also Note: The rectangle is left, bottom, right, and top, in pixels from the window's
+    // bottom left corner (like FreeTypeAtlas::SetClipRect(...)).  Every line is lineHeight
+    // pixels tall, and the glyphs are scaled like they are for FreeTypeAtlas::RenderText(...).
+    TextFileView(const std::shared_ptr<FreeTypeAtlas> &atlas, const float rectPixels[4],
+        const float lineHeight, const float userScale[2]);
+    ~TextFileView();
+
+    // lines that are laid out above and below the panel so that scrolling a little doesn't
+    // need a layout
+    static const unsigned int OverscanLines = 8;
+
+    // how many columns a tab goes to the next multiple of
+    static const unsigned int TabWidth = 4;
+
+    // takes: file path relative to the working directory
+    // returns: true if the file was mapped and its lines were found, otherwise false
+    // Note: Finding the lines reads the whole file once (see BuildLineIndex(...)), with one
+    // thread per hardware thread.  The index is one size_t per line.
+    // Also Note: The view scrolls back to the top.
+    bool Open(const std::string &filePath);
+
+    // unmaps the file; safe to call when nothing is open
+    void Close();
+
+    // returns: how many lines the file has, or 0 if nothing is open
+    size_t LineCount() const;
+
+    // each one only marks the view for another layout if the value is different, so it is
+    // fine to call these every frame with the same values
+    void SetRect(const float rectPixels[4]);
+    void SetLineHeight(const float lineHeight);
+    void SetScale(const float userScale[2]);
+
+    // the line (counting from 0) that is at the top of the panel, which can be between two
+    // lines for smooth scrolling
+    // Note: It is kept between the first line and the last full panel of lines.
+    void ScrollTo(const double firstLine);
+    double FirstLine() const;
+
+    // lays the lines that are in the panel out again if they aren't all laid out already,
+    // or if anything else changed, and then draws them
+    void Draw(const float color[4]);
+
+    // how many times lines were laid out and how many quads have been sent up in all, to see
+    // how often scrolling had to go past the overscan
+    unsigned int LayoutCount() const;
+    unsigned int QuadUploadCount() const;
+
+private:
+    TextFileView(const TextFileView &) = delete;
+    TextFileView &operator=(const TextFileView &) = delete;
+
+    // returns: how many lines fit in the panel, which usually isn't a whole number
+    double VisibleLines() const;
+
+    // makes the quads for the lines in [firstLine, endLine), plus the overscan, and sends
+    // them up, making the buffer bigger if it has to
+    void Layout(const size_t firstLine, const size_t endLine);
+
+    // makes the quads for one line, starting at the pen
+    void LayoutLine(const size_t line, float pen[2]);
+
+    // kerns the glyph against the one before it, makes its quad at the end of the list, and
+    // keeps the quad if there is anything to see, so that spaces and glyphs that the font
+    // doesn't have take no room
+    void AppendQuad(const unsigned int previousCodePoint, const unsigned int codePoint,
+        float pen[2]);
+
+    std::shared_ptr<FreeTypeAtlas> _atlas;
+    std::shared_ptr<QuadIndexBuffer> _quadIndexBuffer;
+
+    // the file, and where each of its lines starts (see BuildLineIndex(...))
+    MappedFile _file;
+    std::vector<size_t> _lineStarts;
+
+    float _rectPixels[4];
+    float _lineHeight;
+    float _userScale[2];
+    double _firstLine;
+
+    // see PackColor(...)
+    unsigned int _color;
+
+    // what the quads were made for
+    // Note: Scrolling isn't in here.  The quads are for the lines in [_windowFirstLine,
+    // _windowEndLine), and are good for as long as the panel's lines are all among them.
+    bool _layoutNeeded;
+    unsigned int _atlasLayoutGeneration;
+    size_t _windowFirstLine;
+    size_t _windowEndLine;
+
+    // the quads are made here and then sent up in one go
+    // Note: The memory is kept for the next layout.
+    std::vector<TextVertex> _vertices;
+    size_t _quadCount;
+
+    // actually GLuints (see FreeTypeAtlas.h)
+    unsigned int _vboId;
+    unsigned int _vaoId;
+    size_t _vboCapacityVertices;
+
+    unsigned int _layoutCount;
+    unsigned int _quadUploadCount;
+};
@@ -0,0 +1,315 @@
+#include "TextMesh.h"
+#include "QuadIndexBuffer.h"
+#include "GlStateCache.h"
+#include "Utf8.h"
+
+// the OpenGL version include also includes all previous versions
+// Build note: Do NOT mistakenly include _int_gl_4_4.h.  That one doesn't define OpenGL stuff
+// first.
+#include "glload/include/glload/gl_4_4.h"
+
+#include <stddef.h>     // for offsetof(...)
+
+#include <algorithm>    // for std::max
+
+// one code point per character of a UTF-8 string
+static void DecodeCodePoints(const std::string &str, std::vector<unsigned int> &codePoints)
+{
+    codePoints.clear();
+    size_t byteIndex = 0;
+    while (byteIndex < str.length())
+    {
+        codePoints.push_back(DecodeUtf8(str.data(), str.length(), byteIndex));
+    }
+}
+
+TextMesh::TextMesh(const std::shared_ptr<FreeTypeAtlas> &atlas, const std::string &str,
+    const float posPixels[2], const float userScale[2]) :
+    _atlas(atlas),
+    _text(str),
+    _color(0),
+    _layoutNeeded(true),
+    _textChanged(false),
+    _colorChanged(false),
+    _atlasLayoutGeneration(0),
+    _quadCount(0),
+    _vboId(0),
+    _vaoId(0),
+    _vboCapacityVertices(0),
+    _layoutCount(0),
+    _quadUploadCount(0)
+{
+    _posPixels[0] = posPixels[0];
+    _posPixels[1] = posPixels[1];
+    _userScale[0] = userScale[0];
+    _userScale[1] = userScale[1];
+
+    // the buffer has no storage until the first layout, but the vertex array can already be
+    // pointed at it because it holds on to the buffer, not the storage
+    _quadIndexBuffer = QuadIndexBuffer::Shared();
+    glGenBuffers(1, &_vboId);
+    glGenVertexArrays(1, &_vaoId);
+    GlStateCache::Current().BindVertexArray(_vaoId);
+    glBindBuffer(GL_ARRAY_BUFFER, _vboId);
+    GLint bytesPerVertex = sizeof(TextVertex);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, bytesPerVertex,
+        (void *)offsetof(TextVertex, x));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, bytesPerVertex,
+        (void *)offsetof(TextVertex, s));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, bytesPerVertex,
+        (void *)offsetof(TextVertex, color));
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _quadIndexBuffer->BufferId());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+TextMesh::~TextMesh()
+{
+    GlStateCache::Current().Forget(GL_VERTEX_ARRAY, _vaoId);
+    glDeleteVertexArrays(1, &_vaoId);
+    glDeleteBuffers(1, &_vboId);
+}
+
+void TextMesh::SetText(const std::string &str)
+{
+    if (str != _text)
+    {
+        _text = str;
+        _textChanged = true;
+    }
+}
+
+void TextMesh::SetPosition(const float posPixels[2])
+{
+    if (posPixels[0] != _posPixels[0] || posPixels[1] != _posPixels[1])
+    {
+        _posPixels[0] = posPixels[0];
+        _posPixels[1] = posPixels[1];
+        _layoutNeeded = true;
+    }
+}
+
+void TextMesh::SetScale(const float userScale[2])
+{
+    if (userScale[0] != _userScale[0] || userScale[1] != _userScale[1])
+    {
+        _userScale[0] = userScale[0];
+        _userScale[1] = userScale[1];
+        _layoutNeeded = true;
+    }
+}
+
+void TextMesh::Draw(const float color[4])
+{
+    unsigned int packedColor = PackColor(color);
+    if (packedColor != _color)
+    {
+        _color = packedColor;
+        _colorChanged = true;
+    }
+    if (_atlas->LayoutGeneration() != _atlasLayoutGeneration)
+    {
+        _layoutNeeded = true;
+    }
+    if (_layoutNeeded)
+    {
+        Layout();
+    }
+    else if (_textChanged)
+    {
+        UpdateChangedGlyphs();
+    }
+
+    // Note: A layout makes every quad in the new color already, but UpdateChangedGlyphs() only
+    // makes the quads that changed, so the rest of them still need it.
+    if (_colorChanged)
+    {
+        Recolor();
+    }
+    if (_quadCount == 0)
+    {
+        return;
+    }
+
+    // see FreeTypeAtlas::RenderText(...) for the details
+    // Note: The layout may have grown the atlas, so the texture is bound after it.
+    GlStateCache &glState = GlStateCache::Current();
+    glState.EnableAlphaBlend();
+    _atlas->BindForBatch();
+    glState.BindVertexArray(_vaoId);
+    _quadIndexBuffer->DrawQuads(0, _quadCount);
+}
+
+const std::string &TextMesh::Text() const
+{
+    return _text;
+}
+
+unsigned int TextMesh::LayoutCount() const
+{
+    return _layoutCount;
+}
+
+unsigned int TextMesh::QuadUploadCount() const
+{
+    return _quadUploadCount;
+}
+
+void TextMesh::Layout()
+{
+    _layoutNeeded = false;
+    _textChanged = false;
+    _colorChanged = false;
+    _layoutCount++;
+
+    // one quad per code point, even for those that draw nothing, so that new text can be
+    // compared with the old text one quad at a time (see UpdateChangedGlyphs())
+    DecodeCodePoints(_text, _codePoints);
+    _quadCount = _codePoints.size();
+    _vertices.resize(_quadCount * VerticesPerQuad);
+    _pens.resize((_quadCount + 1) * 2);
+
+    // A glyph that isn't in the atlas yet may make the atlas grow, which moves the quads that
+    // were already made, so if that happens, go through again.
+    // Note: The second time through, every glyph is already in the atlas and can't be evicted
+    // until the next draw call (see FreeTypeAtlas::BeginBatch()), so nothing changes again.
+    _atlas->BeginBatch();
+    unsigned int atlasLayoutGeneration = 0;
+    do
+    {
+        atlasLayoutGeneration = _atlas->LayoutGeneration();
+        float pen[2] = { _posPixels[0], _posPixels[1] };
+        for (size_t quadIndex = 0; quadIndex < _quadCount; quadIndex++)
+        {
+            _pens[(quadIndex * 2)] = pen[0];
+            _pens[(quadIndex * 2) + 1] = pen[1];
+            KernPen(_codePoints, quadIndex, pen);
+            _atlas->AppendGlyph(_codePoints[quadIndex], _userScale, _color, pen,
+                _vertices.data() + (quadIndex * VerticesPerQuad));
+        }
+        _pens[(_quadCount * 2)] = pen[0];
+        _pens[(_quadCount * 2) + 1] = pen[1];
+    } while (_atlas->LayoutGeneration() != atlasLayoutGeneration);
+    _atlasLayoutGeneration = atlasLayoutGeneration;
+
+    size_t vertexCount = _quadCount * VerticesPerQuad;
+    if (vertexCount > _vboCapacityVertices)
+    {
+        // at least double it so that text that keeps getting longer doesn't reallocate on
+        // every change
+        _vboCapacityVertices = std::max(vertexCount, _vboCapacityVertices * 2);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, _vboId);
+        glBufferData(GL_COPY_WRITE_BUFFER, _vboCapacityVertices * sizeof(TextVertex), 0,
+            GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+    UploadQuads(0, _quadCount);
+}
+
+void TextMesh::UpdateChangedGlyphs()
+{
+    _textChanged = false;
+    DecodeCodePoints(_text, _newCodePoints);
+    size_t oldQuadCount = _quadCount;
+    size_t newQuadCount = _newCodePoints.size();
+    if (newQuadCount * VerticesPerQuad > _vboCapacityVertices)
+    {
+        // the buffer has to be made bigger anyway, so everything goes up
+        Layout();
+        return;
+    }
+
+    // Note: Growing the pens keeps the old end pen where the comparison below expects it.
+    _vertices.resize(newQuadCount * VerticesPerQuad);
+    _pens.resize((newQuadCount + 1) * 2);
+
+    // A quad can be kept if its glyph is the same and the pen is where it was before, in
+    // which case the pen after it is also where it was before.  Changed quads that are next
+    // to each other go up together.
+    // Also Note: The pens are from before kerning, so the glyph before it must be the same
+    // too, or else the pair may kern differently (see KernPen(...)).
+    // Note: Only a changed glyph's own pen is overwritten, and only when it is reached, so the
+    // old pens that are still needed for the comparison are still there.
+    _atlas->BeginBatch();
+    float pen[2] = { _posPixels[0], _posPixels[1] };
+    size_t changedBegin = 0;
+    size_t changedEnd = 0;
+    for (size_t quadIndex = 0; quadIndex < newQuadCount; quadIndex++)
+    {
+        float *oldPen = _pens.data() + (quadIndex * 2);
+        if (quadIndex < oldQuadCount && _newCodePoints[quadIndex] == _codePoints[quadIndex] &&
+            (quadIndex == 0 || _newCodePoints[quadIndex - 1] == _codePoints[quadIndex - 1]) &&
+            oldPen[0] == pen[0] && oldPen[1] == pen[1])
+        {
+            pen[0] = oldPen[2];
+            pen[1] = oldPen[3];
+            continue;
+        }
+
+        if (changedBegin == changedEnd || changedEnd != quadIndex)
+        {
+            UploadQuads(changedBegin, changedEnd);
+            changedBegin = quadIndex;
+        }
+        changedEnd = quadIndex + 1;
+
+        oldPen[0] = pen[0];
+        oldPen[1] = pen[1];
+        KernPen(_newCodePoints, quadIndex, pen);
+        _atlas->AppendGlyph(_newCodePoints[quadIndex], _userScale, _color, pen,
+            _vertices.data() + (quadIndex * VerticesPerQuad));
+    }
+    _pens[(newQuadCount * 2)] = pen[0];
+    _pens[(newQuadCount * 2) + 1] = pen[1];
+    _codePoints.swap(_newCodePoints);
+    _quadCount = newQuadCount;
+
+    // a new glyph made the atlas grow or evicted a glyph, so quads that were kept could be
+    // wrong now
+    if (_atlas->LayoutGeneration() != _atlasLayoutGeneration)
+    {
+        Layout();
+        return;
+    }
+    UploadQuads(changedBegin, changedEnd);
+}
+
+void TextMesh::KernPen(const std::vector<unsigned int> &codePoints, const size_t quadIndex,
+    float pen[2]) const
+{
+    if (quadIndex > 0)
+    {
+        pen[0] += _atlas->Kerning(codePoints[quadIndex - 1], codePoints[quadIndex]) *
+            _userScale[0];
+    }
+}
+
+void TextMesh::Recolor()
+{
+    _colorChanged = false;
+    for (size_t vertexIndex = 0; vertexIndex < _vertices.size(); vertexIndex++)
+    {
+        _vertices[vertexIndex].color = _color;
+    }
+    UploadQuads(0, _quadCount);
+}
+
+void TextMesh::UploadQuads(const size_t firstQuad, const size_t endQuad)
+{
+    if (firstQuad == endQuad)
+    {
+        return;
+    }
+
+    // Note: The copy binding point is used so that nothing else's GL_ARRAY_BUFFER binding is
+    // disturbed (see QuadIndexBuffer's constructor).
+    size_t firstVertex = firstQuad * VerticesPerQuad;
+    size_t vertexCount = (endQuad - firstQuad) * VerticesPerQuad;
+    glBindBuffer(GL_COPY_WRITE_BUFFER, _vboId);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, firstVertex * sizeof(TextVertex),
+        vertexCount * sizeof(TextVertex), _vertices.data() + firstVertex);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    _quadUploadCount += (unsigned int)(endQuad - firstQuad);
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+// for the atlas that the text is drawn from and the vertices that it makes
+#include "FreeTypeAtlas.h"
+
+#include <memory>       // for the shared pointers
+#include <string>
+#include <vector>
+
+// every quad is drawn with the shared index buffer (see QuadIndexBuffer.h)
+class QuadIndexBuffer;
+
+// a string that keeps its quads on the GPU between frames
+// Note: RenderText(...) and TextBatch lay out every glyph and send every vertex up again on
+// every frame, even when the text is the same as it was on the last one.  A mesh lays its
+// text out once into a buffer of its own and then draws that buffer until something that
+// changes the quads actually changes: the text, the position, the scale, or the atlas (see
+// FreeTypeAtlas::LayoutGeneration()).  The quads are in pixels, so resizing the window doesn't
+// change them (see FreeTypeEncapsulate::SetViewportSize(...)).  A label that stays put costs one
+// draw call per frame and no layout at all.
+// Also Note: Text that only changes a few characters at a time (counters, clocks, readouts)
+// isn't laid out again at all.  The new text is compared with the old one glyph by glyph, and
+// only the quads that differ are made and sent up.  A glyph that is the same as before and
+// starts at the same pen position keeps its quad, so changing one digit of a number rewrites
+// one quad, as long as the digits all have the same advance (which they do in most fonts).
+// Changing only the color rewrites the color of every vertex, but doesn't lay anything out.
+// Also Also Note: Like RenderText(...), this draws with whatever program is bound, which
+// should be the one from FreeTypeEncapsulate::Init(...).
+class TextMesh
+{
+public:
+    // Note: There must be an OpenGL context, which there is if there is an atlas.
+    // Also Note: Position and scale work the same as they do for
+    // FreeTypeAtlas::RenderText(...).
+    TextMesh(const std::shared_ptr<FreeTypeAtlas> &atlas, const std::string &str,
+        const float posPixels[2], const float userScale[2]);
+    ~TextMesh();
+
+    // each one only marks the mesh for another layout if the value is different, so it is
+    // fine to call these every frame with the same values
+    // Note: New text is only compared with the old text on the next Draw(...), so setting it
+    // several times in between costs nothing extra.
+    void SetText(const std::string &str);
+    void SetPosition(const float posPixels[2]);
+    void SetScale(const float userScale[2]);
+
+    // lays the text out again if anything changed and then draws it
+    // Note: The color is in the vertices (see PackColor(...)), so a new color has to be sent
+    // up, but it never needs a layout (see Recolor()).
+    void Draw(const float color[4]);
+
+    const std::string &Text() const;
+
+    // how many times the text was laid out from scratch and how many quads have been sent
+    // up in all, to see how well the mesh is being retained
+    unsigned int LayoutCount() const;
+    unsigned int QuadUploadCount() const;
+
+private:
+    TextMesh(const TextMesh &) = delete;
+    TextMesh &operator=(const TextMesh &) = delete;
+
+    // makes the quads and sends them up, making the buffer bigger if it has to
+    void Layout();
+
+    // makes and sends up only the quads that the new text changed
+    void UpdateChangedGlyphs();
+
+    // moves the pen by the kerning between the code point and the one before it, if there
+    // is one (see FreeTypeAtlas::Kerning(...))
+    void KernPen(const std::vector<unsigned int> &codePoints, const size_t quadIndex,
+        float pen[2]) const;
+
+    // puts the new color in every vertex and sends them all up
+    void Recolor();
+
+    // sends up the quads in [firstQuad, endQuad)
+    void UploadQuads(const size_t firstQuad, const size_t endQuad);
+
+    std::shared_ptr<FreeTypeAtlas> _atlas;
+    std::shared_ptr<QuadIndexBuffer> _quadIndexBuffer;
+
+    std::string _text;
+    float _posPixels[2];
+    float _userScale[2];
+
+    // see PackColor(...)
+    unsigned int _color;
+
+    // what the quads were made for
+    // Note: A change to the text alone doesn't need a whole layout (see
+    // UpdateChangedGlyphs()).
+    bool _layoutNeeded;
+    bool _textChanged;
+    bool _colorChanged;
+    unsigned int _atlasLayoutGeneration;
+
+    // the quads are made here and then sent up in one go
+    // Note: The memory is kept for the next layout.
+    std::vector<TextVertex> _vertices;
+    size_t _quadCount;
+
+    // the code points that the quads were made for, one quad each, and where the pen was
+    // before each one (X and then Y, before kerning) and after the last one
+    // Note: These are what new text is compared against, so that a glyph that didn't change
+    // doesn't even have to be looked up.
+    std::vector<unsigned int> _codePoints;
+    std::vector<float> _pens;
+
+    // the new text's code points, kept for their memory
+    std::vector<unsigned int> _newCodePoints;
+
+    // actually GLuints (see FreeTypeAtlas.h)
+    // Note: The vertex array is the mesh's own, so it is set up once and never pointed
+    // anywhere else.
+    unsigned int _vboId;
+    unsigned int _vaoId;
+    size_t _vboCapacityVertices;
+
+    unsigned int _layoutCount;
+    unsigned int _quadUploadCount;
+};
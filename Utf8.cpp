@@ -0,0 +1,53 @@
+#include "Utf8.h"
+
+unsigned int DecodeUtf8(const char *str, const size_t length, size_t &index)
+{
+    const unsigned int replacementChar = 0xFFFD;
+    unsigned char lead = (unsigned char)str[index++];
+    if (lead < 0x80)
+    {
+        // plain ASCII
+        return lead;
+    }
+
+    // the lead byte says how many continuation bytes follow
+    unsigned int codePoint = 0;
+    size_t continuationCount = 0;
+    if ((lead & 0xE0) == 0xC0)
+    {
+        codePoint = lead & 0x1F;
+        continuationCount = 1;
+    }
+    else if ((lead & 0xF0) == 0xE0)
+    {
+        codePoint = lead & 0x0F;
+        continuationCount = 2;
+    }
+    else if ((lead & 0xF8) == 0xF0)
+    {
+        codePoint = lead & 0x07;
+        continuationCount = 3;
+    }
+    else
+    {
+        return replacementChar;
+    }
+
+    if (index + continuationCount > length)
+    {
+        return replacementChar;
+    }
+
+    for (size_t byteCount = 0; byteCount < continuationCount; byteCount++)
+    {
+        unsigned char continuation = (unsigned char)str[index + byteCount];
+        if ((continuation & 0xC0) != 0x80)
+        {
+            return replacementChar;
+        }
+        codePoint = (codePoint << 6) | (continuation & 0x3F);
+    }
+
+    index += continuationCount;
+    return codePoint;
+}
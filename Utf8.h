@@ -0,0 +1,8 @@
+#pragma once
+
+#include <stddef.h>     // for size_t
+
+// decodes the UTF-8 sequence that starts at str[index] and moves index past it
+// Note: A malformed sequence decodes as U+FFFD (the "replacement character") and only skips 
+// one byte so that a single bad byte can't swallow the rest of the string.
+unsigned int DecodeUtf8(const char *str, const size_t length, size_t &index);
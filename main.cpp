@@ -21,6 +21,7 @@
 #define FREEGLUT_LIB_PRAGMAS 0
 #include "freeglut/include/GL/freeglut.h"
 
+#ifndef FREETYPE_ATLAS_BAKED_ONLY
 // FreeType builds everything with a lot of pre-defined header paths that are all relative to the
 // "freetype-2.6.1/include/" folder, so unfortunately (for the sake of a barebones demo) that 
 // folder has to be added to the list of "additional include directories" that the project looks
@@ -39,9 +40,12 @@
 
 // apparently the FreeType lib also needs a companion file, "freetype261d.pdb"
 #pragma comment (lib, "freetype-2.6.1/objs/vc2010/Win32/freetype261d.lib")
+#endif
 
 #include "FreeTypeEncapsulate.h"
 #include "FreeTypeAtlas.h"
+#include "TextMesh.h"
+#include "GlStateCache.h"
 #include "Stopwatch.h"
 
 
@@ -51,6 +55,10 @@ static FreeTypeEncapsulate gFt;
 static GLuint gTextTextureProgramId;
 static std::shared_ptr<FreeTypeAtlas> gAtlasPtr;
 
+// the frame rate only changes once a second, so its quads stay on the GPU in between
+// Note: Text that changes every frame is better off in a TextBatch (see TextBatch.h).
+static std::unique_ptr<TextMesh> gFrameRateMesh;
+
 static Timing::Stopwatch gTimer;
 
 // for making program from shader collection
@@ -137,7 +145,9 @@ Creator:
 -----------------------------------------------------------------------------------------------*/
 void display()
 {
-    glUseProgram(gTextTextureProgramId);
+    // Note: Through the state cache so that the text's uniforms can be cached too (see
+    // GlStateCache.h).
+    GlStateCache::Current().UseProgram(gTextTextureProgramId);
 
     // clear existing data
     glClearColor(0.2f, 0.2f, 0.2f, 0.0f);   // make background a dull grey
@@ -153,6 +163,11 @@ void display()
     if (elapsedTime > 1.0)
     {
         frameRate = (double)elapsedFrames / elapsedTime;
+
+        // the only time that the text has to be laid out again
+        char str[16];
+        sprintf(str, "%.2lf", frameRate);
+        gFrameRateMesh->SetText(str);
         
         // reset the counters
         elapsedFrames = 0;
@@ -160,30 +175,22 @@ void display()
     }
 
     // the shader for this program uses a vec4 (implicit content type is float) for color, so 
-    // specify text color as a 4-float array and give it to shader 
+    // specify text color as a 4-float array, which goes into the vertices (see PackColor(...))
     // Note: Even though color only needs RGB, use an alpha value as well in case some text
     // transparency is desired.
     GLfloat color[4] = { 0.5f, 0.5f, 0.0f, 1.0f };
-    char str[8];
-    sprintf(str, "%.2lf", frameRate);
-    float xy[2] = { -0.99f, -0.99f };
-    float scaleXY[2] = { 1.0f, 1.0f };
-    //gAtlasPtr->RenderText("{123}", xy, scaleXY, color);
-    gAtlasPtr->RenderText(str, xy, scaleXY, color);
-
-    //xy[0] = -0.5f;
-    //xy[1] = -0.5f;
-    //scaleXY[0] = 2.0f;
-    //scaleXY[1] = 2.0f;
+    gFrameRateMesh->Draw(color);
+
+    //float xy[2] = { 125.0f, 125.0f };
+    //float scaleXY[2] = { 2.0f, 2.0f };
     //gAtlasPtr->RenderChar('L', xy, scaleXY, color);
 
-    //xy[0] = +0.5f;
-    //xy[1] = -0.23f;
+    //xy[0] = 375.0f;
+    //xy[1] = 192.0f;
     //scaleXY[0] = 4.0f;
     //scaleXY[1] = 4.0f;
     //gAtlasPtr->RenderChar('p', xy, scaleXY, color);
 
-
     // tell the GPU to swap out the displayed buffer with the one that was just rendered
     glutSwapBuffers();
 
@@ -191,10 +198,9 @@ void display()
     // Note: https://www.opengl.org/discussion_boards/showthread.php/168717-I-dont-understand-what-glutPostRedisplay()-does
     glutPostRedisplay();
 
-    // clean up bindings
-    // Note: This is just good practice, but in reality the bindings can be left as they were 
-    // and re-bound on each new call to this rendering function.
-    glUseProgram(0);
+    // Note: The program (and the text's other state) is left bound on purpose.  The next
+    // frame binds the same program, and the state cache skips that bind if nothing has changed
+    // it in the meantime.
 }
 
 /*-----------------------------------------------------------------------------------------------
@@ -214,6 +220,11 @@ Creator:
 void reshape(int w, int h)
 {
     glViewport(0, 0, w, h);
+
+    // text is laid out in pixels, so this is all that changes when the window does
+    // Note: glut calls this before the first display(), so the text programs always know the
+    // window's size by the time that anything is drawn.
+    gFt.SetViewportSize(w, h);
 }
 
 /*-----------------------------------------------------------------------------------------------
@@ -344,6 +355,18 @@ bool init(int argc, char *argv[])
     glDepthFunc(GL_LEQUAL);
     glDepthRange(0.0f, 1.0f);
 
+#ifdef FREETYPE_ATLAS_BAKED_ONLY
+    // no FreeType in this build, so the atlas has to have been baked ahead of time with
+    // "AtlasBaker FreeSans.ttf 48 32-127 FreeSans"
+    gTextTextureProgramId = gFt.Init("shader.vert", "shader.frag");
+    if (0 == gTextTextureProgramId)
+    {
+        fprintf(stderr, "FreeType could not be initialized\n");
+        return false;
+    }
+
+    gAtlasPtr = gFt.LoadAtlas("FreeSans_48.ftatlas");
+#else
     gTextTextureProgramId = gFt.Init("FreeSans.ttf", "shader.vert", "shader.frag");
     if (0 == gTextTextureProgramId)
     {
@@ -351,14 +374,24 @@ bool init(int argc, char *argv[])
         return false;
     }
 
+    // keep finished atlases next to the executable so that the next launch can skip FreeType
+    gFt.SetAtlasCacheDirectory(".");
+
     // set font height to 48 pixels
     gAtlasPtr = gFt.GenerateAtlas(48);
+#endif
     if (0 == gAtlasPtr)
     {
         fprintf(stderr, "FreeType atlas could not be initialized\n");
         return false;
     }
 
+    // the frame rate is laid out once here and then again once a second (see display())
+    // Note: Positions are in pixels from the window's bottom left corner.
+    float frameRateXY[2] = { 3.0f, 3.0f };
+    float frameRateScaleXY[2] = { 1.0f, 1.0f };
+    gFrameRateMesh.reset(new TextMesh(gAtlasPtr, "0.00", frameRateXY, frameRateScaleXY));
+
     // initialize the timer, which will be used for frame rate calculations
     if (!gTimer.initialize())
     {
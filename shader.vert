@@ -1,12 +1,30 @@
 #version 440
 
-layout (location = 0) in vec2 screenCoord;
+layout (location = 0) in vec2 pixelCoord;
 layout (location = 1) in vec2 textureCoord;    
 
+// 4 bytes, which arrive as [0.0,1.0] (see PackColor(...) in GlyphQuads.h)
+layout (location = 2) in vec4 textColor;
+
+// turns pixels (from the window's bottom left corner) into screen coordinates on the range
+// [-1,+1]: X and Y are the scale, and Z and W are the offset
+// Note: Only this changes when the window is resized (see
+// FreeTypeEncapsulate::SetViewportSize(...)), so the text's vertices don't have to.
+uniform vec4 pixelToNdc;
+
+// moves every vertex by this many pixels, for scrolling quads that are kept around without
+// making them again (see TextFileView::Draw(...))
+// Note: No vertex array has this attribute enabled, so every vertex gets the same value, which
+// is set with glVertexAttrib2f(...), and it is (0,0) unless something sets it.
+layout (location = 3) in vec2 pixelOffset;
+
 // output to frag shader
 // Note: This is the interpolated position between coordinates.
 smooth out vec2 texturePos; 
 
+// every corner of a glyph has the same color, so don't bother interpolating it
+flat out vec4 glyphColor;
+
 void main(void) {
     // gl_Position is defined as a vec4
     // Note: See https://www.opengl.org/sdk/docs/man/html/gl_Position.xhtml
@@ -15,8 +33,9 @@ void main(void) {
     // draw).
     // Also Also Note: Nothing is being transformed here, so W's value doesn't matter, but W=1 
     // is pretty common, so I'll go with it.
-    gl_Position = vec4(screenCoord, 0, 1);
+    gl_Position = vec4(((pixelCoord + pixelOffset) * pixelToNdc.xy) + pixelToNdc.zw, 0, 1);
 
     // this is a texture coordinate for one of the three corners of the triangle 
     texturePos = textureCoord;
+    glyphColor = textColor;
 }
@@ -0,0 +1,20 @@
+#version 440
+
+// must have the same names as their corresponding "out" items in the vert shader
+smooth in vec2 texturePos;
+flat in float texturePosLayer;
+flat in vec4 glyphColor;
+
+// Note: Same uniform name as shader.frag so that the FreeType encapsulation can find it the
+// same way, but the sampler is an array.
+uniform sampler2DArray textureSamplerId;
+
+// because gl_FragColor is officially deprecated by 4.4
+out vec4 finalColor;
+
+void main(void) {
+    // see shader.frag; the only difference is the third texture coordinate, which picks the 
+    // layer
+    finalColor = vec4(1, 1, 1, 
+        texture(textureSamplerId, vec3(texturePos, texturePosLayer)).r) * glyphColor;
+}
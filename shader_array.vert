@@ -0,0 +1,24 @@
+#version 440
+
+// same as shader.vert, plus which layer of the texture array the glyph is in
+layout (location = 0) in vec2 pixelCoord;
+layout (location = 1) in vec2 textureCoord;
+layout (location = 2) in float textureLayer;
+layout (location = 3) in vec4 textColor;
+
+// see shader.vert
+uniform vec4 pixelToNdc;
+
+// output to frag shader
+// Note: The layer is the same for all corners of a glyph, so don't bother interpolating it.
+smooth out vec2 texturePos;
+flat out float texturePosLayer;
+flat out vec4 glyphColor;
+
+void main(void) {
+    // see shader.vert
+    gl_Position = vec4((pixelCoord * pixelToNdc.xy) + pixelToNdc.zw, 0, 1);
+    texturePos = textureCoord;
+    texturePosLayer = textureLayer;
+    glyphColor = textColor;
+}
@@ -0,0 +1,51 @@
+#version 440
+
+// Same output as shader.vert, but there are no vertices.  Each glyph is one instance (see 
+// GlyphInstance in GlyphQuads.h), and the quad's 4 corners are made here from the glyph's 
+// entry in the atlas' table (see GlyphTableEntry in GlyphQuads.h).
+layout (location = 0) in vec2 glyphPen;
+layout (location = 1) in uint glyphIndex;
+layout (location = 2) in vec2 glyphScale;
+layout (location = 3) in vec4 textColor;
+
+// everything in pixels and texels; the texture coordinates are divided by the texture's 
+// size here so that the table doesn't change when the atlas grows
+struct GlyphMetrics
+{
+    vec4 box;       // bitmap left, bitmap top, width, height
+    vec4 texel;     // top left corner in the texture, then the advance (unused here)
+};
+layout (std430, binding = 0) readonly buffer GlyphTable
+{
+    GlyphMetrics glyphs[];
+};
+
+// see shader.vert
+uniform vec4 pixelToNdc;
+
+// the same sampler that shader.frag reads from, only for its size
+uniform sampler2D textureSamplerId;
+
+// output to frag shader
+smooth out vec2 texturePos;
+flat out vec4 glyphColor;
+
+void main(void) {
+    GlyphMetrics glyph = glyphs[glyphIndex];
+
+    // corners 0-3 are bottom left, bottom right, top left, top right (see GlyphQuads.h)
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+
+    // the same placement as MakeGlyphQuad(...), with the scale in 8.8 fixed point
+    vec2 scale = glyphScale / 256.0;
+    vec2 topLeft = vec2(glyphPen.x - (glyph.box.x * scale.x), 
+        glyphPen.y + (glyph.box.y * scale.y));
+    vec2 bottomLeft = vec2(topLeft.x, topLeft.y - (glyph.box.w * scale.y));
+    vec2 pixel = bottomLeft + (corner * glyph.box.zw * scale);
+    gl_Position = vec4((pixel * pixelToNdc.xy) + pixelToNdc.zw, 0, 1);
+
+    // the bitmap's rows go top to bottom, so the bottom of the quad gets the larger T
+    vec2 texel = glyph.texel.xy + (vec2(corner.x, 1.0 - corner.y) * glyph.box.zw);
+    texturePos = texel / vec2(textureSize(textureSamplerId, 0));
+    glyphColor = textColor;
+}
@@ -0,0 +1,23 @@
+#version 440
+
+// must have the same names as their corresponding "out" items in the vert shader
+smooth in vec2 texturePos;
+flat in vec4 glyphColor;
+uniform sampler2D textureSamplerId;
+
+// because gl_FragColor is officially deprecated by 4.4
+out vec4 finalColor;
+
+void main(void) {
+    // the texture holds a signed distance field (see DistanceField.h) rather than coverage, so 
+    // 0.5 is the glyph's edge, bigger values are inside of it, and smaller values are outside
+    float distance = texture(textureSamplerId, texturePos).r;
+
+    // Anti-alias the edge over about one screen pixel, however big or small the text is being 
+    // drawn.  fwidth(...) is how much the distance changes between neighboring fragments, 
+    // which shrinks as the text is scaled up and grows as it is scaled down.
+    // Note: The 0.7 is roughly half of the diagonal of a pixel (sqrt(2) / 2).
+    float smoothing = 0.7 * fwidth(distance);
+    float alpha = smoothstep(0.5 - smoothing, 0.5 + smoothing, distance);
+    finalColor = vec4(1, 1, 1, alpha) * glyphColor;
+}